@@ -16,63 +16,67 @@
  */
 
 #include "Bus.h"
+#include "Conversion.h"
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
 #include <utility>
-#include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <iterator>
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <tuple>
+
+#ifdef __linux__
+  #include <climits>
+  #include <ctime>
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
 
 namespace iris
 { 
   void operator<<( Key& first, const char* second )
   {
-    std::stringstream stream ;
-    std::string       string ;
-
-    stream << first.str()  ;
-    stream << second       ;
-    
-    string = stream.str() ;
-    first.setStr( string.c_str() ) ;
+    first.append( second ) ;
   }
 
   void operator<<( Key& first, unsigned second )
   {
-    std::stringstream stream ;
-    std::string       string ;
-
-    stream << first.str()  ;
-    stream << second       ;
+    char buffer[ 16 ] ;
     
-    string = stream.str() ;
-    first.setStr( string.c_str() ) ;
+    std::snprintf( buffer, sizeof( buffer ), "%u", second ) ;
+    first.append( buffer ) ;
   }
   
   void operator<<( Key& first, float second )
   {
-    std::stringstream stream ;
-    std::string       string ;
+    char buffer[ 32 ] ;
     
-    stream << first.str() ;
-    stream << second      ;
-    
-    string = stream.str() ;
-    first.setStr( string.c_str() ) ;
+    std::snprintf( buffer, sizeof( buffer ), "%g", static_cast<double>( second ) ) ;
+    first.append( buffer ) ;
   }
   
   void operator<<( Key& first, const Key& second )
   {
-    std::stringstream stream ;
-    std::string       string ;
-    
-    stream << first.str()  ;
-    stream << second.str() ;
-    
-    string = stream.str() ;
-    first.setStr( string.c_str() ) ;
+    first.append( second.str() ) ;
+  }
+  
+  void operator<<( Key& first, TopicId second )
+  {
+    first.append( topicName( second ) ) ;
   }
 
   struct KeyData
@@ -80,37 +84,283 @@ namespace iris
     std::string str ;
   };
   
-  struct Signal 
+  /** Structure to track which epoch a thread entered the Bus's lock-free read paths in.
+   */
+  struct EpochRecord
+  {
+    std::atomic<unsigned long long> epoch  ; ///< The epoch the owning thread is reading in, or 0 if it is not reading.
+    std::atomic<bool>               in_use ; ///< Whether or not a thread currently owns this record.
+    unsigned                        depth  ; ///< How many guards deep the owning thread is. Allows re-entrant emits.
+    EpochRecord*                    next   ; ///< The next record in the global list.
+  };
+  
+  /** Structure to contain an object that was unlinked and is waiting for all readers to leave.
+   */
+  struct Retired
+  {
+    void*              pointer ; ///< The object to release.
+    void             (*release )( void* ) ; ///< The function to release the object with.
+    unsigned long long epoch   ; ///< The epoch the object was retired in.
+  };
+  
+  /** Structure to contain the process-wide epoch reclamation state.
+   * Readers announce the epoch they entered in, writers retire unlinked objects and release them once no reader can still see them.
+   */
+  struct EpochData
+  {
+    std::atomic<unsigned long long> epoch   ; ///< The current global epoch.
+    std::atomic<EpochRecord*>       records ; ///< List of every thread record ever made. Records are reused, never freed.
+    std::mutex                      lock    ; ///< Lock for the retired list.
+    std::vector<Retired>            retired ; ///< Objects waiting to be released.
+    
+    EpochData() ;
+    
+    /** Method to release every retired object that no reader can still be using.
+     * @note Takes the lock itself, and releases outside of it, as releasing an object may retire more or resume a waiting coroutine.
+     */
+    void collect() ;
+  };
+  
+  /** Object to hold a thread's epoch record for the lifetime of the thread.
+   */
+  struct EpochOwner
+  {
+    EpochRecord* record ;
+    
+    EpochOwner() ;
+    ~EpochOwner() ;
+  };
+  
+  /** RAII guard for reading lock-free Bus structures.
+   */
+  class EpochGuard
+  {
+    public:
+      EpochGuard() ;
+      ~EpochGuard() ;
+    private:
+      EpochRecord* record ;
+  };
+  
+  /** Function to retrieve the process-wide epoch state.
+   * @return Reference to the epoch state.
+   */
+  static EpochData& epochs()
   {
-    class Subscriber ;
-    class Publisher  ;
+    // Intentionally never released, as static Bus objects retire data while the program is shutting down.
+    static EpochData* data = new EpochData() ;
+    return *data ;
+  }
+  
+  /** Function to retire an object that has been unlinked from a lock-free structure.
+   * @param pointer The object to release once it is no longer visible to any reader.
+   */
+  template<class Type>
+  static void retire( const Type* pointer )
+  {
+    if( pointer == nullptr ) return ;
+    
+    retireObject( static_cast<void*>( const_cast<Type*>( pointer ) ), [] ( void* ptr ) { delete static_cast<Type*>( ptr ) ; } ) ;
+  }
+  
+  /** Function to retire a mailbox that has been unlinked from it's signals.
+   * @note Stream handles may still refer to the mailbox, so only the subscription's reference is dropped.
+   * @param mailbox The mailbox to release once it is no longer visible to any reader.
+   */
+  static void retire( Bus::Mailbox* mailbox )
+  {
+    if( mailbox == nullptr ) return ;
     
-    using SubscriberIterator = std::multimap<unsigned, Signal::Subscriber*>::iterator ;
-    using PublisherIterator  = std::multimap<unsigned, Signal::Publisher *>::iterator ;
+    retireObject( static_cast<void*>( mailbox ), [] ( void* ptr ) { static_cast<Bus::Mailbox*>( ptr )->release() ; } ) ;
+  }
+  
+  /** Structure to contain the queue settings and counters of a topic's ASYNC subscriptions.
+   */
+  struct QueueConfig
+  {
+    std::atomic<unsigned>           depth     ; ///< The amount of data each new subscription can hold.
+    std::atomic<Overflow>           policy    ; ///< What to do with new data once a subscription is full.
+    std::atomic<unsigned long long> dropped   ; ///< The amount of data thrown away because a subscription was full.
+    std::atomic<unsigned long long> coalesced ; ///< The amount of queued data replaced by newer data.
     
-    class Subscriber
+    QueueConfig() ;
+  };
+  
+  /** Structure to contain the bookkeeping of a mailbox's bounded multi-producer queue.
+   * Producers claim a cell by bumping @enqueue once the cell's sequence says it is free, so emitting never locks.
+   * Each cell's sequence is then published to hand it to a consumer, and published back once it's data is used.
+   */
+  struct MailboxData
+  {
+    /** Structure to describe one cell of the queue. The data itself lives in the typed mailbox.
+     */
+    struct Cell
     {
-      public: 
-        Subscriber() ;
-        Subscriber( const Subscriber& sub ) ;
-        ~Subscriber() ;
-        void initialize( Bus::Subscriber* sub ) ;
-        void signal() ;
-        void wait() ;
-        Bus::Subscriber& subscriber() ;
-        void reset() ;
-      private:
-        std::condition_variable  cv             ;
-        std::mutex               mutex          ;
-        Bus::Subscriber*         subscriber_ptr ;
-        std::atomic<int>         is_signaled    ;
+      std::atomic<unsigned long long> sequence ; ///< The position this cell is free for, or one past the position it holds data for.
+      unsigned                        idx      ; ///< The index the data was emitted with.
     };
     
+    Cell*                                         cells   ; ///< The cells of the queue.
+    unsigned                                      mask    ; ///< The amount of cells minus one.
+    QueueConfig*                                  config  ; ///< The settings of the topic this queue belongs to.
+    alignas( 64 ) std::atomic<unsigned long long> enqueue ; ///< The next position to produce into. Kept apart from @dequeue to avoid false sharing.
+    alignas( 64 ) std::atomic<unsigned long long> dequeue ; ///< The next position to consume from.
+    std::atomic<bool>                             closed  ; ///< Whether or not the subscription was removed. Stops blocked producers.
+    std::atomic<std::uint32_t>                    space   ; ///< Bumped whenever a cell is freed while producers are blocked. The futex word they sleep on.
+    std::atomic<unsigned>                         blocked ; ///< The amount of producers sleeping until a cell is freed, for Overflow::Block.
+    std::atomic<void*>                            waiter  ; ///< The address of the coroutine waiting for data, if any. Taken by the producer that wakes it.
+    Executor::Task                                resume  ; ///< The function to resume @waiter with.
+    Executor*                                     context ; ///< The executor to resume @waiter on, or nullptr to resume it on the producer's thread.
+    
+    MailboxData( QueueConfig& config ) ;
+    ~MailboxData() ;
+    
+    /** Method to claim the next free cell to produce into.
+     * @param pos Set to the position claimed.
+     * @return Whether or not a cell was claimed. False if the queue is full.
+     */
+    bool claim( unsigned long long& pos ) ;
+    
+    /** Method to take the oldest cell holding data.
+     * @param pos Set to the position taken.
+     * @return Whether or not a cell was taken. False if the queue is empty.
+     */
+    bool take( unsigned long long& pos ) ;
+    
+    /** Method to hand a claimed cell to consumers.
+     * @param pos The position claimed.
+     * @param idx The index the data was emitted with.
+     */
+    void publish( unsigned long long pos, unsigned idx ) ;
+    
+    /** Method to hand a taken cell back to producers.
+     * @param pos The position taken.
+     */
+    void release( unsigned long long pos ) ;
+    
+    /** Method to check whether every cell holds data, or is being produced into.
+     * @return Whether or not the queue is full.
+     */
+    bool full() const ;
+    
+    /** Method to wait until the queue has a free cell or is closed, for Overflow::Block.
+     * @note May return early, so callers try to claim again afterwards.
+     */
+    void block() ;
+    
+    /** Method to wake every producer blocked on this queue.
+     */
+    void unblock() ;
+  };
+  
+  /** Structure to contain the state of a limiter.
+   * Limit::Throttle only needs @next, so it never locks. The other limits hold data, and lock to swap it.
+   */
+  struct LimiterData
+  {
+    Bus::Delegate          delegate ; ///< The subscription to call.
+    Limit                  limit    ; ///< The policy of the limit.
+    long long              period   ; ///< The period of the limit, in nanoseconds.
+    std::atomic<long long> next     ; ///< The time data may next be let through. For Limit::Debounce, the end of the current quiet period.
+    std::mutex             lock     ; ///< Lock for the held data. Never held while calling the subscription.
+    unsigned               cell     ; ///< The cell new data is held in.
+    unsigned               idx      ; ///< The index the held data was emitted with.
+    bool                   held     ; ///< Whether or not data is held.
+    bool                   flushing ; ///< Whether or not held data is being delivered. New data is held in the other cell meanwhile.
+    
+    LimiterData( const Bus::Delegate& delegate, Limit limit, unsigned milliseconds ) ;
+    
+    /** Method to take the held data if it's time has come.
+     * @note Expects this object's lock to be held. Once delivered, the data must be finished with @flushing cleared.
+     * @param now The current time, in nanoseconds.
+     * @param cell Set to the cell of the held data.
+     * @param idx Set to the index the held data was emitted with.
+     * @return Whether or not the held data should be delivered.
+     */
+    bool due( long long now, unsigned& cell, unsigned& idx ) ;
+  };
+  
+  /** Structure to contain the eventcount a bus's REQUIRED subscriptions signal as their data arrives, for Bus::wait.
+   * A single word counts the subscriptions still waited on, so signalling is one decrement and only makes a syscall if a thread is sleeping in Bus::wait.
+   * @note Retired along with the bus, as emitters may still be signalling it.
+   */
+  struct Arrivals
+  {
+    std::atomic<std::uint32_t> pending ; ///< The amount of REQUIRED subscriptions whose data has not arrived since the last wait, as a signed value. Also the futex word waiters sleep on.
+    std::atomic<unsigned>      waiters ; ///< The amount of threads sleeping on @pending.
+    
+    Arrivals() ;
+    
+    /** Method to change the amount of subscriptions waited on, waking any waiter.
+     * @param amount The amount to add. Negative once data arrives.
+     */
+    void add( int amount ) ;
+  };
+  
+  /** Structure to wrap a REQUIRED subscription, so that it's data arriving counts toward Bus::wait.
+   */
+  struct RequiredInput
+  {
+    Bus::Delegate     delegate ; ///< The subscription.
+    Arrivals*         arrivals ; ///< The eventcount of the bus the subscription was enrolled in.
+    std::atomic<bool> fresh    ; ///< Whether or not data arrived since the last wait. Left set once removed, so emitters still calling it do not count.
+    
+    /** Method to mark that data arrived, counting it if it is the first since the last wait.
+     */
+    void arrive() ;
+    
+    /** Method to stop counting this subscription, once it is removed from the bus.
+     */
+    void detach() ;
+  };
+  
+  /** Structure to contain the state of a request, shared by the caller and the server answering it.
+   */
+  struct ReplyData
+  {
+    static constexpr unsigned PENDING  = 0 ; ///< Nobody has taken the request yet.
+    static constexpr unsigned CLAIMED  = 1 ; ///< A server is answering the request.
+    static constexpr unsigned ANSWERED = 2 ; ///< The request was answered.
+    static constexpr unsigned FAILED   = 3 ; ///< The request finished without an answer.
+    
+    std::atomic<unsigned>           refs    ; ///< The amount of references to the state.
+    std::atomic<unsigned>           copies  ; ///< The amount of references held by copies of the request.
+    std::atomic<unsigned>           status  ; ///< Where the request is, from PENDING to ANSWERED or FAILED.
+    std::atomic<void*>              waiter  ; ///< The address of the coroutine waiting for the reply, if any. Taken by whichever finishes the request.
+    Executor::Task                  resume  ; ///< The function to resume @waiter with.
+    Executor*                       context ; ///< The executor to resume @waiter on, or nullptr to resume it on the answering thread.
+    mutable std::mutex              lock    ; ///< Lock for blocking waits.
+    mutable std::condition_variable cv      ; ///< Wakes blocking waits once the request is finished.
+    
+    ReplyData() ;
+  };
+  
+  /** Structure to contain the last data emitted over a retained topic, for one type of data.
+   * @note Immutable once made. Replaced on every emit.
+   */
+  struct Retained
+  {
+    void*    values                     ; ///< The copy of the data.
+    unsigned stride                     ; ///< The size of a single value, in bytes.
+    unsigned count                      ; ///< The amount of data.
+    unsigned first                      ; ///< The index of the first value.
+    void   (*release)( void*, unsigned ) ; ///< The function to release the copy with.
+    
+    ~Retained() ;
+  };
+  
+  struct Signal 
+  {
+    class Publisher ;
+    
+    using SubscriberList    = std::vector<Bus::Delegate>                            ;
+    using PublisherIterator = std::multimap<unsigned, Signal::Publisher *>::iterator ;
+    
     class Publisher
     {
       public: 
         Publisher() ;
-        Publisher( const Publisher& sub ) ;
+        ~Publisher() ;
         void initialize( Bus::Publisher* sub ) ;
         void signal() ;
         void wait() ;
@@ -121,12 +371,18 @@ namespace iris
         
     };
     
-    /**
-     * @param id
-     * @param sub
-     * @return 
+    /** Method to find the slot of subscribers for a type, optionally making it.
+     * @param type_id The hash of the type of data the slot carries.
+     * @param create Whether or not to make the slot if it does not exist.
+     * @return The slot for the type, or nullptr if it does not exist and was not made.
+     */
+    SignalSlot* slot( unsigned type_id, bool create ) ;
+    
+    /** Method to add a subscriber to this signal.
+     * @param id The hash of the type of data the subscriber recieves.
+     * @param sub The subscription to add.
      */
-    SubscriberIterator insert( unsigned id, Bus::Subscriber* sub ) ;
+    void insert( unsigned id, const Bus::Delegate& sub ) ;
     
     /**
      * @param id
@@ -135,243 +391,2501 @@ namespace iris
      */
     PublisherIterator  insert( unsigned id, Bus::Publisher*  pub ) ;
     
-    /**
-     * @param iter
+    /** Method to remove a subscriber from this signal.
+     * @note Mailboxes are released once no emitter can still be calling them. Removing twice is a no-op.
+     * @param id The hash of the type of data the subscriber recieves.
+     * @param sub The subscription to remove.
+     * @param release Whether or not to release the subscription's mailbox. False if other signals still share it.
      */
-    void remove( SubscriberIterator& iter ) ;
+    void remove( unsigned id, const Bus::Delegate& sub, bool release = true ) ;
     
     /**
      * @param iter
      */
     void remove( PublisherIterator& iter ) ;
     
-    std::multimap<unsigned, Signal::Subscriber*> subscribers  ;
+    std::atomic<SignalSlot*>                     slots        ;
     std::multimap<unsigned, Signal::Publisher *> publishers   ;
     std::mutex                                   signal_mutex ;
+    QueueConfig                                  queue        ; ///< The queue settings of this topic's ASYNC subscriptions.
+    std::atomic<bool>                            retained     ; ///< Whether or not this topic keeps the last data emitted over it.
+    unsigned                                     retainers    ; ///< The amount of callers that asked for this topic to be retained. Guarded by @signal_mutex.
+    unsigned                                     id           ; ///< The id of this signal's topic.
+    
+    Signal() ;
   };
   
-  using SignalMap        =  std::multimap<std::string, Signal*                                                      > ;
-  using LocalSubscribers =  std::map<std::string, std::pair<Signal*, std::map<unsigned, Signal::SubscriberIterator>>> ;
-  using LocalPublishers  =  std::map<std::string, std::pair<Signal*, std::map<unsigned, Signal::PublisherIterator >>> ;
-  
-  static SignalMap  signal_map ;
-  static std::mutex map_lock   ;
-
-  struct BusData
+  /** Structure to contain every subscriber of a single type on a signal.
+   * @note Slots are never released, so handles may hold on to them for the lifetime of the program.
+   */
+  struct SignalSlot
   {
-    LocalSubscribers sub_map          ;
-    LocalSubscribers required_sub_map ;
-    LocalPublishers  pub_map          ;
-    unsigned         identifier       ;
-    std::mutex       lock             ;
+    Signal*                                     signal      ; ///< The signal this slot belongs to.
+    unsigned                                    type_id     ; ///< The hash of the type of data this slot carries.
+    std::atomic<const Signal::SubscriberList*> subscribers ; ///< Immutable snapshot of the subscribers. Replaced on every change.
+    std::atomic<const Retained*>                last        ; ///< The last data emitted over this slot, if it's topic is retained.
+    std::recursive_mutex                        order       ; ///< Held while retaining & sending data of a retained topic, so new subscriptions get the latest data last. Recursive, for subscribers that emit again.
+    SignalSlot*                                 next        ; ///< The next slot on the signal.
     
-    BusData() ;
-    BusData& operator=( const BusData& bus ) ;
-    ~BusData() ;
+    SignalSlot( Signal* signal, unsigned type_id, SignalSlot* next ) ;
   };
-
-  Key::Key()
+  
+  /** Structure to contain a single interned topic.
+   * @note Entries are never released, so their name and signal are valid for the lifetime of the program.
+   */
+  struct TopicEntry
   {
-    this->key_data = new KeyData() ;
-  }
-
-  Key::Key( const Key& string )
+    std::string name   ; ///< The topic string.
+    size_t      hash   ; ///< The hash of the topic string.
+    unsigned    id     ; ///< The compact id of the topic.
+    Signal*     signal ; ///< The signal of the topic.
+  };
+  
+  /** Structure to contain an open-addressed table of the topics of a single shard.
+   * Entries are only ever added, into empty slots, so readers probe it while a writer inserts.
+   */
+  struct ShardTable
   {
-    this->key_data = new KeyData() ;
-    *this->key_data = *string.key_data ;
-  }
+    std::atomic<TopicEntry*>* entries ; ///< The table.
+    size_t                    size    ; ///< The amount of slots in the table, a power of two.
+    size_t                    count   ; ///< The amount of entries in the table. Only used by writers.
+    
+    /** Constructor.
+     * @param size The amount of slots in the table, a power of two.
+     */
+    ShardTable( size_t size ) ;
+    
+    /** Deconstructor. Releases the slots, not the entries.
+     */
+    ~ShardTable() ;
+    
+    /** Method to find the entry of a topic string.
+     * @param str The topic string.
+     * @param hash The hash of the topic string.
+     * @return The entry of the topic, or nullptr if it is not in this table.
+     */
+    TopicEntry* find( std::string_view str, size_t hash ) const ;
+    
+    /** Method to insert an entry into this table.
+     * @note Expects the shard's lock to be held, and the table to have an empty slot.
+     * @param entry The entry to insert.
+     */
+    void insert( TopicEntry* entry ) ;
+    
+    /** Method to check whether one more entry would fill this table past half.
+     * @return Whether or not the table must grow before the next insert.
+     */
+    bool full() const ;
+  };
   
-  void Key::operator=( const Key& string )
+  /** Structure to contain one shard of the topic registry.
+   * Readers probe the current table without locking, writers copy it and publish the copy.
+   */
+  struct TopicShard
   {
-    *this->key_data = *string.key_data ;
-  }
-      
-  Key::~Key()
+    std::atomic<ShardTable*> table ; ///< The current table of this shard.
+    std::mutex               lock  ; ///< Lock for writers of this shard.
+  };
+  
+  /** Structure to contain the process-wide topic registry.
+   * Topics are sharded by the hash of their string so registration of unrelated topics does not contend.
+   * Ids index into a chunked directory, so looking up a topic by id never locks.
+   */
+  struct TopicRegistry
   {
-    delete this->key_data ;
-  }
+    static constexpr unsigned SHARD_COUNT = 64   ;
+    static constexpr unsigned CHUNK_SIZE  = 1024 ;
+    static constexpr unsigned CHUNK_COUNT = 4096 ;
+    
+    TopicShard                             shards[ SHARD_COUNT ]    ; ///< The shards of the registry.
+    std::atomic<std::atomic<TopicEntry*>*> directory[ CHUNK_COUNT ] ; ///< Chunks of entries, indexed by id.
+    std::atomic<unsigned>                  next_id                  ; ///< The next id to hand out.
+    
+    TopicRegistry() ;
+    
+    /** Method to find or make the entry of a topic string.
+     * @param str The topic string.
+     * @param hash The hash of the topic string, as made by iris::hash.
+     * @return The entry of the topic.
+     */
+    TopicEntry* intern( std::string_view str, unsigned hash ) ;
+    
+    /** Method to find the entry of a topic id.
+     * @param id The id of the topic.
+     * @return The entry of the topic, or nullptr if the id was never handed out.
+     */
+    TopicEntry* find( unsigned id ) const ;
+    
+    /** Method to store an entry in the directory.
+     * @param entry The entry to store at it's id.
+     */
+    void store( TopicEntry* entry ) ;
+  };
   
-  void Key::setStr( const char* str )
+  /** Structure to contain a single wildcard subscription.
+   */
+  struct Pattern
   {
-    data().str = str ;
-  }
-
-  const char* Key::str() const
+    std::string       text     ; ///< The pattern, where each '*' matches any run of characters.
+    unsigned          type_id  ; ///< The hash of the type of data the subscription recieves.
+    Bus::Delegate     delegate ; ///< The subscription.
+    std::set<Signal*> signals  ; ///< The signals of every topic the pattern matched. Guarded by the pattern index's lock.
+  };
+  
+  /** Structure to contain every wildcard subscription, indexed by the literal prefix before their first wildcard.
+   * Topics are matched against patterns once, when either is made, so emitting never looks at patterns.
+   */
+  struct PatternIndex
   {
-    return data().str.c_str() ;
+    using PrefixMap = std::map<std::string, std::vector<Pattern*>, std::less<>> ;
+    
+    std::mutex            lock     ; ///< Lock for the index and the signals of every pattern.
+    PrefixMap             prefixes ; ///< The patterns, by their literal prefix.
+    std::atomic<unsigned> count    ; ///< The amount of patterns. Lets making a topic skip the index when there are none.
+    
+    PatternIndex() ;
+    
+    /** Method to add a pattern and subscribe it to every existing topic it matches.
+     * @param pattern The pattern to add.
+     * @return The signals the pattern was subscribed to.
+     */
+    std::vector<Signal*> add( Pattern* pattern ) ;
+    
+    /** Method to remove a pattern, so no new topic is matched against it.
+     * @note The pattern's subscription is left on the signals it already matched.
+     * @param pattern The pattern to remove.
+     */
+    void remove( Pattern* pattern ) ;
+    
+    /** Method to subscribe every pattern a newly made topic matches to it.
+     * @param entry The entry of the new topic.
+     */
+    void match( TopicEntry* entry ) ;
+  };
+  
+  using LocalSubscribers =  std::map<unsigned, std::pair<Signal*, std::map<unsigned, Bus::Delegate            >>> ;
+  using LocalPublishers  =  std::map<unsigned, std::pair<Signal*, std::map<unsigned, Signal::PublisherIterator>>> ;
+  using LocalPatterns    =  std::map<unsigned, std::map<unsigned, Pattern*>>                                      ;
+  
+  /** Function to retrieve the process-wide topic registry.
+   * @return Reference to the topic registry.
+   */
+  static TopicRegistry& registry()
+  {
+    // Intentionally never released, as static Bus objects look up topics while the program is shutting down.
+    static TopicRegistry* reg = new TopicRegistry() ;
+    return *reg ;
   }
-
-  KeyData& Key::data()
+  
+  /** Function to spread the bits of a topic hash, as the low bits pick the shard and table slot.
+   * @param hash The hash of a topic string, as made by iris::hash.
+   * @return The mixed hash.
+   */
+  static size_t mix( unsigned hash )
   {
-    return *this->key_data ;
+    size_t value = hash ;
+    
+    value ^= value >> 16 ;
+    value *= 0x45d9f3b   ;
+    value ^= value >> 16 ;
+    
+    return value ;
   }
-
-  const KeyData& Key::data() const
+  
+  ShardTable::ShardTable( size_t size )
   {
-    return *this->key_data ;
+    this->entries = new std::atomic<TopicEntry*>[ size ] ;
+    this->size    = size                                 ;
+    this->count   = 0                                    ;
+    
+    for( size_t index = 0; index < size; index++ ) this->entries[ index ].store( nullptr, std::memory_order_relaxed ) ;
   }
-
-  Signal::Subscriber::Subscriber()
+  
+  ShardTable::~ShardTable()
   {
-    this->subscriber_ptr = nullptr ;
-    this->is_signaled = false ;
+    delete[] this->entries ;
   }
   
-  Signal::Subscriber::Subscriber( const Signal::Subscriber& cont )
+  TopicEntry* ShardTable::find( std::string_view str, size_t hash ) const
   {
-    this->subscriber_ptr = cont.subscriber_ptr ;
-    this->is_signaled.exchange( cont.is_signaled.load() ) ;
+    const size_t mask = this->size - 1 ;
+    TopicEntry*  entry ;
+    
+    for( size_t index = hash & mask; ( entry = this->entries[ index ].load( std::memory_order_acquire ) ) != nullptr; index = ( index + 1 ) & mask )
+    {
+      if( entry->hash == hash && entry->name == str ) return entry ;
+    }
+    
+    return nullptr ;
   }
   
-  Signal::Subscriber::~Subscriber()
+  void ShardTable::insert( TopicEntry* entry )
   {
-    this->subscriber_ptr = nullptr ;
+    const size_t mask = this->size - 1 ;
+    size_t       index ;
+    
+    for( index = entry->hash & mask; this->entries[ index ].load( std::memory_order_relaxed ) != nullptr; index = ( index + 1 ) & mask ) {} ;
+    
+    // Published last, so readers that find the entry see it whole.
+    this->entries[ index ].store( entry, std::memory_order_release ) ;
+    this->count++ ;
   }
-
-  void Signal::Subscriber::signal()
+  
+  bool ShardTable::full() const
   {
-    std::scoped_lock<std::mutex> lock( this->mutex ) ;
-    this->is_signaled++ ;
-    this->cv.notify_one() ;
+    return ( this->count + 1 ) * 2 > this->size ;
   }
   
-  void Signal::Subscriber::wait()
+  /** Function to retrieve the process-wide index of wildcard subscriptions.
+   * @return Reference to the pattern index.
+   */
+  static PatternIndex& patterns()
   {
-    std::unique_lock<std::mutex> lock( this->mutex ) ;
-    this->cv.wait( lock, [=] { return this->is_signaled >= 0 ; } ) ;
-    this->is_signaled-- ;
-    this->reset() ;
+    // Intentionally never released, for the same reason as the registry.
+    static PatternIndex* index = new PatternIndex() ;
+    return *index ;
   }
   
-  void Signal::Subscriber::initialize( Bus::Subscriber* sub )
+  /** Function to check whether a topic matches a pattern.
+   * @param pattern The pattern, where each '*' matches any run of characters.
+   * @param topic The topic.
+   * @return Whether or not the topic matches.
+   */
+  static bool matches( std::string_view pattern, std::string_view topic )
   {
-    this->subscriber_ptr = sub ;
+    size_t pos  = 0                      ;
+    size_t star = std::string_view::npos ;
+    size_t mark = 0                      ;
+    
+    for( size_t current = 0; current < topic.size(); )
+    {
+      if( pos < pattern.size() && pattern[ pos ] == '*' )
+      {
+        star = pos++    ;
+        mark = current ;
+      }
+      else if( pos < pattern.size() && pattern[ pos ] == topic[ current ] )
+      {
+        pos++     ;
+        current++ ;
+      }
+      else if( star != std::string_view::npos )
+      {
+        // Let the last wildcard swallow one more character and try again.
+        pos     = star + 1 ;
+        current = ++mark   ;
+      }
+      else
+      {
+        return false ;
+      }
+    }
+    
+    while( pos < pattern.size() && pattern[ pos ] == '*' ) pos++ ;
+    
+    return pos == pattern.size() ;
   }
-
-  Bus::Subscriber& Signal::Subscriber::subscriber()
+  
+  TopicRegistry::TopicRegistry()
   {
-    return *this->subscriber_ptr ;
+    for( auto& shard : this->shards )
+    {
+      shard.table = new ShardTable( 16 ) ;
+    }
+    
+    for( auto& chunk : this->directory ) chunk = nullptr ;
+    
+    this->next_id = 1 ;
   }
   
-  void Signal::Subscriber::reset()
+  TopicEntry* TopicRegistry::intern( std::string_view str, unsigned str_hash )
   {
-    this->is_signaled = false ;
+    const size_t hash  = mix( str_hash )                    ;
+    TopicShard&  shard = this->shards[ hash % SHARD_COUNT ] ;
+    TopicEntry*  entry ;
+    
+    {
+      EpochGuard guard ;
+      entry = shard.table.load()->find( str, hash ) ;
+      if( entry ) return entry ;
+    }
+    
+    std::scoped_lock<std::mutex> lock( shard.lock ) ;
+    
+    // Another thread may have made the topic while we waited on the lock.
+    ShardTable* table = shard.table.load() ;
+    entry = table->find( str, hash ) ;
+    if( entry ) return entry ;
+    
+    entry         = new TopicEntry()             ;
+    entry->name   = std::string( str )           ;
+    entry->hash   = hash                         ;
+    entry->id     = this->next_id.fetch_add( 1 ) ;
+    entry->signal = new Signal()                 ;
+    entry->signal->id = entry->id ;
+    this->store( entry ) ;
+    
+    // Only growing copies the table, and it doubles each time, so making topics costs constant time on average.
+    if( table->full() )
+    {
+      const ShardTable* old = table ;
+      
+      table = new ShardTable( old->size * 2 ) ;
+      
+      for( size_t index = 0; index < old->size; index++ )
+      {
+        TopicEntry* current = old->entries[ index ].load( std::memory_order_relaxed ) ;
+        if( current ) table->insert( current ) ;
+      }
+      
+      shard.table.store( table ) ;
+      retire( old ) ;
+    }
+    
+    table->insert( entry ) ;
+    
+    patterns().match( entry ) ;
+    
+    return entry ;
   }
   
-  Signal::Publisher::Publisher()
+  PatternIndex::PatternIndex()
   {
-    this->pub_ptr = nullptr ;
+    this->count = 0 ;
   }
   
-  void Signal::Publisher::initialize( Bus::Publisher* pub )
+  std::vector<Signal*> PatternIndex::add( Pattern* pattern )
   {
-    this->pub_ptr = pub ; 
+    std::vector<Signal*>         matched              ;
+    std::scoped_lock<std::mutex> lock( this->lock )  ;
+    TopicRegistry&               reg = registry()    ;
+    
+    this->prefixes[ pattern->text.substr( 0, pattern->text.find( '*' ) ) ].push_back( pattern ) ;
+    this->count++ ;
+    
+    // Topics made from here on are matched by the thread making them, once it can take the lock.
+    for( unsigned id = 1; id < reg.next_id.load(); id++ )
+    {
+      TopicEntry* entry = reg.find( id ) ;
+      
+      if( entry && entry->name.find( '*' ) == std::string::npos && matches( pattern->text, entry->name ) && pattern->signals.insert( entry->signal ).second )
+      {
+        entry->signal->insert( pattern->type_id, pattern->delegate ) ;
+        matched.push_back( entry->signal ) ;
+      }
+    }
+    
+    return matched ;
   }
   
-  Signal::SubscriberIterator Signal::insert( unsigned id, Bus::Subscriber* sub )
+  void PatternIndex::remove( Pattern* pattern )
   {
-    Signal::Subscriber* signal_sub = new Signal::Subscriber() ;
-    signal_sub->initialize( sub ) ;
+    std::scoped_lock<std::mutex> lock( this->lock ) ;
     
-    this->signal_mutex.lock() ;
-    auto ret = this->subscribers.insert( { id, signal_sub } ) ;
-    this->signal_mutex.unlock() ;
-    return ret ;
+    auto iter = this->prefixes.find( pattern->text.substr( 0, pattern->text.find( '*' ) ) ) ;
+    
+    if( iter == this->prefixes.end() ) return ;
+    
+    auto& list = iter->second ;
+    auto  pos  = std::find( list.begin(), list.end(), pattern ) ;
+    
+    if( pos == list.end() ) return ;
+    
+    list.erase( pos ) ;
+    if( list.empty() ) this->prefixes.erase( iter ) ;
+    this->count-- ;
   }
   
-  Signal::PublisherIterator Signal::insert( unsigned id, Bus::Publisher* pub )
+  void PatternIndex::match( TopicEntry* entry )
   {
-    Signal::Publisher* signal_pub = new Signal::Publisher() ;
-    signal_pub->initialize( pub ) ;
+    const std::string_view name = entry->name ;
     
-    this->signal_mutex.lock() ;
-    auto ret = this->publishers.insert( { id, signal_pub } ) ;
+    // Patterns are interned as topics too, but never match each other.
+    if( this->count.load() == 0 || name.find( '*' ) != std::string_view::npos ) return ;
+    
+    std::scoped_lock<std::mutex> lock( this->lock ) ;
+    
+    for( size_t length = 0; length <= name.size(); length++ )
+    {
+      auto iter = this->prefixes.find( name.substr( 0, length ) ) ;
+      
+      if( iter == this->prefixes.end() ) continue ;
+      
+      for( auto pattern : iter->second )
+      {
+        if( matches( pattern->text, name ) && pattern->signals.insert( entry->signal ).second )
+        {
+          entry->signal->insert( pattern->type_id, pattern->delegate ) ;
+        }
+      }
+    }
+  }
+  
+  TopicEntry* TopicRegistry::find( unsigned id ) const
+  {
+    if( id == 0 || id / CHUNK_SIZE >= CHUNK_COUNT ) return nullptr ;
+    
+    auto chunk = this->directory[ id / CHUNK_SIZE ].load() ;
+    return chunk ? chunk[ id % CHUNK_SIZE ].load() : nullptr ;
+  }
+  
+  void TopicRegistry::store( TopicEntry* entry )
+  {
+    std::atomic<TopicEntry*>* chunk    = nullptr ;
+    std::atomic<TopicEntry*>* expected = nullptr ;
+    
+    if( entry->id / CHUNK_SIZE >= CHUNK_COUNT )
+    {
+      std::cout << "Iris Bus: Ran out of topic ids. Topic '" << entry->name << "' can not be looked up by id." << std::endl ;
+      return ;
+    }
+    
+    chunk = this->directory[ entry->id / CHUNK_SIZE ].load() ;
+    if( chunk == nullptr )
+    {
+      chunk = new std::atomic<TopicEntry*>[ CHUNK_SIZE ] ;
+      for( unsigned index = 0; index < CHUNK_SIZE; index++ ) chunk[ index ] = nullptr ;
+      
+      // Shards make entries concurrently, so only one of them gets to publish the chunk.
+      if( !this->directory[ entry->id / CHUNK_SIZE ].compare_exchange_strong( expected, chunk ) )
+      {
+        delete[] chunk ;
+        chunk = expected ;
+      }
+    }
+    
+    chunk[ entry->id % CHUNK_SIZE ].store( entry ) ;
+  }
+  
+  TopicId intern( const Key& key )
+  {
+    const std::string_view str = key.str() ;
+    
+    return { registry().intern( str, hash( str.data(), 0, static_cast<unsigned>( str.size() ) ) )->id } ;
+  }
+  
+  TopicId intern( const char* str, unsigned length, unsigned hash )
+  {
+    return { registry().intern( std::string_view( str, length ), hash )->id } ;
+  }
+  
+  TopicId intern( TopicId topic )
+  {
+    return topic ;
+  }
+  
+  const char* topicName( TopicId topic )
+  {
+    const TopicEntry* entry = registry().find( topic.value ) ;
+    
+    return entry ? entry->name.c_str() : "" ;
+  }
+  
+  /** Function to retrieve the signal of a topic.
+   * @param key The topic to look up.
+   * @return The signal of the topic, or nullptr if the topic was never interned.
+   */
+  static Signal* signalOf( TopicId key )
+  {
+    const TopicEntry* entry = registry().find( key.value ) ;
+    
+    return entry ? entry->signal : nullptr ;
+  }
+  
+  void setQueue( TopicId topic, unsigned depth, Overflow policy )
+  {
+    Signal* signal = signalOf( topic ) ;
+    
+    if( signal == nullptr ) return ;
+    
+    signal->queue.depth .store( depth  ) ;
+    signal->queue.policy.store( policy ) ;
+  }
+  
+  QueueStats queueStats( TopicId topic )
+  {
+    Signal* signal = signalOf( topic ) ;
+    
+    if( signal == nullptr ) return { 0, 0 } ;
+    
+    return { signal->queue.dropped.load(), signal->queue.coalesced.load() } ;
+  }
+  
+  void retireObject( void* pointer, void (*release)( void* ) )
+  {
+    EpochData& data = epochs() ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( data.lock ) ;
+      data.retired.push_back( { pointer, release, data.epoch.fetch_add( 1 ) } ) ;
+    }
+    
+    data.collect() ;
+  }
+  
+  void setRetained( TopicId topic, bool retained )
+  {
+    Signal* signal = signalOf( topic ) ;
+    
+    if( signal == nullptr ) return ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( signal->signal_mutex ) ;
+      
+      // Topics are shared by the whole process, so the topic stays retained until everyone that asked for it lets go.
+      if( retained ) signal->retainers++ ;
+      else if( signal->retainers != 0 ) signal->retainers-- ;
+      else return ;
+      
+      retained = signal->retainers != 0 ;
+      signal->retained.store( retained ) ;
+    }
+    
+    if( !retained )
+    {
+      for( auto slot = signal->slots.load(); slot != nullptr; slot = slot->next )
+      {
+        retire( slot->last.exchange( nullptr ) ) ;
+      }
+    }
+  }
+  
+  unsigned subscribedTypes( TopicId topic, unsigned* type_ids, unsigned count )
+  {
+    EpochGuard guard                      ;
+    Signal*    signal = signalOf( topic ) ;
+    unsigned   found  = 0                 ;
+    
+    if( signal == nullptr ) return 0 ;
+    
+    for( auto slot = signal->slots.load(); slot != nullptr; slot = slot->next )
+    {
+      const Signal::SubscriberList* list = slot->subscribers.load() ;
+      
+      // Universal subscribers take any type, so they don't ask for one.
+      if( list && !list->empty() && slot->type_id != Bus::UNIVERSAL_TYPE )
+      {
+        if( found < count ) type_ids[ found ] = slot->type_id ;
+        found++ ;
+      }
+    }
+    
+    return found ;
+  }
+  
+  /** Structure to contain a snapshot of the bus's metrics.
+   */
+  struct BusStatsData
+  {
+    std::vector<TopicStats>      topics      ; ///< The counters of every topic, by topic id.
+    std::vector<SubscriberStats> subscribers ; ///< The counters of every subscription, by topic id.
+    std::string                  report      ; ///< The human readable report of the snapshot. Made on first use.
+  };
+  
+#ifdef IRIS_BUS_METRICS
+  using Counter = std::atomic<unsigned long long> ;
+  
+  /** Structure to contain the counters of every topic, as recorded by a single thread.
+   * Indexed by the compact id of the topic. Replaced by a larger copy once a topic past the end is emitted to.
+   */
+  struct TopicCounters
+  {
+    struct Entry
+    {
+      Counter emits      ; ///< The amount of data emitted over the topic.
+      Counter deliveries ; ///< The amount of subscriber calls made for the data.
+    };
+    
+    std::unique_ptr<Entry[]> entries ; ///< The counters, by topic id.
+    size_t                   size    ; ///< The amount of entries.
+    
+    /** Constructor. Makes zeroed counters.
+     * @param size The amount of topics to hold.
+     */
+    explicit TopicCounters( size_t size ) ;
+  };
+  
+  /** Structure to contain the counters of every subscription, as recorded by a single thread.
+   * Open-addressed by topic, object, trampoline and function. Replaced by a larger copy once half full.
+   */
+  struct SubscriberCounters
+  {
+    struct Entry
+    {
+      std::atomic<bool> used                                         ; ///< Whether or not the key is set. Set after it, and never cleared.
+      unsigned          topic                                        ; ///< The id of the topic subscribed to.
+      const void*       object                                       ; ///< The object called.
+      const void*       trampoline                                   ; ///< The trampoline of the subscription, to tell subscriptions of one object apart.
+      void            (*function)()                                  ; ///< The function called.
+      Counter           calls                                        ; ///< The amount of times the subscription was called.
+      Counter           latency[ SubscriberStats::LATENCY_BUCKETS ] ; ///< Log-scale histogram of call times.
+    };
+    
+    std::unique_ptr<Entry[]> entries ; ///< The counters. A power of two in size.
+    size_t                   size    ; ///< The amount of entries.
+    size_t                   count   ; ///< The amount of used entries. Only read by the owning thread.
+    
+    /** Constructor. Makes an empty table.
+     * @param size The amount of entries. Must be a power of two.
+     */
+    explicit SubscriberCounters( size_t size ) ;
+    
+    /** Method to find the entry of a subscription, or the empty entry it goes in.
+     * @return The entry.
+     */
+    Entry& find( unsigned topic, const void* object, const void* trampoline, void (*function)() ) const ;
+  };
+  
+  /** Structure to contain the metrics recorded by a single thread.
+   * Only the owning thread writes it's counters, so recording is a relaxed load and store with no lock. Snapshots read them under an epoch guard.
+   */
+  struct MetricsRecord
+  {
+    using SubscriberKey = std::tuple<unsigned, std::uintptr_t, std::uintptr_t, std::uintptr_t> ;
+    
+    std::atomic<TopicCounters*>      topics      ; ///< The counters of every topic. Retired when replaced.
+    std::atomic<SubscriberCounters*> subscribers ; ///< The counters of every subscription. Retired when replaced.
+    std::atomic<bool>                in_use      ; ///< Whether or not a thread currently owns this record.
+    MetricsRecord*                   next        ; ///< The next record in the global list.
+    
+    MetricsRecord() ;
+    
+    /** Method to retrieve the counters of a topic, growing the table to hold it if needed.
+     * @note Only called by the owning thread.
+     * @param topic The id of the topic.
+     * @return The counters of the topic.
+     */
+    TopicCounters::Entry& topic( unsigned topic ) ;
+    
+    /** Method to retrieve the counters of a subscription, adding it if needed.
+     * @note Only called by the owning thread.
+     * @return The counters of the subscription.
+     */
+    SubscriberCounters::Entry& subscriber( unsigned topic, const void* object, const void* trampoline, void (*function)() ) ;
+  };
+  
+  /** Structure to contain the process-wide metrics state.
+   */
+  struct MetricsData
+  {
+    std::atomic<MetricsRecord*> records   ; ///< List of every thread record ever made. Records are reused, never freed, so no count is lost.
+    std::atomic<unsigned>       interval  ; ///< The time between printed reports in milliseconds, or 0 to not print them.
+    std::atomic<long long>      last_dump ; ///< The time of the last printed report in milliseconds.
+  };
+  
+  /** Object to hold a thread's metrics record for the lifetime of the thread.
+   */
+  struct MetricsOwner
+  {
+    MetricsRecord* record ;
+    
+    MetricsOwner() ;
+    ~MetricsOwner() ;
+  };
+  
+  /** Function to retrieve the process-wide metrics state.
+   * @return Reference to the metrics state.
+   */
+  static MetricsData& metrics()
+  {
+    // Intentionally never released, for the same reason as the registry.
+    static MetricsData* data = new MetricsData() ;
+    return *data ;
+  }
+  
+  /** Function to retrieve the metrics record of the calling thread.
+   * @return Reference to the record.
+   */
+  static MetricsRecord& localMetrics()
+  {
+    thread_local MetricsOwner owner ;
+    return *owner.record ;
+  }
+  
+  /** Function to retrieve the current time of the metrics clock.
+   * @return The time in nanoseconds.
+   */
+  static long long metricsTime()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ;
+  }
+  
+  /** Function to add to a counter only the calling thread writes.
+   * @param counter The counter.
+   * @param amount The amount to add.
+   */
+  static inline void bump( Counter& counter, unsigned long long amount )
+  {
+    // A single writer needs no read-modify-write, only for snapshots to see whole values.
+    counter.store( counter.load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed ) ;
+  }
+  
+  TopicCounters::TopicCounters( size_t size )
+  {
+    this->entries.reset( new Entry[ size ]() ) ;
+    this->size = size ;
+  }
+  
+  SubscriberCounters::SubscriberCounters( size_t size )
+  {
+    this->entries.reset( new Entry[ size ]() ) ;
+    this->size  = size ;
+    this->count = 0    ;
+  }
+  
+  SubscriberCounters::Entry& SubscriberCounters::find( unsigned topic, const void* object, const void* trampoline, void (*function)() ) const
+  {
+    const std::uintptr_t key   = reinterpret_cast<std::uintptr_t>( object ) ^ ( reinterpret_cast<std::uintptr_t>( trampoline ) >> 4 ) ^ reinterpret_cast<std::uintptr_t>( function ) ;
+    size_t               index = static_cast<size_t>( ( key ^ topic ) * 0x9E3779B97F4A7C15ull ) ;
+    
+    for( ; ; index++ )
+    {
+      Entry& entry = this->entries[ index & ( this->size - 1 ) ] ;
+      
+      if( !entry.used.load( std::memory_order_acquire ) ) return entry ;
+      if( entry.topic == topic && entry.object == object && entry.trampoline == trampoline && entry.function == function ) return entry ;
+    }
+  }
+  
+  MetricsRecord::MetricsRecord()
+  {
+    this->topics      = new TopicCounters     ( 64 ) ;
+    this->subscribers = new SubscriberCounters( 64 ) ;
+    this->in_use      = false                        ;
+    this->next        = nullptr                      ;
+  }
+  
+  TopicCounters::Entry& MetricsRecord::topic( unsigned topic )
+  {
+    TopicCounters* table = this->topics.load( std::memory_order_relaxed ) ;
+    
+    if( topic >= table->size )
+    {
+      TopicCounters* grown = new TopicCounters( std::max<size_t>( table->size * 2, topic + 1 ) ) ;
+      
+      for( size_t index = 0; index < table->size; index++ )
+      {
+        grown->entries[ index ].emits      = table->entries[ index ].emits     .load( std::memory_order_relaxed ) ;
+        grown->entries[ index ].deliveries = table->entries[ index ].deliveries.load( std::memory_order_relaxed ) ;
+      }
+      
+      this->topics.store( grown, std::memory_order_release ) ;
+      retire( table ) ;
+      table = grown ;
+    }
+    
+    return table->entries[ topic ] ;
+  }
+  
+  SubscriberCounters::Entry& MetricsRecord::subscriber( unsigned topic, const void* object, const void* trampoline, void (*function)() )
+  {
+    SubscriberCounters*        table = this->subscribers.load( std::memory_order_relaxed ) ;
+    SubscriberCounters::Entry* entry = &table->find( topic, object, trampoline, function ) ;
+    
+    if( entry->used.load( std::memory_order_relaxed ) ) return *entry ;
+    
+    if( ( table->count + 1 ) * 2 > table->size )
+    {
+      SubscriberCounters* grown = new SubscriberCounters( table->size * 2 ) ;
+      
+      for( size_t index = 0; index < table->size; index++ )
+      {
+        const SubscriberCounters::Entry& old = table->entries[ index ] ;
+        
+        if( !old.used.load( std::memory_order_relaxed ) ) continue ;
+        
+        SubscriberCounters::Entry& copy = grown->find( old.topic, old.object, old.trampoline, old.function ) ;
+        copy.topic      = old.topic                                    ;
+        copy.object     = old.object                                   ;
+        copy.trampoline = old.trampoline                               ;
+        copy.function   = old.function                                 ;
+        copy.calls      = old.calls.load( std::memory_order_relaxed ) ;
+        
+        for( unsigned bucket = 0; bucket < SubscriberStats::LATENCY_BUCKETS; bucket++ )
+        {
+          copy.latency[ bucket ] = old.latency[ bucket ].load( std::memory_order_relaxed ) ;
+        }
+        
+        copy.used.store( true, std::memory_order_relaxed ) ;
+      }
+      
+      grown->count = table->count ;
+      this->subscribers.store( grown, std::memory_order_release ) ;
+      retire( table ) ;
+      
+      table = grown                                            ;
+      entry = &table->find( topic, object, trampoline, function ) ;
+    }
+    
+    // The key is published before the entry is marked used, so snapshots never see half a key.
+    entry->topic      = topic      ;
+    entry->object     = object     ;
+    entry->trampoline = trampoline ;
+    entry->function   = function   ;
+    entry->used.store( true, std::memory_order_release ) ;
+    table->count++ ;
+    
+    return *entry ;
+  }
+  
+  MetricsOwner::MetricsOwner()
+  {
+    MetricsData& data  = metrics() ;
+    bool         owned = false     ;
+    
+    for( this->record = data.records.load(); this->record != nullptr; this->record = this->record->next )
+    {
+      owned = false ;
+      if( this->record->in_use.compare_exchange_strong( owned, true ) ) return ;
+    }
+    
+    this->record         = new MetricsRecord()   ;
+    this->record->in_use = true                  ;
+    this->record->next   = data.records.load()   ;
+    
+    while( !data.records.compare_exchange_weak( this->record->next, this->record ) ) {} ;
+  }
+  
+  MetricsOwner::~MetricsOwner()
+  {
+    this->record->in_use = false ;
+  }
+  
+  /** Function to record data emitted over a topic, and print a report if one is due.
+   * @param signal The signal of the topic.
+   * @param count The amount of data emitted.
+   * @param fanout The amount of subscribers the data was sent to.
+   */
+  static void recordEmit( const Signal* signal, unsigned count, unsigned fanout )
+  {
+    MetricsData&   data     = metrics()                                        ;
+    MetricsRecord& record   = localMetrics()                                   ;
+    const unsigned interval = data.interval.load( std::memory_order_relaxed ) ;
+    
+    TopicCounters::Entry& counters = record.topic( signal->id ) ;
+    bump( counters.emits     , count                                             ) ;
+    bump( counters.deliveries, static_cast<unsigned long long>( count ) * fanout ) ;
+    
+    if( interval == 0 ) return ;
+    
+    const long long now  = metricsTime() / 1000000 ;
+    long long       last = data.last_dump.load()    ;
+    
+    // Only the thread that moves the time forward prints, so reports are not doubled up.
+    if( now - last >= interval && data.last_dump.compare_exchange_strong( last, now ) )
+    {
+      std::cout << Bus::stats().output() << std::flush ;
+    }
+  }
+  
+  /** RAII object to time a single call to a subscriber and record it.
+   */
+  class CallMetric
+  {
+    public:
+      CallMetric( const Signal* signal, const Bus::Delegate& sub ) ;
+      ~CallMetric() ;
+    private:
+      const Signal*        signal ;
+      const Bus::Delegate& sub    ;
+      long long            start  ;
+  };
+  
+  CallMetric::CallMetric( const Signal* signal, const Bus::Delegate& sub ) : sub( sub )
+  {
+    this->signal = signal        ;
+    this->start  = metricsTime() ;
+  }
+  
+  CallMetric::~CallMetric()
+  {
+    using Function = void (*)() ;
+    
+    MetricsRecord& record   = localMetrics()              ;
+    long long      elapsed  = metricsTime() - this->start ;
+    unsigned       bucket   = 0                           ;
+    Function       function = nullptr                     ;
+    
+    if( this->sub.object == nullptr ) function = this->sub.callable.load<Function>() ;
+    
+    while( elapsed > 1 && bucket + 1 < SubscriberStats::LATENCY_BUCKETS )
+    {
+      elapsed >>= 1 ;
+      bucket++ ;
+    }
+    
+    SubscriberCounters::Entry& counters = record.subscriber( this->signal->id, this->sub.object, reinterpret_cast<const void*>( this->sub.trampoline ), function ) ;
+    bump( counters.calls            , 1 ) ;
+    bump( counters.latency[ bucket ], 1 ) ;
+  }
+#else
+  /** Does nothing, as the bus was built without IRIS_BUS_METRICS.
+   */
+  static inline void recordEmit( const Signal*, unsigned, unsigned ) {}
+  
+  /** Does nothing, as the bus was built without IRIS_BUS_METRICS.
+   */
+  class CallMetric
+  {
+    public:
+      CallMetric( const Signal*, const Bus::Delegate& ) {}
+  };
+#endif
+  
+  /** Function to call every subscriber of a slot.
+   * @param slot The slot to send the data to.
+   * @param value The data to send.
+   * @param idx The index of the data.
+   */
+  static void dispatch( SignalSlot* slot, const void* value, unsigned idx )
+  {
+    EpochGuard guard ;
+    const Signal::SubscriberList* list = slot->subscribers.load() ;
+    
+    if( list )
+    {
+      for( const auto& sub : *list )
+      {
+        CallMetric metric( slot->signal, sub ) ;
+        sub.trampoline( sub, value, idx ) ;
+      }
+    }
+    
+    recordEmit( slot->signal, 1, list ? static_cast<unsigned>( list->size() ) : 0 ) ;
+  }
+  
+  /** Function to call every subscriber of a slot, moving the data into the last one if it takes ownership.
+   * @param slot The slot to send the data to.
+   * @param value The data to send. Left moved-from if the last subscriber took it.
+   * @param idx The index of the data.
+   */
+  static void dispatchMoved( SignalSlot* slot, void* value, unsigned idx )
+  {
+    EpochGuard guard ;
+    const Signal::SubscriberList* list = slot->subscribers.load() ;
+    
+    if( list && !list->empty() )
+    {
+      const Bus::Delegate& last = list->back() ;
+      
+      for( auto iter = list->begin(); iter != list->end() - 1; ++iter )
+      {
+        CallMetric metric( slot->signal, *iter ) ;
+        iter->trampoline( *iter, value, idx ) ;
+      }
+      
+      CallMetric metric( slot->signal, last ) ;
+      if( last.sink ) last.sink      ( last, value, idx ) ;
+      else            last.trampoline( last, value, idx ) ;
+    }
+    
+    recordEmit( slot->signal, 1, list ? static_cast<unsigned>( list->size() ) : 0 ) ;
+  }
+  
+  /** Function to call a single subscriber with a contiguous batch of data.
+   * @param signal The signal the data was sent over.
+   * @param sub The subscriber to call.
+   * @param values The data to send.
+   * @param stride The size of a single value, in bytes.
+   * @param count The amount of data to send.
+   * @param first The index of the first value.
+   */
+  static void deliver( const Signal* signal, const Bus::Delegate& sub, const void* values, unsigned stride, unsigned count, unsigned first )
+  {
+    const char* bytes = static_cast<const char*>( values ) ;
+    
+    if( sub.batch )
+    {
+      CallMetric metric( signal, sub ) ;
+      sub.batch( sub, values, count, first ) ;
+      return ;
+    }
+    
+    for( unsigned index = 0; index < count; index++ )
+    {
+      CallMetric metric( signal, sub ) ;
+      sub.trampoline( sub, static_cast<const void*>( bytes + static_cast<size_t>( index ) * stride ), first + index ) ;
+    }
+  }
+  
+  /** Function to call every subscriber of a slot with a contiguous batch of data.
+   * @note Each subscriber gets the whole batch before the next one does, so a subscriber's own data stays in order.
+   * @param slot The slot to send the data to.
+   * @param values The data to send.
+   * @param stride The size of a single value, in bytes.
+   * @param count The amount of data to send.
+   * @param first The index of the first value.
+   */
+  static void dispatchBatch( SignalSlot* slot, const void* values, unsigned stride, unsigned count, unsigned first )
+  {
+    EpochGuard guard ;
+    const Signal::SubscriberList* list = slot->subscribers.load() ;
+    
+    if( list == nullptr || count == 0 ) return ;
+    
+    for( const auto& sub : *list )
+    {
+      deliver( slot->signal, sub, values, stride, count, first ) ;
+    }
+    
+    recordEmit( slot->signal, count, static_cast<unsigned>( list->size() ) ) ;
+  }
+  
+  struct BusData
+  {
+    using MailboxList = std::vector<Bus::Mailbox*> ;
+
+    /** Structure to describe the route of one publisher of this bus for the pull-style emit.
+     * @note Slots are resolved when the route is made and live for the lifetime of the program, so emitting does no look ups.
+     */
+    struct Pull
+    {
+      unsigned           topic     ; ///< The id of the topic published over. Routes are sorted by it.
+      SignalSlot*        universal ; ///< The slot of the topic's subscriptions that take no data.
+      SignalSlot*        typed     ; ///< The slot of the topic's subscriptions to the published type, or nullptr if it publishes no data.
+      Signal::Publisher* publisher ; ///< The publisher.
+    };
+    
+    using PullList = std::vector<Pull> ;
+    
+    /** Structure to describe one conversion baked in for a subscription of this bus.
+     */
+    struct Adapter
+    {
+      unsigned      to       ; ///< The hash of the type subscribed to.
+      unsigned      from     ; ///< The hash of the type converted from, whose slot the delegate is in.
+      Bus::Delegate delegate ; ///< The delegate that converts data and calls the subscription. It's object is a copy of the subscription.
+    };
+    
+    using AdapterList   = std::vector<Adapter>                                  ;
+    using LocalAdapters = std::map<unsigned, std::pair<Signal*, AdapterList>> ;
+    
+    LocalSubscribers                sub_map          ;
+    LocalSubscribers                required_sub_map ;
+    LocalPublishers                 pub_map          ;
+    LocalPatterns                   pattern_map      ; ///< The wildcard subscriptions of this bus. Not copied between buses, as they own their patterns.
+    std::atomic<const PullList*>    pulls            ; ///< Immutable routing table built from @pub_map for emitting. Replaced on every change.
+    std::atomic<const MailboxList*> mailboxes        ; ///< Immutable snapshot of the ASYNC subscriptions in @sub_map for draining.
+    unsigned                        identifier       ;
+    std::mutex                      lock             ; ///< Lock for this object's maps. Never held while calling subscribers.
+    std::recursive_mutex            pull_lock        ; ///< Lock for pulling publishers, as by-value publishers share their storage between emits.
+    Executor*                       executor         ; ///< The executor this bus's streams resume coroutines on.
+    std::map<unsigned, Bus::Rate>   limits           ; ///< The limits set on this bus's subscriptions, by topic.
+    Arrivals*                       arrivals         ; ///< The eventcount this bus's REQUIRED subscriptions signal for Bus::wait.
+    LocalAdapters                   adapters         ; ///< The conversions of this bus's subscriptions, by topic. Not copied between buses, as they own their delegates.
+    
+    BusData() ;
+    BusData& operator=( const BusData& bus ) ;
+    ~BusData() ;
+    
+    /** Method to remove every subscription this bus made from their signals.
+     * @note Expects this object's lock to be held.
+     */
+    void releaseSubscribers() ;
+    
+    /** Method to add a conversion into a subscription for every type registered to convert into it's type.
+     * @note Expects this object's lock to be held.
+     * @param signal The signal of the subscription.
+     * @param topic The id of the subscription's topic.
+     * @param type_id The hash of the type subscribed to.
+     * @param sub The subscription.
+     * @return The conversions added.
+     */
+    AdapterList adapt( Signal* signal, unsigned topic, unsigned type_id, const Bus::Delegate& sub ) ;
+    
+    /** Method to remove the conversions into a subscription from it's signal.
+     * @note Expects this object's lock to be held. Must be called before the subscription itself is removed.
+     * @param topic The id of the subscription's topic.
+     * @param type_id The hash of the type subscribed to.
+     */
+    void releaseAdapters( unsigned topic, unsigned type_id ) ;
+    
+    /** Method to remove every publisher this bus made from their signals.
+     * @note Expects this object's lock to be held.
+     */
+    void releasePublishers() ;
+    
+    /** Method to remove a wildcard subscription from the index and every topic it matched, and release it.
+     * @note Expects it's mailbox, if any, to be out of the drain snapshot already.
+     * @param pattern The subscription to release.
+     */
+    static void releasePattern( Pattern* pattern ) ;
+    
+    /** Method to rebuild the routing table of this bus's publishers from @pub_map.
+     * @note Expects this object's lock to be held.
+     */
+    void refreshPulls() ;
+    
+    /** Method to rebuild the snapshot of this bus's ASYNC subscriptions from @sub_map and @pattern_map.
+     * @note Expects this object's lock to be held. Must be called before a removed mailbox is released.
+     */
+    void refreshMailboxes() ;
+  };
+
+  /** Function to pull data from a publisher and send it along it's route.
+   * @param pull The route of the publisher.
+   * @param idx The index to publish with.
+   */
+  static void route( const BusData::Pull& pull, unsigned idx )
+  {
+    const void* value = pull.publisher->execute( idx ) ;
+    
+    dispatch( pull.universal, value, idx ) ;
+    if( pull.typed ) dispatch( pull.typed, value, idx ) ;
+  }
+  
+  /** Function to hand what a retained topic kept to a new subscription.
+   * @param signal The signal of the topic.
+   * @param type_id The hash of the type of data the subscription recieves.
+   * @param sub The subscription.
+   */
+  static void deliverRetained( Signal* signal, unsigned type_id, const Bus::Delegate& sub )
+  {
+    if( !signal->retained.load() ) return ;
+    
+    EpochGuard  guard                                 ;
+    SignalSlot* slot = signal->slot( type_id, false ) ;
+    
+    if( slot == nullptr ) return ;
+    
+    // Emits of the topic hold the same lock, so none can slip newer data to the subscription before this hands it older data.
+    std::scoped_lock<std::recursive_mutex> lock( slot->order ) ;
+    const Retained*                        last = slot->last.load() ;
+    
+    // Hand over what the topic kept, now that the subscription can see new data too.
+    if( last ) deliver( signal, sub, last->values, last->stride, last->count, last->first ) ;
+  }
+  
+#ifdef __linux__
+  /** Function to sleep until a futex word changes from a value, or the timeout passes.
+   * @param word The futex word.
+   * @param value The value the word had.
+   * @param nanoseconds The most time to sleep, or a negative amount to sleep until woken.
+   */
+  static void futexWait( std::atomic<std::uint32_t>* word, std::uint32_t value, long long nanoseconds )
+  {
+    struct timespec timeout ;
+    
+    timeout.tv_sec  = static_cast<time_t>( nanoseconds / 1000000000 ) ;
+    timeout.tv_nsec = static_cast<long  >( nanoseconds % 1000000000 ) ;
+    
+    ::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( word ), FUTEX_WAIT_PRIVATE, value, nanoseconds < 0 ? nullptr : &timeout, nullptr, 0 ) ;
+  }
+  
+  /** Function to wake every thread sleeping on a futex word.
+   * @param word The futex word.
+   */
+  static void futexWake( std::atomic<std::uint32_t>* word )
+  {
+    ::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( word ), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0 ) ;
+  }
+#else
+  static void futexWait( std::atomic<std::uint32_t>* word, std::uint32_t value, long long nanoseconds )
+  {
+    // Without futexes, poll the word in short sleeps instead.
+    const long long step = nanoseconds < 0 || nanoseconds > 1000000 ? 1000000 : nanoseconds ;
+    
+    if( word->load() == value ) std::this_thread::sleep_for( std::chrono::nanoseconds( step ) ) ;
+  }
+  
+  static void futexWake( std::atomic<std::uint32_t>* )
+  {
+  }
+#endif
+  
+  Arrivals::Arrivals()
+  {
+    this->pending = 0 ;
+    this->waiters = 0 ;
+  }
+  
+  void Arrivals::add( int amount )
+  {
+    // Both are sequentially consistent, pairing with Bus::wait announcing itself before checking the word again.
+    this->pending.fetch_add( static_cast<std::uint32_t>( amount ) ) ;
+    if( this->waiters.load() != 0 ) futexWake( &this->pending ) ;
+  }
+  
+  void RequiredInput::arrive()
+  {
+    // Checked first, so a subscription flooded with data only costs a load until the next wait.
+    if( !this->fresh.load( std::memory_order_relaxed ) && !this->fresh.exchange( true ) ) this->arrivals->add( -1 ) ;
+  }
+  
+  void RequiredInput::detach()
+  {
+    // Data that arrived already took this subscription out of the pending count.
+    if( !this->fresh.exchange( true ) ) this->arrivals->add( -1 ) ;
+  }
+  
+  /** Static trampoline to call a REQUIRED subscription and count it's data as arrived.
+   * @param delegate The delegate of the wrapped subscription.
+   * @param pointer Pointer to the data.
+   * @param idx The index to use for the subscription.
+   */
+  static void callRequired( const Bus::Delegate& delegate, const void* pointer, unsigned idx )
+  {
+    RequiredInput* input = static_cast<RequiredInput*>( delegate.object ) ;
+    
+    input->delegate.trampoline( input->delegate, pointer, idx ) ;
+    input->arrive() ;
+  }
+  
+  /** Static trampoline to hand a batch to a REQUIRED subscription and count it's data as arrived.
+   * @param delegate The delegate of the wrapped subscription.
+   * @param values The batch.
+   * @param count The amount of data in the batch.
+   * @param first The index of the first value.
+   */
+  static void callRequiredBatch( const Bus::Delegate& delegate, const void* values, unsigned count, unsigned first )
+  {
+    RequiredInput* input = static_cast<RequiredInput*>( delegate.object ) ;
+    
+    input->delegate.batch( input->delegate, values, count, first ) ;
+    input->arrive() ;
+  }
+  
+  /** Static trampoline to move data into a REQUIRED subscription and count it as arrived.
+   * @param delegate The delegate of the wrapped subscription.
+   * @param pointer Pointer to the data to move.
+   * @param idx The index to use for the subscription.
+   */
+  static void sinkRequired( const Bus::Delegate& delegate, void* pointer, unsigned idx )
+  {
+    RequiredInput* input = static_cast<RequiredInput*>( delegate.object ) ;
+    
+    input->delegate.sink( input->delegate, pointer, idx ) ;
+    input->arrive() ;
+  }
+  
+  /** Function to retrieve the REQUIRED wrapper of a subscription, if it has one.
+   * @param sub The subscription.
+   * @return The wrapper of the subscription, or nullptr if it is not REQUIRED.
+   */
+  static RequiredInput* requiredOf( const Bus::Delegate& sub )
+  {
+    return sub.trampoline == &callRequired ? static_cast<RequiredInput*>( sub.object ) : nullptr ;
+  }
+  
+  /** Function to retrieve the mailbox of a subscription, if it has one.
+   * @note Limiters count as mailboxes, as they hold data to be delivered by draining too. REQUIRED wrappers are looked through.
+   * @param sub The subscription.
+   * @return The mailbox of the subscription, or nullptr if it is delivered synchronously.
+   */
+  static Bus::Mailbox* mailboxOf( const Bus::Delegate& sub )
+  {
+    const RequiredInput* input = requiredOf( sub ) ;
+    
+    if( input ) return mailboxOf( input->delegate ) ;
+    return sub.trampoline == &Bus::Mailbox::call || sub.trampoline == &Bus::Limiter::call ? static_cast<Bus::Mailbox*>( sub.object ) : nullptr ;
+  }
+  
+  /** Function to check whether two delegates make the same call.
+   * @param first The first delegate.
+   * @param second The second delegate.
+   * @return Whether or not the delegates are the same.
+   */
+  static bool same( const Bus::Delegate& first, const Bus::Delegate& second )
+  {
+    return first.object == second.object && first.trampoline == second.trampoline && first.batch == second.batch && first.sink == second.sink && std::memcmp( &first.callable, &second.callable, sizeof( Bus::Delegate::Callable ) ) == 0 ;
+  }
+  
+  Key::Key()
+  {
+    this->key_data = new KeyData() ;
+  }
+
+  Key::Key( const Key& string )
+  {
+    this->key_data = new KeyData() ;
+    *this->key_data = *string.key_data ;
+  }
+  
+  void Key::operator=( const Key& string )
+  {
+    *this->key_data = *string.key_data ;
+  }
+      
+  Key::~Key()
+  {
+    delete this->key_data ;
+  }
+  
+  void Key::setStr( const char* str )
+  {
+    data().str = str ;
+  }
+
+  const char* Key::str() const
+  {
+    return data().str.c_str() ;
+  }
+  
+  void Key::append( const char* str )
+  {
+    data().str.append( str ) ;
+  }
+  
+  void Key::clear()
+  {
+    data().str.clear() ;
+  }
+
+  KeyData& Key::data()
+  {
+    return *this->key_data ;
+  }
+
+  const KeyData& Key::data() const
+  {
+    return *this->key_data ;
+  }
+
+  EpochData::EpochData()
+  {
+    this->epoch   = 1       ;
+    this->records = nullptr ;
+  }
+  
+  void EpochData::collect()
+  {
+    std::vector<Retired> expired ;
+    unsigned long long   active  ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( this->lock ) ;
+      unsigned long long           oldest = this->epoch.load() ;
+      
+      for( auto record = this->records.load(); record != nullptr; record = record->next )
+      {
+        active = record->epoch.load() ;
+        if( active != 0 && active < oldest ) oldest = active ;
+      }
+      
+      // Anything retired before the oldest active reader entered can no longer be seen by anyone.
+      auto end = std::partition( this->retired.begin(), this->retired.end(), [=] ( const Retired& ret ) { return ret.epoch >= oldest ; } ) ;
+      
+      expired.assign( end, this->retired.end() ) ;
+      this->retired.erase( end, this->retired.end() ) ;
+    }
+    
+    // Released without the lock, as a release may retire something else on this same thread.
+    for( const auto& ret : expired )
+    {
+      ret.release( ret.pointer ) ;
+    }
+  }
+  
+  EpochOwner::EpochOwner()
+  {
+    EpochData& data  = epochs() ;
+    bool       owned = false    ;
+    
+    for( this->record = data.records.load(); this->record != nullptr; this->record = this->record->next )
+    {
+      owned = false ;
+      if( this->record->in_use.compare_exchange_strong( owned, true ) ) return ;
+    }
+    
+    this->record         = new EpochRecord() ;
+    this->record->epoch  = 0                 ;
+    this->record->in_use = true              ;
+    this->record->depth  = 0                 ;
+    this->record->next   = data.records.load() ;
+    
+    while( !data.records.compare_exchange_weak( this->record->next, this->record ) ) {} ;
+  }
+  
+  EpochOwner::~EpochOwner()
+  {
+    this->record->epoch  = 0     ;
+    this->record->depth  = 0     ;
+    this->record->in_use = false ;
+  }
+  
+  EpochGuard::EpochGuard()
+  {
+    thread_local EpochOwner owner ;
+    
+    this->record = owner.record ;
+    if( this->record->depth++ == 0 )
+    {
+      this->record->epoch.store( epochs().epoch.load() ) ;
+    }
+  }
+  
+  EpochGuard::~EpochGuard()
+  {
+    if( --this->record->depth == 0 )
+    {
+      this->record->epoch.store( 0 ) ;
+    }
+  }
+  
+  QueueConfig::QueueConfig()
+  {
+    this->depth     = 64                   ;
+    this->policy    = Overflow::DropNewest ;
+    this->dropped   = 0                    ;
+    this->coalesced = 0                    ;
+  }
+  
+  /** Function to resume the coroutine waiting on a mailbox, if any.
+   * @param data The mailbox's queue, after data was published to it.
+   */
+  static void wake( MailboxData& data )
+  {
+    void* address = nullptr ;
+    
+    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    
+    if( data.waiter.load( std::memory_order_relaxed ) == nullptr || ( address = data.waiter.exchange( nullptr ) ) == nullptr ) return ;
+    
+    if( data.context ) data.context->post( data.resume, address ) ;
+    else               data.resume( address ) ;
+  }
+  
+  MailboxData::MailboxData( QueueConfig& config )
+  {
+    unsigned size = 2 ;
+    
+    // A single cell can not tell full from empty, so queues hold at least two.
+    while( size < config.depth.load() ) size <<= 1 ;
+    
+    this->cells   = new Cell[ size ] ;
+    this->mask    = size - 1         ;
+    this->config  = &config          ;
+    this->enqueue = 0                ;
+    this->dequeue = 0                ;
+    this->closed  = false            ;
+    this->space   = 0                ;
+    this->blocked = 0                ;
+    this->waiter  = nullptr          ;
+    this->resume  = nullptr          ;
+    this->context = nullptr          ;
+    
+    for( unsigned index = 0; index < size; index++ )
+    {
+      this->cells[ index ].sequence.store( index, std::memory_order_relaxed ) ;
+      this->cells[ index ].idx = 0 ;
+    }
+  }
+  
+  MailboxData::~MailboxData()
+  {
+    delete[] this->cells ;
+  }
+  
+  bool MailboxData::claim( unsigned long long& pos )
+  {
+    pos = this->enqueue.load( std::memory_order_relaxed ) ;
+    
+    while( true )
+    {
+      const Cell&     cell = this->cells[ pos & this->mask ]                                                    ;
+      const long long diff = static_cast<long long>( cell.sequence.load( std::memory_order_acquire ) - pos ) ;
+      
+      if( diff == 0 )
+      {
+        if( this->enqueue.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) return true ;
+      }
+      else if( diff < 0 )
+      {
+        return false ;
+      }
+      else
+      {
+        pos = this->enqueue.load( std::memory_order_relaxed ) ;
+      }
+    }
+  }
+  
+  bool MailboxData::take( unsigned long long& pos )
+  {
+    pos = this->dequeue.load( std::memory_order_relaxed ) ;
+    
+    while( true )
+    {
+      const Cell&     cell = this->cells[ pos & this->mask ]                                                          ;
+      const long long diff = static_cast<long long>( cell.sequence.load( std::memory_order_acquire ) - ( pos + 1 ) ) ;
+      
+      if( diff == 0 )
+      {
+        if( this->dequeue.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) return true ;
+      }
+      else if( diff < 0 )
+      {
+        return false ; // Empty, or the next cell is claimed but not yet written.
+      }
+      else
+      {
+        pos = this->dequeue.load( std::memory_order_relaxed ) ;
+      }
+    }
+  }
+  
+  void MailboxData::publish( unsigned long long pos, unsigned idx )
+  {
+    this->cells[ pos & this->mask ].idx = idx ;
+    this->cells[ pos & this->mask ].sequence.store( pos + 1, std::memory_order_release ) ;
+  }
+  
+  void MailboxData::release( unsigned long long pos )
+  {
+    this->cells[ pos & this->mask ].sequence.store( pos + this->mask + 1, std::memory_order_release ) ;
+    
+    // Pairs with the fence in block, so either a blocked producer sees the freed cell or this sees the producer.
+    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    
+    if( this->blocked.load( std::memory_order_relaxed ) != 0 ) this->unblock() ;
+  }
+  
+  bool MailboxData::full() const
+  {
+    const unsigned long long pos = this->enqueue.load( std::memory_order_relaxed ) ;
+    
+    return static_cast<long long>( this->cells[ pos & this->mask ].sequence.load( std::memory_order_acquire ) - pos ) < 0 ;
+  }
+  
+  void MailboxData::block()
+  {
+    // Space usually frees up quickly, so yield a few times before paying for a sleep.
+    for( unsigned attempt = 0; attempt < 64; attempt++ )
+    {
+      if( this->closed.load( std::memory_order_relaxed ) || !this->full() ) return ;
+      std::this_thread::yield() ;
+    }
+    
+    this->blocked.fetch_add( 1 ) ;
+    
+    const std::uint32_t seen = this->space.load() ;
+    
+    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    
+    if( this->full() && !this->closed.load() ) futexWait( &this->space, seen, -1 ) ;
+    
+    this->blocked.fetch_sub( 1 ) ;
+  }
+  
+  void MailboxData::unblock()
+  {
+    this->space.fetch_add( 1 ) ;
+    futexWake( &this->space ) ;
+  }
+  
+  Bus::Mailbox::Mailbox()
+  {
+    this->mailbox_data = nullptr ;
+    this->awaited      = false   ;
+    this->references   = 1       ;
+  }
+  
+  Bus::Mailbox::~Mailbox()
+  {
+    delete this->mailbox_data ;
+  }
+  
+  void Bus::Mailbox::acquire()
+  {
+    this->references.fetch_add( 1, std::memory_order_relaxed ) ;
+  }
+  
+  void Bus::Mailbox::release()
+  {
+    if( this->references.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) delete this ;
+  }
+  
+  Bus::MailboxHandle::MailboxHandle()
+  {
+    this->mailbox = nullptr ;
+  }
+  
+  Bus::MailboxHandle::MailboxHandle( Mailbox* mailbox )
+  {
+    this->mailbox = mailbox ;
+  }
+  
+  Bus::MailboxHandle::MailboxHandle( const MailboxHandle& handle )
+  {
+    this->mailbox = handle.mailbox ;
+    if( this->mailbox ) this->mailbox->acquire() ;
+  }
+  
+  Bus::MailboxHandle::~MailboxHandle()
+  {
+    if( this->mailbox ) this->mailbox->release() ;
+  }
+  
+  Bus::MailboxHandle& Bus::MailboxHandle::operator=( const MailboxHandle& handle )
+  {
+    if( handle.mailbox ) handle.mailbox->acquire() ;
+    if( this->mailbox  ) this->mailbox->release()  ;
+    
+    this->mailbox = handle.mailbox ;
+    return *this ;
+  }
+  
+  Bus::Mailbox* Bus::MailboxHandle::get() const
+  {
+    return this->mailbox ;
+  }
+  
+  void Bus::Mailbox::bind( QueueConfig& config )
+  {
+    delete this->mailbox_data ;
+    
+    this->mailbox_data = new MailboxData( config ) ;
+    this->allocate( this->mailbox_data->mask + 1 ) ;
+  }
+  
+  void Bus::Mailbox::execute( const void* pointer, unsigned idx )
+  {
+    this->push( pointer, idx, false ) ;
+  }
+  
+  void Bus::Mailbox::move( unsigned cell, void* pointer )
+  {
+    this->store( cell, pointer ) ;
+  }
+  
+  void Bus::Mailbox::push( const void* pointer, unsigned idx, bool moved )
+  {
+    MailboxData*       data   = this->mailbox_data ;
+    unsigned long long pos    = 0                  ;
+    unsigned long long oldest = 0                  ;
+    
+    if( data == nullptr ) return ;
+    
+    const Overflow policy = data->config->policy.load( std::memory_order_relaxed ) ;
+    
+    if( policy == Overflow::Coalesce )
+    {
+      while( data->take( oldest ) )
+      {
+        data->release( oldest ) ;
+        data->config->coalesced.fetch_add( 1, std::memory_order_relaxed ) ;
+      }
+    }
+    
+    while( !data->claim( pos ) )
+    {
+      switch( policy )
+      {
+        case Overflow::Block :
+          if( data->closed.load( std::memory_order_relaxed ) ) return ;
+          data->block() ;
+          break ;
+        case Overflow::DropOldest :
+        case Overflow::Coalesce   :
+          if( data->take( oldest ) )
+          {
+            data->release( oldest ) ;
+            ( policy == Overflow::Coalesce ? data->config->coalesced : data->config->dropped ).fetch_add( 1, std::memory_order_relaxed ) ;
+          }
+          break ;
+        default :
+          data->config->dropped.fetch_add( 1, std::memory_order_relaxed ) ;
+          return ;
+      }
+    }
+    
+    if( moved ) this->move ( static_cast<unsigned>( pos & data->mask ), const_cast<void*>( pointer ) ) ;
+    else        this->store( static_cast<unsigned>( pos & data->mask ), pointer                      ) ;
+    
+    data->publish( pos, idx ) ;
+    
+    if( this->awaited ) wake( *data ) ;
+  }
+  
+  void Bus::Mailbox::call( const Delegate& delegate, const void* pointer, unsigned idx )
+  {
+    static_cast<Mailbox*>( delegate.object )->execute( pointer, idx ) ;
+  }
+  
+  void Bus::Mailbox::sink( const Delegate& delegate, void* pointer, unsigned idx )
+  {
+    static_cast<Mailbox*>( delegate.object )->push( pointer, idx, true ) ;
+  }
+  
+  void Bus::Mailbox::close()
+  {
+    if( this->mailbox_data )
+    {
+      this->mailbox_data->closed.store( true ) ;
+      this->mailbox_data->unblock() ;
+    }
+  }
+  
+  unsigned Bus::Mailbox::drain()
+  {
+    MailboxData*       data  = this->mailbox_data ;
+    unsigned long long pos   = 0                  ;
+    unsigned           count = 0                  ;
+    
+    if( data == nullptr || this->awaited ) return 0 ;
+    
+    // Only deliver what was queued when draining started, so a subscriber emitting to itself can not starve the caller.
+    const unsigned long long end = data->enqueue.load( std::memory_order_acquire ) ;
+    
+    while( data->dequeue.load( std::memory_order_relaxed ) < end && data->take( pos ) )
+    {
+      this->deliver( static_cast<unsigned>( pos & data->mask ), data->cells[ pos & data->mask ].idx ) ;
+      data->release( pos ) ;
+      count++ ;
+    }
+    
+    return count ;
+  }
+  
+  bool Bus::Mailbox::take( bool wait )
+  {
+    MailboxData*       data = this->mailbox_data ;
+    unsigned long long pos  = 0                  ;
+    
+    if( data == nullptr ) return false ;
+    
+    while( !data->take( pos ) )
+    {
+      // The cell is claimed but still being copied into, or a coalescing emitter is swapping it for newer data.
+      if( !wait || data->closed.load( std::memory_order_relaxed ) ) return false ;
+      std::this_thread::yield() ;
+    }
+    
+    this->deliver( static_cast<unsigned>( pos & data->mask ), data->cells[ pos & data->mask ].idx ) ;
+    data->release( pos ) ;
+    
+    return true ;
+  }
+  
+  bool Bus::Mailbox::await( Executor* executor, Executor::Task resume, void* address )
+  {
+    MailboxData* data = this->mailbox_data ;
+    
+    if( data == nullptr ) return false ;
+    
+    data->context = executor ;
+    data->resume  = resume   ;
+    data->waiter.store( address ) ;
+    
+    // Pairs with the fence in wake, so either the emitter sees the waiter or this sees the emitter's data.
+    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    
+    if( data->enqueue.load( std::memory_order_relaxed ) != data->dequeue.load( std::memory_order_relaxed ) )
+    {
+      // Only stay suspended if an emitter already took the waiter, as it is resuming it.
+      return data->waiter.exchange( nullptr ) == nullptr ;
+    }
+    
+    return true ;
+  }
+  
+  /** Function to retrieve the current time of the clock limits are measured with.
+   * @return The time in nanoseconds.
+   */
+  static long long monotonicTime()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ;
+  }
+  
+  LimiterData::LimiterData( const Bus::Delegate& delegate, Limit limit, unsigned milliseconds )
+  {
+    this->delegate = delegate                                         ;
+    this->limit    = limit                                            ;
+    this->period   = static_cast<long long>( milliseconds ) * 1000000 ;
+    this->next     = 0                                                ;
+    this->cell     = 0                                                ;
+    this->idx      = 0                                                ;
+    this->held     = false                                            ;
+    this->flushing = false                                            ;
+  }
+  
+  bool LimiterData::due( long long now, unsigned& cell, unsigned& idx )
+  {
+    if( !this->held || this->flushing || now < this->next.load( std::memory_order_relaxed ) ) return false ;
+    
+    cell = this->cell ;
+    idx  = this->idx  ;
+    
+    this->cell    ^= 1     ;
+    this->held     = false ;
+    this->flushing = true  ;
+    
+    if( this->limit == Limit::Latest ) this->next.store( now + this->period, std::memory_order_relaxed ) ;
+    
+    return true ;
+  }
+  
+  Bus::Limiter::Limiter( const Delegate& delegate, Limit limit, unsigned milliseconds )
+  {
+    this->limiter_data = new LimiterData( delegate, limit, milliseconds ) ;
+  }
+  
+  Bus::Limiter::~Limiter()
+  {
+    Mailbox* mailbox = mailboxOf( this->limiter_data->delegate ) ;
+    
+    // The subscription's mailbox is only known to this limiter, so it is released along with it.
+    if( mailbox ) mailbox->release() ;
+    delete this->limiter_data ;
+  }
+  
+  void Bus::Limiter::execute( const void* pointer, unsigned idx )
+  {
+    LimiterData&    data     = *this->limiter_data ;
+    const long long now      = monotonicTime()     ;
+    unsigned        cell     = 0                   ;
+    unsigned        held_idx = 0                   ;
+    bool            due      = false               ;
+    
+    if( data.limit == Limit::Throttle )
+    {
+      long long next = data.next.load( std::memory_order_relaxed ) ;
+      
+      // Of emitters racing for the same period, only the one that moves it on gets through.
+      if( now >= next && data.next.compare_exchange_strong( next, now + data.period, std::memory_order_relaxed ) ) this->forward( pointer, idx ) ;
+      return ;
+    }
+    
+    std::unique_lock<std::mutex> lock( data.lock ) ;
+    
+    if( data.limit == Limit::Latest && now >= data.next.load( std::memory_order_relaxed ) )
+    {
+      // Anything still held is older than this, so it is dropped.
+      data.held = false ;
+      data.next.store( now + data.period, std::memory_order_relaxed ) ;
+      lock.unlock() ;
+      
+      this->forward( pointer, idx ) ;
+      return ;
+    }
+    
+    // For Limit::Debounce, data held from before a quiet period is delivered before holding this.
+    due = data.due( now, cell, held_idx ) ;
+    
+    this->store( data.cell, pointer ) ;
+    data.held = true ;
+    data.idx  = idx  ;
+    
+    if( data.limit == Limit::Debounce ) data.next.store( now + data.period, std::memory_order_relaxed ) ;
+    
+    lock.unlock() ;
+    
+    if( due )
+    {
+      this->deliver( cell, held_idx ) ;
+      
+      lock.lock() ;
+      data.flushing = false ;
+    }
+  }
+  
+  unsigned Bus::Limiter::drain()
+  {
+    LimiterData&  data     = *this->limiter_data        ;
+    Bus::Mailbox* mailbox  = mailboxOf( data.delegate ) ;
+    unsigned      cell     = 0                          ;
+    unsigned      held_idx = 0                          ;
+    unsigned      count    = 0                          ;
+    bool          due      = false                      ;
+    
+    if( data.limit != Limit::Throttle )
+    {
+      std::unique_lock<std::mutex> lock( data.lock ) ;
+      
+      due = data.due( monotonicTime(), cell, held_idx ) ;
+      lock.unlock() ;
+      
+      if( due )
+      {
+        this->deliver( cell, held_idx ) ;
+        if( mailbox == nullptr ) count++ ;
+        
+        lock.lock() ;
+        data.flushing = false ;
+      }
+    }
+    
+    return mailbox ? count + mailbox->drain() : count ;
+  }
+  
+  void Bus::Limiter::bind( QueueConfig& config )
+  {
+    Bus::Mailbox* mailbox = mailboxOf( this->limiter_data->delegate ) ;
+    if( mailbox ) mailbox->bind( config ) ;
+  }
+  
+  void Bus::Limiter::close()
+  {
+    Bus::Mailbox* mailbox = mailboxOf( this->limiter_data->delegate ) ;
+    if( mailbox ) mailbox->close() ;
+  }
+  
+  void Bus::Limiter::call( const Delegate& delegate, const void* pointer, unsigned idx )
+  {
+    static_cast<Limiter*>( static_cast<Mailbox*>( delegate.object ) )->execute( pointer, idx ) ;
+  }
+  
+  void Bus::Limiter::forward( const void* pointer, unsigned idx )
+  {
+    this->limiter_data->delegate.trampoline( this->limiter_data->delegate, pointer, idx ) ;
+  }
+  
+  ReplyData::ReplyData()
+  {
+    this->refs    = 1       ;
+    this->copies  = 0       ;
+    this->status  = PENDING ;
+    this->waiter  = nullptr ;
+    this->resume  = nullptr ;
+    this->context = nullptr ;
+  }
+  
+  Bus::ReplyState::ReplyState()
+  {
+    this->reply_data = new ReplyData() ;
+  }
+  
+  Bus::ReplyState::~ReplyState()
+  {
+    delete this->reply_data ;
+  }
+  
+  void Bus::ReplyState::acquire()
+  {
+    this->reply_data->refs.fetch_add( 1, std::memory_order_relaxed ) ;
+  }
+  
+  void Bus::ReplyState::release()
+  {
+    if( this->reply_data->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) delete this ;
+  }
+  
+  void Bus::ReplyState::acquireRequest()
+  {
+    this->reply_data->copies.fetch_add( 1, std::memory_order_relaxed ) ;
+    this->acquire() ;
+  }
+  
+  void Bus::ReplyState::releaseRequest()
+  {
+    if( this->reply_data->copies.fetch_sub( 1, std::memory_order_acq_rel ) == 1 && this->claim() ) this->complete( false ) ;
+    
+    this->release() ;
+  }
+  
+  bool Bus::ReplyState::claim()
+  {
+    unsigned expected = ReplyData::PENDING ;
+    return this->reply_data->status.compare_exchange_strong( expected, ReplyData::CLAIMED, std::memory_order_acquire ) ;
+  }
+  
+  void Bus::ReplyState::complete( bool answered )
+  {
+    ReplyData& data    = *this->reply_data ;
+    void*      address = nullptr           ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( data.lock ) ;
+      data.status.store( answered ? ReplyData::ANSWERED : ReplyData::FAILED, std::memory_order_release ) ;
+    }
+    
+    data.cv.notify_all() ;
+    
+    // Pairs with the fence in await, so either the waiter is seen here or the finished status is seen there.
+    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    
+    if( data.waiter.load( std::memory_order_relaxed ) == nullptr || ( address = data.waiter.exchange( nullptr ) ) == nullptr ) return ;
+    
+    if( data.context ) data.context->post( data.resume, address ) ;
+    else               data.resume( address ) ;
+  }
+  
+  bool Bus::ReplyState::ready() const
+  {
+    return this->reply_data->status.load( std::memory_order_acquire ) >= ReplyData::ANSWERED ;
+  }
+  
+  bool Bus::ReplyState::answered() const
+  {
+    return this->reply_data->status.load( std::memory_order_acquire ) == ReplyData::ANSWERED ;
+  }
+  
+  bool Bus::ReplyState::wait( unsigned milliseconds ) const
+  {
+    std::unique_lock<std::mutex> lock( this->reply_data->lock ) ;
+    
+    return this->reply_data->cv.wait_for( lock, std::chrono::milliseconds( milliseconds ), [this] () { return this->ready() ; } ) ;
+  }
+  
+  void Bus::ReplyState::wait() const
+  {
+    std::unique_lock<std::mutex> lock( this->reply_data->lock ) ;
+    
+    this->reply_data->cv.wait( lock, [this] () { return this->ready() ; } ) ;
+  }
+  
+  bool Bus::ReplyState::await( Executor* executor, Executor::Task resume, void* address )
+  {
+    ReplyData& data = *this->reply_data ;
+    
+    data.context = executor ;
+    data.resume  = resume   ;
+    data.waiter.store( address ) ;
+    
+    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+    
+    // Only stay suspended if the request is still going, or if whatever finished it already took the waiter.
+    return !this->ready() || data.waiter.exchange( nullptr ) == nullptr ;
+  }
+  
+  Retained::~Retained()
+  {
+    this->release( this->values, this->count ) ;
+  }
+  
+  Signal::Signal()
+  {
+    this->slots     = nullptr ;
+    this->retained  = false   ;
+    this->retainers = 0       ;
+    this->id        = 0       ;
+  }
+  
+  SignalSlot::SignalSlot( Signal* signal, unsigned type_id, SignalSlot* next )
+  {
+    this->signal      = signal  ;
+    this->type_id     = type_id ;
+    this->subscribers = nullptr ;
+    this->last        = nullptr ;
+    this->next        = next    ;
+  }
+
+  Signal::Publisher::Publisher()
+  {
+    this->pub_ptr = nullptr ;
+  }
+  
+  Signal::Publisher::~Publisher()
+  {
+    delete this->pub_ptr ;
+  }
+  
+  void Signal::Publisher::initialize( Bus::Publisher* pub )
+  {
+    this->pub_ptr = pub ; 
+  }
+  
+  SignalSlot* Signal::slot( unsigned type_id, bool create )
+  {
+    for( auto slot = this->slots.load(); slot != nullptr; slot = slot->next )
+    {
+      if( slot->type_id == type_id ) return slot ;
+    }
+    
+    if( !create ) return nullptr ;
+    
+    std::scoped_lock<std::mutex> lock( this->signal_mutex ) ;
+    
+    // Another thread may have made the slot while we waited on the lock.
+    for( auto slot = this->slots.load(); slot != nullptr; slot = slot->next )
+    {
+      if( slot->type_id == type_id ) return slot ;
+    }
+    
+    this->slots.store( new SignalSlot( this, type_id, this->slots.load() ) ) ;
+    return this->slots.load() ;
+  }
+  
+  void Signal::insert( unsigned id, const Bus::Delegate& sub )
+  {
+    SignalSlot* slot = this->slot( id, true ) ;
+    
+    this->signal_mutex.lock() ;
+    auto old  = slot->subscribers.load() ;
+    auto list = old ? new SubscriberList( *old ) : new SubscriberList() ;
+    
+    list->push_back( sub ) ;
+    slot->subscribers.store( list ) ;
+    this->signal_mutex.unlock() ;
+    
+    retire( old ) ;
+  }
+  
+  Signal::PublisherIterator Signal::insert( unsigned id, Bus::Publisher* pub )
+  {
+    Signal::Publisher* signal_pub = new Signal::Publisher() ;
+    signal_pub->initialize( pub ) ;
+    
+    this->signal_mutex.lock() ;
+    auto ret = this->publishers.insert( { id, signal_pub } ) ;
     this->signal_mutex.unlock() ;
     return ret ;
   }
   
-  void Signal::remove( Signal::SubscriberIterator& iter )
+  void Signal::remove( unsigned id, const Bus::Delegate& sub, bool release )
+  {
+    SignalSlot*           slot = this->slot( id, false ) ;
+    const SubscriberList* old  = nullptr                 ;
+    
+    if( slot == nullptr ) return ;
+    
+    this->signal_mutex.lock() ;
+    old = slot->subscribers.load() ;
+    
+    auto iter = old ? std::find_if( old->begin(), old->end(), [&] ( const Bus::Delegate& current ) { return same( current, sub ) ; } ) : SubscriberList::const_iterator() ;
+    
+    if( old && iter != old->end() )
+    {
+      auto list = new SubscriberList() ;
+      
+      // Identical delegates are interchangeable, so only one copy is removed.
+      list->reserve( old->size() - 1 ) ;
+      list->insert( list->end(), old->begin(), iter ) ;
+      list->insert( list->end(), iter + 1, old->end() ) ;
+      slot->subscribers.store( list ) ;
+    }
+    else
+    {
+      old = nullptr ;
+    }
+    this->signal_mutex.unlock() ;
+    
+    if( old )
+    {
+      auto mailbox = mailboxOf ( sub ) ;
+      auto input   = requiredOf( sub ) ;
+      
+      retire( old ) ;
+      
+      if( mailbox && release )
+      {
+        mailbox->close() ;
+        retire( mailbox ) ;
+      }
+      
+      if( input && release )
+      {
+        input->detach() ;
+        retire( input ) ;
+      }
+    }
+  }
+  
+  void Signal::remove( Signal::PublisherIterator& iter )
+  {
+    this->signal_mutex.lock() ;
+    this->publishers.erase( iter ) ;
+    this->signal_mutex.unlock() ;
+  }
+  
+  const void* Signal::Publisher::execute( unsigned idx )
+  {
+    return this->pub_ptr->publish( idx ) ;
+  }
+  
+  BusData& BusData::operator=( const BusData& bus )
+  {
+    this->identifier = bus.identifier ;
+    this->executor   = bus.executor   ;
+    this->limits     = bus.limits     ;
+    this->pub_map    = bus.pub_map    ;
+    this->sub_map    = bus.sub_map    ;
+    this->refreshPulls    () ;
+    this->refreshMailboxes() ;
+    
+    return *this ;
+  }
+
+  BusData::BusData()
+  {
+    this->identifier = 0              ;
+    this->pulls      = nullptr        ;
+    this->mailboxes  = nullptr        ;
+    this->executor   = nullptr        ;
+    this->arrivals   = new Arrivals() ;
+  }
+  
+  BusData::~BusData()
+  {
+    this->lock.lock() ;
+    this->releaseSubscribers() ;
+    this->releasePublishers () ;
+    retire( this->pulls    .exchange( nullptr ) ) ;
+    retire( this->mailboxes.exchange( nullptr ) ) ;
+    retire( this->arrivals ) ;
+    this->lock.unlock() ;
+  }
+  
+  void BusData::releaseSubscribers()
+  {
+    LocalSubscribers released          ;
+    LocalPatterns    released_patterns ;
+    
+    released.swap( this->sub_map ) ;
+    released_patterns.swap( this->pattern_map ) ;
+    this->required_sub_map.clear() ;
+    
+    // Conversions call into the subscriptions, so they go first.
+    while( !this->adapters.empty() )
+    {
+      const auto& front = this->adapters.begin()->second.second.front() ;
+      this->releaseAdapters( this->adapters.begin()->first, front.to ) ;
+    }
+    
+    // Mailboxes must be out of the drain snapshot before their subscriptions are retired.
+    this->refreshMailboxes() ;
+    
+    for( auto& iter : released )
+    {
+      for( auto& sub : iter.second.second )
+      {
+        iter.second.first->remove( sub.first, sub.second ) ;
+      }
+    }
+    
+    for( auto& iter : released_patterns )
+    {
+      for( auto& pattern : iter.second )
+      {
+        BusData::releasePattern( pattern.second ) ;
+      }
+    }
+  }
+  
+  BusData::AdapterList BusData::adapt( Signal* signal, unsigned topic, unsigned type_id, const Bus::Delegate& sub )
+  {
+    AdapterList added ;
+    
+    for( auto conversion : findConversions( type_id ) )
+    {
+      Adapter adapter = {} ;
+      
+      adapter.to                  = type_id                                        ;
+      adapter.from                = conversion->from.ctti_hash                     ;
+      adapter.delegate.object     = static_cast<void*>( new Bus::Delegate( sub ) ) ;
+      adapter.delegate.trampoline = conversion->trampoline                         ;
+      
+      signal->insert( adapter.from, adapter.delegate ) ;
+      added.push_back( adapter ) ;
+    }
+    
+    if( !added.empty() )
+    {
+      auto& entry = this->adapters[ topic ] ;
+      
+      entry.first = signal ;
+      entry.second.insert( entry.second.end(), added.begin(), added.end() ) ;
+    }
+    
+    return added ;
+  }
+  
+  void BusData::releaseAdapters( unsigned topic, unsigned type_id )
+  {
+    auto iter = this->adapters.find( topic ) ;
+    
+    if( iter == this->adapters.end() ) return ;
+    
+    Signal*      signal = iter->second.first  ;
+    AdapterList& list   = iter->second.second ;
+    auto         kept   = std::stable_partition( list.begin(), list.end(), [&] ( const Adapter& adapter ) { return adapter.to != type_id ; } ) ;
+    
+    for( auto adapter = kept; adapter != list.end(); ++adapter )
+    {
+      signal->remove( adapter->from, adapter->delegate, false ) ;
+      retire( static_cast<const Bus::Delegate*>( adapter->delegate.object ) ) ;
+    }
+    
+    list.erase( kept, list.end() ) ;
+    if( list.empty() ) this->adapters.erase( iter ) ;
+  }
+  
+  void BusData::releasePattern( Pattern* pattern )
+  {
+    Bus::Mailbox*  mailbox = mailboxOf ( pattern->delegate ) ;
+    RequiredInput* input   = requiredOf( pattern->delegate ) ;
+    
+    // Once out of the index, no other thread touches the pattern, so it's signals are final.
+    patterns().remove( pattern ) ;
+    
+    for( auto signal : pattern->signals )
+    {
+      signal->remove( pattern->type_id, pattern->delegate, false ) ;
+    }
+    
+    // Every signal shares the one mailbox, so it is only released once.
+    if( mailbox )
+    {
+      mailbox->close() ;
+      retire( mailbox ) ;
+    }
+    
+    if( input )
+    {
+      input->detach() ;
+      retire( input ) ;
+    }
+    
+    delete pattern ;
+  }
+  
+  void BusData::releasePublishers()
+  {
+    std::vector<Signal::Publisher*> released ;
+    
+    for( auto& iter : this->pub_map )
+    {
+      for( auto& pub : iter.second.second )
+      {
+        released.push_back( pub.second->second ) ;
+        iter.second.first->remove( pub.second ) ;
+      }
+    }
+    
+    this->pub_map.clear() ;
+    this->refreshPulls() ;
+    
+    // Only retire once the publishers are unlinked from the snapshot emitters read.
+    for( auto pub : released ) retire( pub ) ;
+  }
+  
+  void BusData::refreshPulls()
+  {
+    auto list = new PullList() ;
+    
+    for( auto& iter : this->pub_map )
+    {
+      for( auto& pub : iter.second.second )
+      {
+        Signal*     signal = iter.second.first                                                            ;
+        SignalSlot* typed  = pub.first != Bus::UNIVERSAL_TYPE ? signal->slot( pub.first, true ) : nullptr ;
+        
+        // pub_map is ordered by topic, so the table is too.
+        list->push_back( { iter.first, signal->slot( Bus::UNIVERSAL_TYPE, true ), typed, pub.second->second } ) ;
+      }
+    }
+    
+    retire( this->pulls.exchange( list ) ) ;
+  }
+  
+  void BusData::refreshMailboxes()
+  {
+    auto list = new MailboxList() ;
+    
+    for( auto& iter : this->sub_map )
+    {
+      for( auto& sub : iter.second.second )
+      {
+        auto mailbox = mailboxOf( sub.second ) ;
+        if( mailbox ) list->push_back( mailbox ) ;
+      }
+    }
+    
+    for( auto& iter : this->pattern_map )
+    {
+      for( auto& pattern : iter.second )
+      {
+        auto mailbox = mailboxOf( pattern.second->delegate ) ;
+        if( mailbox ) list->push_back( mailbox ) ;
+      }
+    }
+    
+    retire( this->mailboxes.exchange( list ) ) ;
+  }
+  
+  /** Function to find the time a share of the calls of a subscription finished under.
+   * @param stats The counters of the subscription.
+   * @param share The share of calls, from 0 to 1.
+   * @return The upper bound of the latency bucket the share falls in, in nanoseconds.
+   */
+  static unsigned long long percentile( const SubscriberStats& stats, double share )
+  {
+    unsigned long long seen = 0 ;
+    
+    for( unsigned bucket = 0; bucket < SubscriberStats::LATENCY_BUCKETS; bucket++ )
+    {
+      seen += stats.latency[ bucket ] ;
+      if( seen > 0 && seen >= share * stats.calls ) return 2ull << bucket ;
+    }
+    
+    return 0 ;
+  }
+  
+  BusStats::BusStats()
+  {
+    this->stats_data = new BusStatsData() ;
+  }
+  
+  BusStats::BusStats( const BusStats& stats )
+  {
+    this->stats_data = new BusStatsData( *stats.stats_data ) ;
+  }
+  
+  BusStats::~BusStats()
   {
-    this->signal_mutex.lock() ;
-    iter->second->reset () ;
-    delete iter->second ;
-    iter->second = nullptr ;
-    this->subscribers.erase( iter ) ;
-    this->signal_mutex.unlock() ;
+    delete this->stats_data ;
   }
   
-  void Signal::remove( Signal::PublisherIterator& iter )
+  void BusStats::operator=( const BusStats& stats )
   {
-    this->signal_mutex.lock() ;
-    this->publishers.erase( iter ) ;
-    this->signal_mutex.unlock() ;
+    *this->stats_data = *stats.stats_data ;
   }
   
-  const void* Signal::Publisher::execute( unsigned idx )
+  unsigned BusStats::topicCount() const
   {
-    return this->pub_ptr->publish( idx ) ;
+    return static_cast<unsigned>( data().topics.size() ) ;
   }
   
-  BusData& BusData::operator=( const BusData& bus )
+  const TopicStats& BusStats::topic( unsigned index ) const
   {
-    this->identifier = bus.identifier ;
-    this->pub_map    = bus.pub_map    ;
-    this->sub_map    = bus.sub_map    ;
-    
-    return *this ;
+    return data().topics[ index ] ;
   }
-
-  BusData::BusData()
+  
+  unsigned BusStats::subscriberCount() const
   {
-    this->identifier = 0 ;
+    return static_cast<unsigned>( data().subscribers.size() ) ;
   }
   
-  BusData::~BusData()
+  const SubscriberStats& BusStats::subscriber( unsigned index ) const
   {
-    map_lock.lock() ;
-    if( this->sub_map.size() != 0 )
-    {
-      for( auto& iter : this->sub_map )
-      {  
-        auto signal = signal_map.find( iter.first ) ;
-        for( auto& iter2 : iter.second.second )
-        {
-          delete iter2.second->second ;
-          signal->second->subscribers.erase( iter2.second ) ;
-        }
-      }
-    }
+    return data().subscribers[ index ] ;
+  }
+  
+  const char* BusStats::output() const
+  {
+    std::string& report = this->stats_data->report ;
+    char         line[ 256 ] ;
     
-//    if( this->required_sub_map.size() != 0 )
-//    {
-//      for( auto& iter : this->required_sub_map )
-//      {  
-//        auto signal = signal_map.find( iter.first ) ;
-//        for( auto& iter2 : iter.second.second )
-//        {
-//          delete iter2.second->second ;
-//          signal->second->subscribers.erase( iter2.second ) ;
-//        }
-//      }
-//    }
+    report = "Iris Bus metrics:\n" ;
     
-    if( this->pub_map.size() != 0 )
+    for( const auto& topic : data().topics )
     {
-      for( auto& iter : this->pub_map )
-      {  
-        auto signal = signal_map.find( iter.first ) ;
-        for( auto& iter2 : iter.second.second )
-        {
-          delete iter2.second->second ;
-          signal->second->publishers.erase( iter2.second ) ;
-        }
+      const TopicEntry* entry  = registry().find( topic.topic.value ) ;
+      const double      fanout = topic.emits ? static_cast<double>( topic.deliveries ) / topic.emits : 0.0 ;
+      
+      std::snprintf( line, sizeof( line ), "  %s: %llu emits, %.2f fan-out\n", entry ? entry->name.c_str() : "?", topic.emits, fanout ) ;
+      report += line ;
+      
+      for( const auto& sub : data().subscribers )
+      {
+        if( sub.topic.value != topic.topic.value ) continue ;
+        
+        std::snprintf( line, sizeof( line ), "    %p: %llu calls, p50 < %lluns, p99 < %lluns\n", sub.object ? sub.object : reinterpret_cast<const void*>( sub.function ), sub.calls, percentile( sub, 0.5 ), percentile( sub, 0.99 ) ) ;
+        report += line ;
       }
     }
     
-    this->pub_map         .clear() ;
-    this->sub_map         .clear() ;
-    this->required_sub_map.clear() ;
-    map_lock.unlock() ;
+    return report.c_str() ;
+  }
+  
+  BusStatsData& BusStats::data()
+  {
+    return *this->stats_data ;
+  }
+  
+  const BusStatsData& BusStats::data() const
+  {
+    return *this->stats_data ;
   }
   
   Bus& Bus::operator =( const Bus& bus )
@@ -409,210 +2923,516 @@ namespace iris
   
   void Bus::emit( unsigned idx )
   {
-    data().lock.lock() ;
-    for( auto pub : data().pub_map )
+    std::scoped_lock<std::recursive_mutex> lock( data().pull_lock )   ;
+    EpochGuard                             guard                      ;
+    const BusData::PullList*               list = data().pulls.load() ;
+    
+    if( list == nullptr ) return ;
+    
+    for( auto& pull : *list )
     {
-      for( auto& pair : pub.second.second )
-      {
-        auto map = pub.second ;
-        auto val = pair.second->second->execute( idx ) ;
-        
-        for( auto iter = pub.second.first->subscribers.lower_bound( this->UNIVERSAL_TYPE ); iter != pub.second.first->subscribers.upper_bound( this->UNIVERSAL_TYPE ); ++iter )
-        {
-          iter->second->subscriber().execute( val, idx ) ;
-          iter->second->signal() ;
-        }
-        
-        for( auto iter = pub.second.first->subscribers.lower_bound( pair.second->first ); iter != pub.second.first->subscribers.upper_bound( pair.second->first ); ++iter )
-        {
-          if( pair.second->first != this->UNIVERSAL_TYPE )
-          {
-            iter->second->subscriber().execute( val, idx ) ;
-            iter->second->signal() ;
-          }
-        }
-      }
+      route( pull, idx ) ;
     }
-    data().lock.unlock() ;
   }
   
-  void Bus::wait()
+  void Bus::pullBase( TopicId key, unsigned idx )
   {
-    data().lock.lock() ;
-    for( auto &signal : data().required_sub_map )
+    std::scoped_lock<std::recursive_mutex> lock( data().pull_lock )   ;
+    EpochGuard                             guard                      ;
+    const BusData::PullList*               list = data().pulls.load() ;
+    
+    if( list == nullptr ) return ;
+    
+    auto iter = std::lower_bound( list->begin(), list->end(), key.value, [] ( const BusData::Pull& pull, unsigned topic ) { return pull.topic < topic ; } ) ;
+    
+    for( ; iter != list->end() && iter->topic == key.value; ++iter )
     {
-      signal.second.first->signal_mutex.lock() ;
-      for( auto &sig : signal.second.second )
-      {
-        sig.second->second->wait() ;
-      }
-      signal.second.first->signal_mutex.unlock() ;
+      route( *iter, idx ) ;
     }
-    data().lock.unlock() ;
   }
   
-  void Bus::clearSubscriptions()
+  unsigned Bus::drain()
   {
-    map_lock.lock() ;
-    if( data().sub_map.size() != 0 )
+    EpochGuard                  guard                          ;
+    const BusData::MailboxList* list  = data().mailboxes.load() ;
+    unsigned                    count = 0                       ;
+    
+    if( list == nullptr ) return 0 ;
+    
+    for( auto mailbox : *list )
     {
-      for( auto& iter : data().sub_map )
-      {  
-        auto signal = signal_map.find( iter.first ) ;
-        for( auto& iter2 : iter.second.second )
-        {
-          delete iter2.second->second ;
-          signal->second->subscribers.erase( iter2.second ) ;
-        }
-      }
+      count += mailbox->drain() ;
     }
-
-    data().sub_map         .clear() ;
-    data().required_sub_map.clear() ;
-    map_lock.unlock() ;
+    
+    return count ;
   }
   
-  void Bus::reset()
+  BusStats Bus::stats()
   {
-    map_lock.lock() ;
-    if( data().sub_map.size() != 0 )
-    {
-      for( auto& iter : data().sub_map )
-      {  
-        auto signal = signal_map.find( iter.first ) ;
-        for( auto& iter2 : iter.second.second )
-        {
-          delete iter2.second->second ;
-          signal->second->subscribers.erase( iter2.second ) ;
-        }
-      }
-    }
+    BusStats stats ;
     
-    if( data().pub_map.size() != 0 )
+#ifdef IRIS_BUS_METRICS
+    std::map<unsigned, TopicStats>                            topics      ;
+    std::map<MetricsRecord::SubscriberKey, SubscriberStats> subscribers ;
+    
+    EpochGuard guard ;
+    
+    for( auto record = metrics().records.load(); record != nullptr; record = record->next )
     {
-      for( auto& iter : data().pub_map )
-      {  
-        auto signal = signal_map.find( iter.first ) ;
-        for( auto& iter2 : iter.second.second )
+      const TopicCounters*      topic_table = record->topics     .load( std::memory_order_acquire ) ;
+      const SubscriberCounters* sub_table   = record->subscribers.load( std::memory_order_acquire ) ;
+      
+      for( size_t id = 0; id < topic_table->size; id++ )
+      {
+        const TopicCounters::Entry& topic = topic_table->entries[ id ]                    ;
+        const unsigned long long    emits = topic.emits.load( std::memory_order_relaxed ) ;
+        
+        if( emits == 0 ) continue ;
+        
+        TopicStats& total = topics[ static_cast<unsigned>( id ) ] ;
+        total.topic.value = static_cast<unsigned>( id )                             ;
+        total.emits      += emits                                                   ;
+        total.deliveries += topic.deliveries.load( std::memory_order_relaxed ) ;
+      }
+      
+      for( size_t index = 0; index < sub_table->size; index++ )
+      {
+        const SubscriberCounters::Entry& sub = sub_table->entries[ index ] ;
+        
+        if( !sub.used.load( std::memory_order_acquire ) ) continue ;
+        
+        const MetricsRecord::SubscriberKey key( sub.topic, reinterpret_cast<std::uintptr_t>( sub.object ), reinterpret_cast<std::uintptr_t>( sub.trampoline ), reinterpret_cast<std::uintptr_t>( sub.function ) ) ;
+        
+        SubscriberStats& total = subscribers[ key ] ;
+        total.topic.value = sub.topic                                    ;
+        total.object      = sub.object                                   ;
+        total.function    = sub.function                                 ;
+        total.calls      += sub.calls.load( std::memory_order_relaxed ) ;
+        
+        for( unsigned bucket = 0; bucket < SubscriberStats::LATENCY_BUCKETS; bucket++ )
         {
-          delete iter2.second->second ;
-          signal->second->publishers.erase( iter2.second ) ;
+          total.latency[ bucket ] += sub.latency[ bucket ].load( std::memory_order_relaxed ) ;
         }
       }
     }
-
-    data().pub_map         .clear() ;
-    data().sub_map         .clear() ;
-    data().required_sub_map.clear() ;
-    map_lock.unlock() ;
+    
+    for( const auto& topic : topics      ) stats.data().topics     .push_back( topic.second ) ;
+    for( const auto& sub   : subscribers ) stats.data().subscribers.push_back( sub.second   ) ;
+#endif
+    
+    return stats ;
   }
-  void Bus::enrollBase( const Key& key, Publisher* publisher, unsigned type_id )
+  
+  void Bus::setStatsInterval( unsigned milliseconds )
+  {
+#ifdef IRIS_BUS_METRICS
+    metrics().last_dump.store( metricsTime() / 1000000 ) ;
+    metrics().interval .store( milliseconds             ) ;
+#else
+    static_cast<void>( milliseconds ) ;
+#endif
+  }
+  
+  /** Function to wait until every REQUIRED subscription of a bus has recieved data since the last wait, then start counting again.
+   * @param data The data of the bus.
+   * @param nanoseconds The most time to wait, or a negative amount to wait however long it takes.
+   * @return Whether or not every subscription's data arrived.
+   */
+  static bool awaitArrivals( BusData& data, long long nanoseconds )
   {
-    Signal::PublisherIterator pub_iter ;
+    Arrivals&       arrivals = *data.arrivals                 ;
+    const long long end      = monotonicTime() + nanoseconds ;
+    unsigned        consumed = 0                              ;
     
-    data().lock.lock() ;
-    map_lock.lock() ;
+    while( true )
+    {
+      const std::uint32_t pending = arrivals.pending.load() ;
+      const long long     left    = end - monotonicTime()   ;
+      
+      if( static_cast<std::int32_t>( pending ) <= 0 ) break ;
+      if( nanoseconds >= 0 && left <= 0             ) return false ;
+      
+      // Announced before checking again, so an emitter either sees the waiter or this sees it's data.
+      arrivals.waiters.fetch_add( 1 ) ;
+      if( arrivals.pending.load() == pending ) futexWait( &arrivals.pending, pending, nanoseconds >= 0 ? left : -1 ) ;
+      arrivals.waiters.fetch_sub( 1 ) ;
+    }
     
-    auto iter = signal_map.find( key.str() )      ;
-    auto iter2 = data().pub_map.find( key.str() ) ;
-
+    std::scoped_lock<std::mutex> lock( data.lock ) ;
     
-    if( iter2 != data().pub_map.end() )
+    for( auto& iter : data.required_sub_map )
     {
-      auto type_iter = iter2->second.second.find( type_id ) ;
-      if( type_iter != iter2->second.second.end() )
+      for( auto& sub : iter.second.second )
       {
-        iter->second->remove( type_iter->second ) ;
-        data().pub_map.erase( key.str() ) ;
+        RequiredInput* input = requiredOf( sub.second ) ;
+        if( input && input->fresh.exchange( false ) ) consumed++ ;
       }
     }
-    else
+    
+    for( auto& iter : data.pattern_map )
     {
-      data().pub_map[ key.str() ] ;
+      for( auto& pattern : iter.second )
+      {
+        RequiredInput* input = requiredOf( pattern.second->delegate ) ;
+        if( input && input->fresh.exchange( false ) ) consumed++ ;
+      }
     }
-
-    if( iter == signal_map.end() )
+    
+    arrivals.pending.fetch_add( consumed ) ;
+    return true ;
+  }
+  
+  void Bus::wait()
+  {
+    awaitArrivals( data(), -1 ) ;
+  }
+  
+  bool Bus::wait( unsigned milliseconds )
+  {
+    return awaitArrivals( data(), static_cast<long long>( milliseconds ) * 1000000 ) ;
+  }
+  
+  void Bus::setExecutor( Executor* executor )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    data().executor = executor ;
+  }
+  
+  Executor* Bus::executor()
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    return data().executor ;
+  }
+  
+  Bus::Rate Bus::rateOf( TopicId key )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    auto                         iter = data().limits.find( key.value ) ;
+    
+    return iter != data().limits.end() ? iter->second : Rate{ Limit::None, 0 } ;
+  }
+  
+  void Bus::reportUnqueued( TopicId key )
+  {
+    std::cout << "Iris Bus: Data of topic '" << topicName( key ) << "' can not be default constructed and copy assigned, so it's subscription is called synchronously and without a limit." << std::endl ;
+  }
+  
+  void Bus::limitBase( TopicId key, const Rate& rate )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    
+    if( rate.limit == Limit::None ) data().limits.erase( key.value ) ;
+    else                            data().limits[ key.value ] = rate ;
+  }
+  
+  Bus::Mailbox* Bus::findStream( TopicId key, unsigned type_id )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    auto                         iter    = data().sub_map.find( key.value ) ;
+    Mailbox*                     mailbox = nullptr                          ;
+    
+    if( iter == data().sub_map.end() ) return nullptr ;
+    
+    auto type_iter = iter->second.second.find( type_id ) ;
+    if( type_iter == iter->second.second.end() ) return nullptr ;
+    
+    mailbox = mailboxOf( type_iter->second ) ;
+    
+    // Added under the lock, so the subscription can not be replaced and release it first.
+    if( mailbox && mailbox->awaited )
     {
-      iter = signal_map.insert( { std::string( key.str() ), new Signal() } ) ;
-      
-      pub_iter = iter->second->insert( type_id, publisher ) ;
+      mailbox->acquire() ;
+      return mailbox ;
     }
-    else
+    
+    std::cout << "Iris Bus: Replacing the subscription to '" << topicName( key ) << "' with a stream, as a bus holds one subscription per topic & type." << std::endl ;
+    return nullptr ;
+  }
+  
+  void Bus::clearSubscriptions()
+  {
+    data().lock.lock() ;
+    data().releaseSubscribers() ;
+    data().lock.unlock() ;
+  }
+  
+  void Bus::reset()
+  {
+    data().lock.lock() ;
+    data().releaseSubscribers() ;
+    data().releasePublishers () ;
+    data().lock.unlock() ;
+  }
+  
+  void Bus::enrollBase( TopicId key, Publisher* publisher, unsigned type_id )
+  {
+    Signal::PublisherIterator pub_iter                   ;
+    Signal::Publisher*        replaced = nullptr         ;
+    Signal*                   signal   = signalOf( key ) ;
+    
+    if( signal == nullptr )
+    {
+      delete publisher ;
+      return ;
+    }
+    
+    data().lock.lock() ;
+    
+    auto iter = data().pub_map.find( key.value ) ;
+    
+    if( iter != data().pub_map.end() )
     {
-      pub_iter = iter->second->insert( type_id, publisher ) ;
+      auto type_iter = iter->second.second.find( type_id ) ;
+      if( type_iter != iter->second.second.end() )
+      {
+        replaced = type_iter->second->second ;
+        signal->remove( type_iter->second ) ;
+        iter->second.second.erase( type_iter ) ;
+      }
     }
     
+    pub_iter = signal->insert( type_id, publisher ) ;
     
-    data().pub_map[ key.str() ].first = iter->second                   ;
-    data().pub_map[ key.str() ].second.insert( { type_id, pub_iter } ) ;
+    data().pub_map[ key.value ].first = signal                         ;
+    data().pub_map[ key.value ].second.insert( { type_id, pub_iter } ) ;
+    data().refreshPulls() ;
+    retire( replaced ) ;
 
-    map_lock.unlock() ;
     data().lock.unlock() ;
   }
   
-  void Bus::enrollBase( const Key& key, Subscriber* subscriber, Requirement required, unsigned type_id )
+  void Bus::enrollBase( TopicId key, const Delegate& subscription, Requirement required, unsigned type_id )
   {
-    Signal::SubscriberIterator sub_iter ;
+    Signal*  signal  = signalOf( key )           ;
+    Mailbox* mailbox = mailboxOf( subscription ) ;
+    Delegate sub     = subscription              ;
+    
+    if( signal == nullptr )
+    {
+      if( mailbox ) mailbox->release() ;
+      return ;
+    }
+    
+    if( mailbox ) mailbox->bind( signal->queue ) ;
+    
+    if( ( required & iris::REQUIRED ) == iris::REQUIRED )
+    {
+      RequiredInput* input = new RequiredInput() ;
+      
+      input->delegate = subscription    ;
+      input->arrivals = data().arrivals ;
+      input->fresh    = false           ;
+      
+      // Clears the whole callable, as delegates are compared byte for byte on removal.
+      sub.callable        = {}                                                ;
+      sub.object          = static_cast<void*>( input )                       ;
+      sub.trampoline      = &callRequired                                     ;
+      sub.batch           = subscription.batch ? &callRequiredBatch : nullptr ;
+      sub.sink            = subscription.sink  ? &sinkRequired      : nullptr ;
+      
+      data().arrivals->add( 1 ) ;
+    }
+    
+    // Wrapped first, so a REQUIRED pattern is waited on until data arrives from any topic it matches.
+    if( std::strchr( topicName( key ), '*' ) )
+    {
+      this->enrollPattern( key, sub, type_id ) ;
+      return ;
+    }
     
     data().lock.lock() ;
-    map_lock.lock() ;
     
-    auto iter  = signal_map.find( key.str() )     ;
-    auto iter2 = data().sub_map.find( key.str() ) ;
+    auto iter = data().sub_map.find( key.value ) ;
     
-    if( iter2 != data().sub_map.end() )
+    if( iter != data().sub_map.end() )
     {
-      auto type_iter = iter2->second.second.find( type_id ) ;
+      auto type_iter = iter->second.second.find( type_id ) ;
 
-      if( type_iter != iter2->second.second.end() )
+      if( type_iter != iter->second.second.end() )
       {
-        iter->second->remove( type_iter->second ) ;
-        data().sub_map.erase( iter2 ) ;
-        if( data().required_sub_map.find( key.str() ) != data().required_sub_map.end() )
+        const Delegate replaced = type_iter->second ;
+        
+        iter->second.second.erase( type_iter ) ;
+        
+        auto required_iter = data().required_sub_map.find( key.value ) ;
+        if( required_iter != data().required_sub_map.end() )
         {
-          data().required_sub_map.erase( key.str() ) ;
+          required_iter->second.second.erase( type_id ) ;
         }
+        
+        if( mailboxOf( replaced ) ) data().refreshMailboxes() ;
+        data().releaseAdapters( key.value, type_id ) ;
+        signal->remove( type_id, replaced ) ;
       }
     }
 
-    if( iter == signal_map.end() )
+    signal->insert( type_id, sub ) ;
+    
+    const BusData::AdapterList adapted = data().adapt( signal, key.value, type_id, sub ) ;
+    
+    data().sub_map[ key.value ].first = signal                    ;
+    data().sub_map[ key.value ].second.insert( { type_id, sub } ) ;
+    
+    if( mailbox ) data().refreshMailboxes() ;
+    
+    if( ( required & iris::REQUIRED ) == iris::REQUIRED )
     {
-      iter = signal_map.insert( { std::string( key.str() ), new Signal() } ) ;
-      
-      sub_iter = iter->second->insert( type_id, subscriber ) ;
+      data().required_sub_map[ key.value ].first = signal                    ;
+      data().required_sub_map[ key.value ].second.insert( { type_id, sub } ) ;
     }
-    else
+
+    data().lock.unlock() ;
+    
+    deliverRetained( signal, type_id, sub ) ;
+    
+    for( const auto& adapter : adapted )
     {
-      sub_iter = iter->second->insert( type_id, subscriber ) ;
+      deliverRetained( signal, adapter.from, adapter.delegate ) ;
     }
+  }
+  
+  void Bus::enrollPattern( TopicId key, const Delegate& sub, unsigned type_id )
+  {
+    Pattern*             pattern = new Pattern() ;
+    std::vector<Signal*> matched                 ;
+    
+    pattern->text     = topicName( key ) ;
+    pattern->type_id  = type_id          ;
+    pattern->delegate = sub              ;
     
-    data().sub_map[ key.str() ].first = iter->second                   ;
-    data().sub_map[ key.str() ].second.insert( { type_id, sub_iter } ) ;
+    data().lock.lock() ;
+    
+    auto& types = data().pattern_map[ key.value ] ;
+    auto  iter  = types.find( type_id )           ;
     
-    if( required == iris::REQUIRED )
+    if( iter != types.end() )
     {
-      data().required_sub_map[ key.str() ].first = iter->second                   ;
-      data().required_sub_map[ key.str() ].second.insert( { type_id, sub_iter } ) ;
+      Pattern* replaced = iter->second ;
+      
+      types.erase( iter ) ;
+      if( mailboxOf( replaced->delegate ) ) data().refreshMailboxes() ;
+      BusData::releasePattern( replaced ) ;
     }
-
-    map_lock.unlock() ;
+    
+    types.insert( { type_id, pattern } ) ;
+    matched = patterns().add( pattern ) ;
+    
+    if( mailboxOf( sub ) ) data().refreshMailboxes() ;
+    
     data().lock.unlock() ;
+    
+    for( auto signal : matched )
+    {
+      deliverRetained( signal, type_id, sub ) ;
+    }
   }
   
-  void Bus::emitBase( const Key& key, const void* value, unsigned type_id, unsigned idx )
+  void Bus::emitBase( TopicId key, const void* value, unsigned type_id, unsigned idx, const Retainer& retainer )
   {
-    auto iter = signal_map.find( key.str() ) ;
+    Signal*     signal = signalOf( key ) ;
+    SignalSlot* slot   = nullptr         ;
     
-    data().lock.lock() ;
-    if( iter != signal_map.end() )
+    if( signal == nullptr ) return ;
+    
+    // Retained topics need a slot to keep the data in, even with nobody subscribed yet.
+    slot = signal->slot( type_id, signal->retained.load( std::memory_order_relaxed ) ) ;
+    
+    if( slot ) Bus::emitBase( slot, value, idx, retainer ) ;
+  }
+  
+  void Bus::emitBase( SignalSlot* slot, const void* value, unsigned idx, const Retainer& retainer )
+  {
+    if( slot->signal->retained.load( std::memory_order_relaxed ) )
     {
-      for( auto sub = iter->second->subscribers.lower_bound( type_id ); sub != iter->second->subscribers.upper_bound( type_id ); ++sub )
-      {
-        sub->second->subscriber().execute( value, idx ) ;
-        sub->second->signal() ;
-      }
+      std::scoped_lock<std::recursive_mutex> lock( slot->order ) ;
+      
+      Bus::retain( slot, value, 0, 1, idx, retainer ) ;
+      dispatch( slot, value, idx ) ;
+      return ;
     }
-    data().lock.unlock() ;
+    
+    dispatch( slot, value, idx ) ;
+  }
+  
+  void Bus::emitMovedBase( TopicId key, void* value, unsigned type_id, unsigned idx, const Retainer& retainer )
+  {
+    Signal*     signal = signalOf( key ) ;
+    SignalSlot* slot   = nullptr         ;
+    
+    if( signal == nullptr ) return ;
+    
+    slot = signal->slot( type_id, signal->retained.load( std::memory_order_relaxed ) ) ;
+    
+    if( slot ) Bus::emitMovedBase( slot, value, idx, retainer ) ;
+  }
+  
+  void Bus::emitMovedBase( SignalSlot* slot, void* value, unsigned idx, const Retainer& retainer )
+  {
+    if( slot->signal->retained.load( std::memory_order_relaxed ) )
+    {
+      std::scoped_lock<std::recursive_mutex> lock( slot->order ) ;
+      
+      // Kept before anyone can move the data away.
+      Bus::retain( slot, value, 0, 1, idx, retainer ) ;
+      dispatchMoved( slot, value, idx ) ;
+      return ;
+    }
+    
+    dispatchMoved( slot, value, idx ) ;
+  }
+  
+  void Bus::emitBatchBase( TopicId key, const void* values, unsigned stride, unsigned count, unsigned type_id, unsigned first, const Retainer& retainer )
+  {
+    Signal*     signal = signalOf( key ) ;
+    SignalSlot* slot   = nullptr         ;
+    
+    if( signal == nullptr ) return ;
+    
+    slot = signal->slot( type_id, signal->retained.load( std::memory_order_relaxed ) ) ;
+    
+    if( slot ) Bus::emitBatchBase( slot, values, stride, count, first, retainer ) ;
+  }
+  
+  void Bus::emitBatchBase( SignalSlot* slot, const void* values, unsigned stride, unsigned count, unsigned first, const Retainer& retainer )
+  {
+    if( slot->signal->retained.load( std::memory_order_relaxed ) )
+    {
+      std::scoped_lock<std::recursive_mutex> lock( slot->order ) ;
+      
+      Bus::retain( slot, values, stride, count, first, retainer ) ;
+      dispatchBatch( slot, values, stride, count, first ) ;
+      return ;
+    }
+    
+    dispatchBatch( slot, values, stride, count, first ) ;
+  }
+  
+  void Bus::retain( SignalSlot* slot, const void* values, unsigned stride, unsigned count, unsigned first, const Retainer& retainer )
+  {
+    if( retainer.copy == nullptr ) return ;
+    
+    Retained* last = new Retained() ;
+    
+    last->values  = retainer.copy( values, count ) ;
+    last->stride  = stride                         ;
+    last->count   = count                          ;
+    last->first   = first                          ;
+    last->release = retainer.release               ;
+    
+    // Readers may still be handing the old data to a new subscriber, so it is released once they are done.
+    retire( slot->last.exchange( last ) ) ;
+  }
+  
+  void Bus::callBatch( const Delegate& delegate, const void* pointer, unsigned idx )
+  {
+    delegate.batch( delegate, pointer, 1, idx ) ;
+  }
+  
+  SignalSlot* Bus::resolve( TopicId key, unsigned type_id )
+  {
+    Signal* signal = signalOf( key ) ;
+    
+    return signal ? signal->slot( type_id, true ) : nullptr ;
   }
   
   unsigned Bus::id()
@@ -624,4 +3444,4 @@ namespace iris
   {
     data().identifier = id ;
   }
-}
\ No newline at end of file
+}
@@ -17,11 +17,18 @@
 
 #pragma once
 
+#include "Executor.h"
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
 namespace iris
 {
   using Requirement = unsigned ;
-  static constexpr Requirement REQUIRED = 0x01010101 ;
+  static constexpr Requirement REQUIRED = 0x01010101 ; ///< Counts the subscription's data toward Bus::wait.
   static constexpr Requirement OPTIONAL = 0x02020202 ;
+  static constexpr Requirement ASYNC    = 0x04040404 ; ///< Combine with the others to queue data and deliver it on the subscriber's thread through Bus::drain.
   
   /** Container for compile-time type info.
    */
@@ -32,6 +39,123 @@ namespace iris
     const char* ctti_name   ;
   };
 
+  /** Policies for what an ASYNC subscription does with new data once it's queue is full.
+   */
+  enum class Overflow
+  {
+    Block,      ///< Wait for the subscriber to drain. Never drain on the emitting thread with this.
+    DropOldest, ///< Throw away the oldest queued data to make room.
+    DropNewest, ///< Throw away the new data.
+    Coalesce,   ///< Replace everything queued with the new data, so subscribers only see the latest.
+  };
+  
+  /** Policies for how often a subscription is called, no matter how often data is emitted to it. See Bus::limit.
+   */
+  enum class Limit
+  {
+    None,     ///< Call the subscription with all data.
+    Throttle, ///< Call it at most once per period, with the first data of the period. The rest is dropped.
+    Latest,   ///< Call it at most once per period, with the latest data. Data left over at the end of a period is held, and delivered once the period ends.
+    Debounce, ///< Call it only once data stops arriving for a whole period, with the last data.
+  };
+  
+  /** Counters of the data a topic's ASYNC subscriptions have shed.
+   */
+  struct QueueStats
+  {
+    unsigned long long dropped   ; ///< The amount of data thrown away because a queue was full.
+    unsigned long long coalesced ; ///< The amount of queued data replaced by newer data.
+  };
+  
+  /** Compact handle to a topic string that has been interned by the Bus.
+   * @note Ids are process-wide and stable for the lifetime of the program. Zero is never a valid topic.
+   */
+  struct TopicId
+  {
+    unsigned value ;
+  };
+
+  /** Counters of a single topic, as recorded by a bus built with IRIS_BUS_METRICS.
+   */
+  struct TopicStats
+  {
+    TopicId            topic      ; ///< The topic.
+    unsigned long long emits      ; ///< The amount of data emitted over the topic.
+    unsigned long long deliveries ; ///< The amount of subscriber calls made for the data. Divided by @emits, this is the fan-out.
+  };
+  
+  /** Counters of a single subscription, as recorded by a bus built with IRIS_BUS_METRICS.
+   */
+  struct SubscriberStats
+  {
+    static constexpr unsigned LATENCY_BUCKETS = 32 ;
+    
+    TopicId            topic                       ; ///< The topic subscribed to.
+    const void*        object                      ; ///< The object called, or the mailbox for ASYNC subscriptions. nullptr for functions.
+    void             (*function )()                ; ///< The function called, or nullptr if @object is set.
+    unsigned long long calls                       ; ///< The amount of times the subscription was called.
+    unsigned long long latency[ LATENCY_BUCKETS ] ; ///< Log-scale histogram of call times. Bucket N counts calls that took under 2^(N+1) nanoseconds.
+  };
+  
+  /** Class to contain a snapshot of the metrics of every topic, merged from every thread that emitted.
+   * @note Always empty unless the bus was built with IRIS_BUS_METRICS. Without it, recording costs nothing.
+   */
+  class BusStats
+  {
+    public:
+      /** Default constructor. Makes an empty snapshot.
+       */
+      BusStats() ;
+      
+      /** Copy constructor. Copies input snapshot.
+       * @param stats The snapshot to copy.
+       */
+      BusStats( const BusStats& stats ) ;
+      
+      /** Deconstructor.
+       */
+      ~BusStats() ;
+      
+      /** Equals operator. Assigns this object's snapshot to the input's.
+       * @param stats The snapshot to copy.
+       */
+      void operator=( const BusStats& stats ) ;
+      
+      /** Method to retrieve the amount of topics in this snapshot.
+       * @return The amount of topics.
+       */
+      unsigned topicCount() const ;
+      
+      /** Method to retrieve the counters of a topic in this snapshot.
+       * @param index The index of the topic, below topicCount().
+       * @return The counters of the topic.
+       */
+      const TopicStats& topic( unsigned index ) const ;
+      
+      /** Method to retrieve the amount of subscriptions in this snapshot.
+       * @return The amount of subscriptions.
+       */
+      unsigned subscriberCount() const ;
+      
+      /** Method to retrieve the counters of a subscription in this snapshot.
+       * @param index The index of the subscription, below subscriberCount().
+       * @return The counters of the subscription.
+       */
+      const SubscriberStats& subscriber( unsigned index ) const ;
+      
+      /** Method to retrieve a human readable report of this snapshot.
+       * @return The C-string report.
+       */
+      const char* output() const ;
+      
+    private:
+      friend class Bus ;
+      
+      struct BusStatsData* stats_data ;
+      BusStatsData& data() ;
+      const BusStatsData& data() const ;
+  };
+  
   /** Wrapper class for generating a key using variadic templates.
    */
   class Key
@@ -65,17 +189,38 @@ namespace iris
        */
       const char* str() const ;
       
+      /** Method to append a C-string to the end of this object's internal string.
+       * @param str The C-string to append.
+       */
+      void append( const char* str ) ;
+      
+      /** Method to clear this object's internal string without releasing it's storage.
+       */
+      void clear() ;
+      
     private:
       struct KeyData* key_data ;
       KeyData& data() ;
       const KeyData& data() const ;
   };
 
+  /** Function to build the type info of the input template type from the compiler's signature of this function.
+   * @note Only meant to initialize iris::type_info, so it is evaluated once per type at compile time.
+   * @return The type info.
+   */
+  template<typename Type>
+  constexpr TypeInfo buildTypeinfo() ;
+  
+  /** Compile-time type info of the input template type.
+   */
+  template<typename Type>
+  inline constexpr TypeInfo type_info = buildTypeinfo<Type>() ;
+  
   /** Function to retrieve a compile-time type info object for the input template type.
    * @return Compile-time type information object reference.
    */
   template<typename Type>
-  const TypeInfo& typeinfo() ;
+  constexpr const TypeInfo& typeinfo() ;
   
   /** Operator overloads for converting data types into a Key. 
    * Custom overloads can be made if you wish for easier key generations.
@@ -84,6 +229,41 @@ namespace iris
   void operator<<( Key& first, unsigned second ) ;
   void operator<<( Key& first, float second ) ;
   void operator<<( Key& first, const Key& second ) ;
+  void operator<<( Key& first, TopicId second ) ;
+  
+  /** Function to intern a key into the global topic table.
+   * @param key The key to intern.
+   * @return The compact id of the topic. The same string always produces the same id.
+   */
+  TopicId intern( const Key& key ) ;
+  
+  /** Pass-through overload so that pre-interned ids can be used anywhere a key is expected.
+   * @param topic The already interned topic.
+   * @return The input topic.
+   */
+  TopicId intern( TopicId topic ) ;
+  
+  /** Function to intern a key made of the input arguments.
+   * @note The key is built in a per-thread buffer, so interning an existing topic does not allocate.
+   * @param args The arguments that make up the name of the topic.
+   * @return The compact id of the topic.
+   */
+  template<typename ... Keys>
+  TopicId intern( Keys... args ) ;
+  
+  /** Function to retrieve the string an interned topic was made from.
+   * @param topic The topic to look up.
+   * @return The C-string name of the topic, or an empty string if the topic is unknown.
+   */
+  const char* topicName( TopicId topic ) ;
+  
+  /** Function to intern a topic string whose length and hash are already known.
+   * @param str The topic string. Does not need to be null-terminated.
+   * @param length The length of the topic string.
+   * @param hash The hash of the topic string, as made by iris::hash.
+   * @return The compact id of the topic.
+   */
+  TopicId intern( const char* str, unsigned length, unsigned hash ) ;
   
   /** Compile-time function to generate a unsigned integer hash from input parameters.
    * @param str The string to hash.
@@ -100,8 +280,95 @@ namespace iris
    * @return The starting index of the substring in the parent string. 
    */
   constexpr unsigned find( const char* str, const char* substr ) ;
+  
+  /** Compile-time function to find the length of a null-terminated string.
+   * @param str The string to measure.
+   * @return The amount of characters before the terminator.
+   */
+  constexpr unsigned length( const char* str ) ;
 
+  /** Compile-time key for a fixed topic name.
+   * The name is hashed by the compiler and interned once per program, so emitting with it does no string work at all.
+   * 
+   *   E.g.  static constexpr char FRAME[] = "camera::frame" ;
+   *         bus.emit( image, iris::StaticTopic<FRAME>() ) ;
+   * 
+   * @note C++17 can not take a string literal as a template argument, so the name must be a named array with static storage.
+   */
+  template<const char* Name>
+  struct StaticTopic
+  {
+    static constexpr unsigned length = ::iris::length( Name )                          ; ///< The length of the name.
+    static constexpr unsigned hash   = ::iris::hash( Name, 0, ::iris::length( Name ) ) ; ///< The hash of the name.
+    
+    /** Static method to retrieve the id of this topic, interning it on first use.
+     * @return The compact id of the topic.
+     */
+    static TopicId id() ;
+  };
+  
+  /** Function to intern a compile-time key.
+   * @param topic The key.
+   * @return The compact id of the topic.
+   */
+  template<const char* Name>
+  TopicId intern( StaticTopic<Name> topic ) ;
+  
+  /** Operator to append a compile-time key to a key, for building topics out of several parts.
+   * @param first The key to append to.
+   * @param second The compile-time key to append.
+   */
+  template<const char* Name>
+  void operator<<( Key& first, StaticTopic<Name> second ) ;
+  
+  /** Function to set how ASYNC subscriptions of a topic queue their data.
+   * @note The depth applies to subscriptions enrolled afterwards. The policy applies immediately.
+   * @param topic The topic to configure.
+   * @param depth The amount of data each subscription can hold. Rounded up to a power of two, minimum of two.
+   * @param policy What to do with new data when a subscription's queue is full.
+   */
+  void setQueue( TopicId topic, unsigned depth, Overflow policy ) ;
+  
+  /** Function to retrieve how much data the ASYNC subscriptions of a topic have shed.
+   * @param topic The topic to look up.
+   * @return The counters of the topic.
+   */
+  QueueStats queueStats( TopicId topic ) ;
+  
+  /** Function to set whether or not a topic keeps the last data emitted over it, per type of data.
+   * Kept data is handed to every subscription enrolled afterwards as soon as it enrolls, so late subscribers do not need a re-emit.
+   * @note Retaining copies every manual emit of the topic, and emits of it are sent one at a time, so it is meant for slow changing data like configuration.
+   *       Only the latest emit is kept, so arrays should be sent with Bus::emitBatch.
+   *       Topics are shared by the whole process, so every call that turns retention on must be matched by one that turns it off.
+   *       The topic drops what it kept once the last of them does.
+   *       Types that can not be copy constructed are never kept, as there is no way to copy them.
+   * @param topic The topic to configure.
+   * @param retained Whether or not the topic keeps it's last data.
+   */
+  void setRetained( TopicId topic, bool retained ) ;
+  
+  /** Function to release an object once every emit that was already in flight has finished, without waiting for them.
+   * Meant for objects that subscriptions point at, so they can be freed right after the subscriptions are dropped while other threads may still be emitting to them.
+   * @param pointer The object to release.
+   * @param release The function to release the object with. May run on any thread that later retires something.
+   */
+  void retireObject( void* pointer, void (*release)( void* ) ) ;
+  
+  /** Function to list the types of data a topic currently has subscribers for, so publishers only convert data to the types that are wanted.
+   * @param topic The topic to look up.
+   * @param type_ids Filled with the ids of up to @count types, as made by iris::typeinfo.
+   * @param count The amount of ids @type_ids can hold.
+   * @return The amount of types with subscribers. May be more than @count. Subscribers that take any type aren't counted.
+   */
+  unsigned subscribedTypes( TopicId topic, unsigned* type_ids, unsigned count ) ;
+  
   /** Class to handle data transfer between modules.
+   * Subscriptions may use '*' in their key to match any run of characters. They recieve data from every matching topic, including ones made later.
+   * Topics are matched when they are made, so wildcard subscriptions cost nothing extra to emit to.
+   * 
+   *       E.g.  bus.enroll( &onParameter, iris::OPTIONAL, "camera_0::*"       ) ;
+   *             bus.enroll( &onStop     , iris::OPTIONAL, "iris_graph_*_stop" ) ;
+   * 
    * @note This object hashes the type information, which can have collisions.
    * 
    *       E.g.  bus[ "output" ].attach<unsigned>     ( &getterFunction  ) ;
@@ -150,52 +417,684 @@ namespace iris
           virtual void execute( const void* pointer, unsigned idx = 0 ) = 0 ;
       };
       
-      /** Default constructor. Initializes this object's data.
-       * @param id The channel to associate with this event bus.
-       */
-      Bus( unsigned id = 0 ) ;
-      
-      /**
-       * @param bus
+      /** Compact, type-erased subscription. Stored by value in contiguous per-topic arrays, so delivering never allocates or chases a heap pointer.
        */
-      Bus( const Bus& bus ) ;
+      struct Delegate
+      {
+        using Trampoline = void (*)( const Delegate& delegate, const void* pointer, unsigned idx ) ;
+        using Batch      = void (*)( const Delegate& delegate, const void* values, unsigned count, unsigned first ) ;
+        using Sink       = void (*)( const Delegate& delegate, void* pointer, unsigned idx ) ;
+        
+        /** Inline storage for the callback, large enough for a function or a member function pointer of any class.
+         * Callbacks are kept as their bytes and only ever read back as their own type, as member function pointers differ in size between compilers and kinds of class.
+         */
+        struct Callable
+        {
+          alignas( void* ) unsigned char bytes[ 4 * sizeof( void* ) ] ; ///< The bytes of the callback, followed by zeroes.
+          
+          /** Method to store a callback, clearing the bytes it does not use.
+           * @param callback The callback to store.
+           */
+          template<class Callback>
+          void store( Callback callback ) ;
+          
+          /** Method to read back the callback stored.
+           * @return The callback, which must be of the type it was stored as.
+           */
+          template<class Callback>
+          Callback load() const ;
+        };
+        
+        void*      object     ; ///< The object to call the callback on, if any.
+        Trampoline trampoline ; ///< The function that restores the callback's type and calls it.
+        Callable   callable   ; ///< The callback.
+        Batch      batch      ; ///< The function that hands a whole batch to the callback at once, or nullptr if it takes one value at a time.
+        Sink       sink       ; ///< The function that moves data into the callback, or nullptr if it only reads data. Used for the last subscriber of a moved emit.
+      };
       
-      /**
-       * @param bus
-       * @return 
+      /** Class for subscriptions that queue their data to be delivered later, on whichever thread drains them.
+       * @note Emitting into a mailbox is lock-free unless it's topic uses Overflow::Block. See iris::setQueue.
        */
-      Bus& operator=( const Bus& bus ) ;
+      class Mailbox : public Subscriber
+      {
+        public:
+          /** Default constructor. The mailbox holds nothing until bound to a topic.
+           */
+          Mailbox() ;
+          
+          /** Virtual deconstructor.
+           */
+          virtual ~Mailbox() ;
+          
+          /** Method to queue a copy of data for later delivery.
+           * @param pointer Pointer to the data to queue.
+           * @param idx The index to use for the subscription.
+           */
+          void execute( const void* pointer, unsigned idx = 0 ) ;
+          
+          /** Method to deliver all queued data to the subscription, on the calling thread.
+           * @return The amount of data delivered.
+           */
+          virtual unsigned drain() ;
+          
+          /** Method to size this mailbox to a topic's queue settings, and count what it sheds against that topic.
+           * @note Called by the bus when enrolling, before any data can reach this mailbox.
+           * @param config The queue settings of the topic.
+           */
+          virtual void bind( struct QueueConfig& config ) ;
+          
+          /** Method to stop accepting data, releasing any emitter blocked on this mailbox being full.
+           * @note Called by the bus when the subscription is removed.
+           */
+          virtual void close() ;
+          
+          /** Static trampoline to queue data into the mailbox a delegate refers to.
+           * @param delegate The delegate of the mailbox.
+           * @param pointer Pointer to the data to queue.
+           * @param idx The index to use for the subscription.
+           */
+          static void call( const Delegate& delegate, const void* pointer, unsigned idx ) ;
+          
+          /** Static trampoline to move data into the mailbox a delegate refers to, instead of copying it.
+           * @param delegate The delegate of the mailbox.
+           * @param pointer Pointer to the data to move.
+           * @param idx The index to use for the subscription.
+           */
+          static void sink( const Delegate& delegate, void* pointer, unsigned idx ) ;
+          
+          /** Method to deliver only the oldest queued data, for mailboxes that are taken from one value at a time instead of drained.
+           * @param wait Whether or not to wait out data an emitter is still copying in.
+           * @return Whether or not data was delivered.
+           */
+          bool take( bool wait ) ;
+          
+          /** Method to have a suspended coroutine resumed the next time data is queued.
+           * @param executor The executor to resume the coroutine on, or nullptr to resume it on the emitting thread.
+           * @param resume The function to resume the coroutine with.
+           * @param address The address of the coroutine.
+           * @return Whether or not the coroutine should stay suspended. False if data was queued in the meantime, in which case it is not resumed.
+           */
+          bool await( Executor* executor, Executor::Task resume, void* address ) ;
+          
+          /** Method to add a reference to this mailbox, for handles that may outlive it's subscription. See Bus::Stream.
+           */
+          void acquire() ;
+          
+          /** Method to drop a reference to this mailbox, releasing it once the last one is dropped. The subscription holds the first.
+           */
+          void release() ;
+          
+        protected:
+          bool awaited ; ///< Whether or not this mailbox is taken from by a coroutine. Bus::drain leaves these alone.
+          
+          /** Method to make room for the data of every cell of this mailbox.
+           * @param cells The amount of cells in this mailbox.
+           */
+          virtual void allocate( unsigned cells ) = 0 ;
+          
+          /** Method to copy data into a cell of this mailbox.
+           * @param cell The cell to copy into.
+           * @param pointer Pointer to the data to copy.
+           */
+          virtual void store( unsigned cell, const void* pointer ) = 0 ;
+          
+          /** Method to move data into a cell of this mailbox. Copies it unless overridden.
+           * @param cell The cell to move into.
+           * @param pointer Pointer to the data to move.
+           */
+          virtual void move( unsigned cell, void* pointer ) ;
+          
+          /** Method to deliver the data of a cell of this mailbox.
+           * @param cell The cell to deliver.
+           * @param idx The index to use for the subscription.
+           */
+          virtual void deliver( unsigned cell, unsigned idx ) = 0 ;
+        
+        private:
+          friend class Bus ;
+          
+          struct MailboxData*   mailbox_data ;
+          std::atomic<unsigned> references   ;
+          
+          /** Method to queue data, copying or moving it in.
+           * @param pointer Pointer to the data to queue.
+           * @param idx The index to use for the subscription.
+           * @param moved Whether or not the data may be moved from.
+           */
+          void push( const void* pointer, unsigned idx, bool moved ) ;
+      };
       
-      /** Deconstructor. Releases this object's data.
+      /** Class for subscriptions that are called at most as often as their topic's limit allows. See Bus::limit.
+       * Data is let through or held as it is emitted, by the emitter's monotonic clock. Held data is delivered by the next emit past it's time, or by draining.
+       * @note Wraps the subscription's mailbox for ASYNC subscriptions, so data that is let through is still queued.
        */
-      ~Bus() ;
+      class Limiter : public Mailbox
+      {
+        public:
+          /** Constructor.
+           * @param delegate The subscription to call. Owned by this object if it is a mailbox.
+           * @param limit The policy of the limit.
+           * @param milliseconds The period of the limit.
+           */
+          Limiter( const Delegate& delegate, Limit limit, unsigned milliseconds ) ;
+          
+          /** Virtual deconstructor. Releases the subscription's mailbox, if any.
+           */
+          virtual ~Limiter() ;
+          
+          /** Method to let data through to the subscription, or hold or drop it, depending on the limit.
+           * @param pointer Pointer to the data.
+           * @param idx The index to use for the subscription.
+           */
+          void execute( const void* pointer, unsigned idx = 0 ) ;
+          
+          /** Method to deliver held data whose time has come, then anything queued in the subscription's mailbox, on the calling thread.
+           * @return The amount of data delivered.
+           */
+          unsigned drain() override ;
+          
+          /** Method to size the subscription's mailbox, if any, to a topic's queue settings.
+           * @param config The queue settings of the topic.
+           */
+          void bind( struct QueueConfig& config ) override ;
+          
+          /** Method to close the subscription's mailbox, if any.
+           */
+          void close() override ;
+          
+          /** Static trampoline to hand data to the limiter a delegate refers to.
+           * @param delegate The delegate of the limiter.
+           * @param pointer Pointer to the data.
+           * @param idx The index to use for the subscription.
+           */
+          static void call( const Delegate& delegate, const void* pointer, unsigned idx ) ;
+        
+        protected:
+          /** Method to call the subscription.
+           * @param pointer Pointer to the data.
+           * @param idx The index to use for the subscription.
+           */
+          void forward( const void* pointer, unsigned idx ) ;
+        
+        private:
+          struct LimiterData* limiter_data ;
+      };
       
-      /** Method to wait on all registered actions to occur.
+      /** Handle to a topic that has been resolved for a single type of data.
+       * Emitting through a handle skips building the key and looking up the signal, and goes straight to the subscriber list.
+       * @note Subscribers that enroll after the handle was made are still seen by it.
        */
-      void wait() ;
+      template<class Value>
+      class Topic
+      {
+        public:
+          /** Default constructor. An unresolved handle emits nothing.
+           */
+          Topic() ;
+          
+          /** Method to publish data to every subscriber of this topic.
+           * @param value The data to publish.
+           */
+          void emit( const Value& value ) const ;
+          
+          /** Method to publish data to every subscriber of this topic, moving it into the last subscriber that takes ownership.
+           * @param value The data to publish.
+           */
+          void emit( Value&& value ) const ;
+          
+          /** Method to publish indexed data to every subscriber of this topic.
+           * @param value The data to publish.
+           * @param idx The index to use for subscriptions.
+           */
+          void emitIndexed( const Value& value, unsigned idx ) const ;
+          
+          /** Method to publish a contiguous batch of indexed data to every subscriber of this topic at once.
+           * @param values The data to publish.
+           * @param count The amount of data to publish.
+           * @param first The index of the first value. Each value after it is one index higher.
+           */
+          void emitBatch( const Value* values, unsigned count, unsigned first = 0 ) const ;
+          
+          /** Method to retrieve the interned id of this topic.
+           * @return The id of this topic.
+           */
+          TopicId id() const ;
+          
+        private:
+          friend class Bus ;
+          
+          struct SignalSlot* slot ;
+          TopicId            key  ;
+      };
       
-      /** Method to send functions set to publish out through the Bus.
+      /** Handle that holds a reference to a mailbox, so the mailbox outlives the subscription it was made for.
        */
-      void emit( unsigned idx = 0 ) ;
+      class MailboxHandle
+      {
+        public:
+          /** Default constructor. Refers to nothing.
+           */
+          MailboxHandle() ;
+          
+          /** Constructor. Takes over a reference the caller already added.
+           * @param mailbox The mailbox, or nullptr.
+           */
+          explicit MailboxHandle( Mailbox* mailbox ) ;
+          
+          /** Copy constructor. Adds a reference to the input handle's mailbox.
+           * @param handle The handle to copy.
+           */
+          MailboxHandle( const MailboxHandle& handle ) ;
+          
+          /** Deconstructor. Drops this object's reference.
+           */
+          ~MailboxHandle() ;
+          
+          /** Assignment operator. Drops this object's reference, and adds one to the input handle's mailbox.
+           * @param handle The handle to copy.
+           * @return Reference to this object after assignment.
+           */
+          MailboxHandle& operator=( const MailboxHandle& handle ) ;
+          
+          /** Method to retrieve the mailbox.
+           * @return The mailbox, or nullptr if this refers to nothing.
+           */
+          Mailbox* get() const ;
+          
+        private:
+          Mailbox* mailbox ;
+      };
       
-      /** Method to manually publish data through the bus to subscriptions.
-       * @param value The data to publish.
-       * @param idx The index to use for subscriptions.
-       * @param args The key of the signal to send the data over.
+      /** Handle to a stream of one type of data over a topic, that a coroutine awaits one value at a time.
+       * Data is queued like an ASYNC subscription, with the topic's queue settings, so nothing emitted between awaits is missed unless the queue sheds it.
+       * The awaiting coroutine is resumed on the bus's executor, or on the emitting thread if it has none. See Bus::setExecutor.
+       *
+       * This is the asynchronous generator over a topic: each co_await of next() yields the next data, for as long as the coroutine keeps awaiting.
+       *
+       *   E.g.  iris::Task pipeline( iris::Bus& bus )
+       *         {
+       *           auto frames = bus.stream<Frame>( "camera::frame" ) ;
+       *           while( true ) process( co_await frames.next() ) ;
+       *         }
+       *
+       * @note Only one coroutine may await a stream at a time. The handle keeps the stream's queue alive after the bus's subscription is replaced or reset,
+       *       but nothing is queued into it any more, so a coroutine awaiting it then is never resumed.
        */
-      template<class Value, typename ... Keys>
-      inline void emitIndexed( const Value& value, unsigned idx, Keys... args ) ;
+      template<class Value>
+      class Stream
+      {
+        public:
+          /** Awaitable for the next data of a stream.
+           */
+          class Next
+          {
+            public:
+              bool  await_ready()  ;
+              Value await_resume() ;
+              
+              template<class Handle>
+              bool await_suspend( Handle handle ) ;
+              
+            private:
+              friend class Stream ;
+              
+              MailboxHandle mailbox  ;
+              Executor*     executor ;
+              bool          ready    ;
+          };
+          
+          /** Default constructor. An unresolved handle can not be awaited.
+           */
+          Stream() ;
+          
+          /** Method to make an awaitable for the next data of this stream.
+           * @return The awaitable, which results in the data.
+           */
+          Next next() const ;
+          
+          /** Method to retrieve the index the data last awaited was emitted with.
+           * @return The index of the data.
+           */
+          unsigned index() const ;
+          
+        private:
+          friend class Bus ;
+          
+          MailboxHandle mailbox  ;
+          Executor*     executor ;
+      };
       
-      /** Method to manually publish data through the bus to subscriptions.
-       * @param value The data to publish.
-       * @param args The key of the signal to send the data over.
+      /** Type-erased state shared between a request and the server answering it.
+       * The request carries a pointer to it, so replies go straight to the caller without looking anything up.
        */
-      template<class Value, typename ... Keys>
-      inline void emit( const Value& value, Keys... args ) ;
-      
-      /** Method to enroll a subscription in the bus. 
-       *  AKA Set a setter function pointer to receive data copy.
-       * @param setter The function pointer of the setter to recieve data.
+      class ReplyState
+      {
+        public:
+          /** Default constructor. The state starts pending, with a single reference.
+           */
+          ReplyState() ;
+          
+          /** Virtual deconstructor.
+           */
+          virtual ~ReplyState() ;
+          
+          /** Method to add a reference to this state.
+           */
+          void acquire() ;
+          
+          /** Method to drop a reference to this state, releasing it once the last one is dropped.
+           */
+          void release() ;
+          
+          /** Method to add a reference held by a copy of the request on it's way to a server.
+           */
+          void acquireRequest() ;
+          
+          /** Method to drop a reference held by a copy of the request. Once the last copy is gone without a server claiming it, the request finishes unanswered.
+           */
+          void releaseRequest() ;
+          
+          /** Method to claim the right to answer the request. Only the first claim succeeds.
+           * @return Whether or not the caller may answer.
+           */
+          bool claim() ;
+          
+          /** Method to finish a claimed request, waking anything waiting on it.
+           * @param answered Whether or not the reply holds an answer.
+           */
+          void complete( bool answered ) ;
+          
+          /** Method to retrieve whether or not the request is finished.
+           * @return Whether or not the request is finished.
+           */
+          bool ready() const ;
+          
+          /** Method to retrieve whether or not the request was answered. False for requests nobody served.
+           * @return Whether or not the request was answered.
+           */
+          bool answered() const ;
+          
+          /** Method to wait for the request to finish.
+           * @param milliseconds The most time to wait.
+           * @return Whether or not the request is finished.
+           */
+          bool wait( unsigned milliseconds ) const ;
+          
+          /** Method to wait for the request to finish, however long it takes.
+           */
+          void wait() const ;
+          
+          /** Method to have a suspended coroutine resumed once the request is finished.
+           * @param executor The executor to resume the coroutine on, or nullptr to resume it on the answering thread.
+           * @param resume The function to resume the coroutine with.
+           * @param address The address of the coroutine.
+           * @return Whether or not the coroutine should stay suspended. False if the request finished in the meantime.
+           */
+          bool await( Executor* executor, Executor::Task resume, void* address ) ;
+          
+        private:
+          struct ReplyData* reply_data ;
+      };
+      
+      /** The state of a request, along with the answer to it.
+       */
+      template<class Type>
+      class ReplyValue : public ReplyState
+      {
+        public:
+          Type value ; ///< The answer. Only meaningful once the request was answered.
+      };
+      
+      /** Handle to the reply of a request made through Bus::request.
+       * The reply can be waited on, or awaited by a coroutine, which is resumed on the executor of the bus that made the request.
+       *
+       *   E.g.  auto first  = bus.request<Result>( Query{ 1 }, "inference::run" ) ;
+       *         auto second = bus.request<Result>( Query{ 2 }, "inference::run" ) ; // Both are outstanding at once.
+       *         use( first.get(), second.get() ) ;
+       *
+       * @note Copies of a handle share the same reply.
+       */
+      template<class Value>
+      class Reply
+      {
+        public:
+          /** Default constructor. Refers to no request, so is never ready.
+           */
+          Reply() ;
+          
+          /** Copy constructor. Shares the input's reply.
+           * @param reply The handle to share.
+           */
+          Reply( const Reply& reply ) ;
+          
+          /** Assignment operator. Shares the input's reply.
+           * @param reply The handle to share.
+           * @return Reference to this object after assignment.
+           */
+          Reply& operator=( const Reply& reply ) ;
+          
+          /** Deconstructor. Drops this object's reference to the reply.
+           */
+          ~Reply() ;
+          
+          /** Method to retrieve whether or not the request is finished, either answered or with nobody to answer it.
+           * @return Whether or not the request is finished.
+           */
+          bool ready() const ;
+          
+          /** Method to retrieve whether or not the request was answered.
+           * @return Whether or not the request was answered.
+           */
+          bool answered() const ;
+          
+          /** Method to wait for the request to finish.
+           * @param milliseconds The most time to wait.
+           * @return Whether or not the request is finished.
+           */
+          bool wait( unsigned milliseconds ) const ;
+          
+          /** Method to retrieve the answer, waiting for it if the request is not finished yet.
+           * @return The answer, or a default value if the request was not answered.
+           */
+          const Value& get() const ;
+          
+          bool  await_ready () const ;
+          Value await_resume() const ;
+          
+          template<class Handle>
+          bool await_suspend( Handle handle ) ;
+          
+        private:
+          friend class Bus ;
+          
+          ReplyValue<Value>* state    ;
+          Executor*          executor ;
+      };
+
+      /** Default constructor. Initializes this object's data.
+       * @param id The channel to associate with this event bus.
+       */
+      Bus( unsigned id = 0 ) ;
+      
+      /**
+       * @param bus
+       */
+      Bus( const Bus& bus ) ;
+      
+      /**
+       * @param bus
+       * @return 
+       */
+      Bus& operator=( const Bus& bus ) ;
+      
+      /** Deconstructor. Releases this object's data.
+       */
+      ~Bus() ;
+      
+      /** Method to wait until every REQUIRED subscription of this bus has recieved data since the last wait.
+       * Subscriptions signal a single eventcount per bus as their data arrives, so emitting only makes a syscall while a thread is waiting here.
+       *
+       *   E.g.  bus.enroll( &setImage, iris::REQUIRED, "camera::image" ) ;
+       *         bus.enroll( &setPose , iris::REQUIRED, "imu::pose"     ) ;
+       *         bus.wait() ; // Returns once both an image and a pose arrived.
+       *
+       * @note Returns straight away if this bus has no REQUIRED subscriptions. A REQUIRED wildcard subscription is waited on until data arrives from any topic it matches.
+       */
+      void wait() ;
+      
+      /** Method to wait until every REQUIRED subscription of this bus has recieved data since the last wait, or the timeout passes.
+       * @param milliseconds The most time to wait.
+       * @return Whether or not every subscription's data arrived. If not, what did arrive still counts toward the next wait.
+       */
+      bool wait( unsigned milliseconds ) ;
+      
+      /** Method to send functions set to publish out through the Bus.
+       */
+      void emit( unsigned idx = 0 ) ;
+      
+      /** Method to send the functions set to publish over a single topic out through the Bus.
+       * @param idx The index to publish with.
+       * @param args The key of the signal to publish over.
+       */
+      template<typename ... Keys>
+      inline void pull( unsigned idx, Keys... args ) ;
+      
+      /** Static method to take a snapshot of the metrics of every topic.
+       * @note Empty unless the bus was built with IRIS_BUS_METRICS.
+       * @return The snapshot.
+       */
+      static BusStats stats() ;
+      
+      /** Static method to print a snapshot of the metrics of every topic periodically.
+       * @note The report is printed by whichever thread emits once the interval has passed. Does nothing unless the bus was built with IRIS_BUS_METRICS.
+       * @param milliseconds The time between reports, or 0 to stop reporting.
+       */
+      static void setStatsInterval( unsigned milliseconds ) ;
+      
+      /** Method to deliver all data queued for this bus's ASYNC subscriptions, on the calling thread.
+       * @return The amount of data delivered.
+       */
+      unsigned drain() ;
+      
+      /** Method to manually publish data through the bus to subscriptions.
+       * @param value The data to publish.
+       * @param idx The index to use for subscriptions.
+       * @param args The key of the signal to send the data over.
+       */
+      template<class Value, typename ... Keys>
+      inline void emitIndexed( const Value& value, unsigned idx, Keys... args ) ;
+      
+      /** Method to manually publish data through the bus to subscriptions.
+       * @note The key may also be a single pre-interned TopicId, which skips building the key entirely.
+       * @param value The data to publish.
+       * @param args The key of the signal to send the data over.
+       */
+      template<class Value, typename ... Keys>
+      inline void emit( const Value& value, Keys... args ) ;
+      
+      /** Method to manually publish data through the bus to subscriptions, handing it over instead of copying it.
+       * Every subscriber but the last reads the data. The last one moves it out if it takes the data by value or by rvalue-reference, so a topic with a single owning subscriber never copies.
+       *
+       *   E.g.  bus.emit( std::move( points ), "lidar::points" ) ;
+       *
+       * @note Subscribers are called in the order they enrolled, so which one is last depends on that order.
+       * @param value The data to publish. Left moved-from.
+       * @param args The key of the signal to send the data over.
+       */
+      template<class Value, typename ... Keys, typename = std::enable_if_t<!std::is_reference<Value>::value && !std::is_const<Value>::value>>
+      inline void emit( Value&& value, Keys... args ) ;
+      
+      /** Method to publish a contiguous batch of indexed data through the bus with a single look up.
+       * @note Batch subscriptions recieve the whole batch in one call. Every other subscription recieves it one index at a time, in order.
+       * @param values The data to publish.
+       * @param count The amount of data to publish.
+       * @param first The index of the first value. Each value after it is one index higher.
+       * @param args The key of the signal to send the data over.
+       */
+      template<class Value, typename ... Keys>
+      inline void emitBatch( const Value* values, unsigned count, unsigned first, Keys... args ) ;
+      
+      /** Method to resolve a handle for publishing one type of data over a topic.
+       * @param args The key of the signal to send the data over.
+       * @return The handle to emit through.
+       */
+      template<class Value, typename ... Keys>
+      inline Topic<Value> topic( Keys... args ) ;
+      
+      /** Method to subscribe this bus to a topic as a stream of data that coroutines await.
+       * @note A bus holds one subscription per topic & type, so this reuses the bus's stream of the topic if it has one, and otherwise replaces it's subscription, which is reported.
+       * @param args The key of the signal to recieve data over. Wildcards are not supported.
+       * @return The handle to await data from.
+       */
+      template<class Value, typename ... Keys>
+      inline Stream<Value> stream( Keys... args ) ;
+      
+      /** Method to await the next data emitted over a topic.
+       *
+       *   E.g.  Frame frame = co_await bus.next<Frame>( "camera::frame" ) ;
+       *
+       * @note The first call subscribes the bus to the topic as a stream, so data emitted between later awaits is queued instead of missed.
+       *       A bus holds one subscription per topic & type, so this replaces any callback subscribed with the same type, which is reported.
+       * @param args The key of the signal to recieve data over.
+       * @return The awaitable, which results in the data.
+       */
+      template<class Value, typename ... Keys>
+      inline typename Stream<Value>::Next next( Keys... args ) ;
+      
+      /** Method to send a request over a topic to the server of that topic, without waiting for the answer.
+       * Synchronous servers answer before this returns. ASYNC servers answer whenever they drain, so many requests can be outstanding at once.
+       * @note A request nobody serves is finished unanswered right away.
+       * @param request The request.
+       * @param args The key of the signal to send the request over.
+       * @return The handle to the reply.
+       */
+      template<class Response, class Request, typename ... Keys>
+      inline Reply<Response> request( const Request& request, Keys... args ) ;
+      
+      /** Method to answer the requests sent over a topic.
+       * @note Combine the requirement with iris::ASYNC to queue requests and answer them on whichever thread drains this bus.
+       *       When several servers answer a topic, the first to take a request answers it.
+       * @param server The function that answers a request.
+       * @param req The requirement of the subscription.
+       * @param args The arguments that make up the name of the signal to answer requests over.
+       */
+      template<typename ... Keys, class Request, class Response>
+      inline void serve( Response (*server)( const Request& ), Requirement req, Keys... args ) ;
+      
+      /** Method to answer the requests sent over a topic with a method.
+       * @param obj The object to call the method on.
+       * @param server The method that answers a request.
+       * @param req The requirement of the subscription.
+       * @param args The arguments that make up the name of the signal to answer requests over.
+       */
+      template<typename ... Keys, class Object, class Request, class Response>
+      inline void serve( Object* obj, Response (Object::*server)( const Request& ), Requirement req, Keys... args ) ;
+      
+      /** Method to limit how often this bus's subscriptions to a topic are called, no matter how often data is emitted over it.
+       * Limits are checked as data is emitted, by the emitter's monotonic clock, so data that is skipped costs the emitter a clock read and no call.
+       *
+       *   E.g.  bus.limit( iris::Limit::Latest, 33, "camera::stats" ) ; // At most ~30 calls a second, always with the latest stats.
+       *         bus.enroll( &onStats, iris::OPTIONAL, "camera::stats" ) ;
+       *
+       * @note Only applies to subscriptions enrolled afterwards.
+       * @note Nothing flushes held data on a timer. Data held by Limit::Latest or Limit::Debounce is only delivered by the next emit past it's time, or by Bus::drain,
+       *       even for synchronous subscriptions. Without either, the last data before a topic goes quiet is never delivered, so drain buses with limited topics that can go quiet.
+       * @param limit The policy of the limit, or Limit::None to remove it.
+       * @param milliseconds The period of the limit.
+       * @param args The arguments that make up the name of the topic to limit.
+       */
+      template<typename ... Keys>
+      inline void limit( Limit limit, unsigned milliseconds, Keys... args ) ;
+      
+      /** Method to set the executor that coroutines awaiting this bus's streams are resumed on.
+       * @note Only applies to streams made afterwards.
+       * @param executor The executor, or nullptr to resume coroutines on the thread that emits their data.
+       */
+      void setExecutor( Executor* executor ) ;
+      
+      /** Method to enroll a subscription in the bus. 
+       *  AKA Set a setter function pointer to receive data copy.
+       * @param setter The function pointer of the setter to recieve data.
        * @param args The arguments that make up the name of signal to send the data over.
        */
       template<typename ... Keys>
@@ -217,6 +1116,14 @@ namespace iris
       template<typename ... Keys, class Value>
       inline void enroll( void (*setter)( const Value& ), Requirement req, Keys... args ) ;
 
+      /** Method to enroll a subscription in the bus that takes ownership of data.
+       * @note Data is moved in when this is the last subscriber of a moved emit, and copied in otherwise.
+       * @param setter The function pointer of the setter to recieve data via rvalue-reference.
+       * @param args The arguments that make up the name of signal to send the data over.
+       */
+      template<typename ... Keys, class Value>
+      inline void enroll( void (*setter)( Value&& ), Requirement req, Keys... args ) ;
+      
       /** Method to enroll an indexed subscription in the bus. 
        *  AKA Set a setter function pointer to receive data via value.
        * @param setter The function pointer of the setter to recieve data.
@@ -233,6 +1140,15 @@ namespace iris
       template<typename ... Keys, class Value>
       inline void enroll( void (*setter)( unsigned, Value const & ), Requirement req, Keys... args ) ;
       
+      /** Method to enroll a batch subscription in the bus. 
+       * @note The setter is given the data, the amount of data and the index of the first value. Single emits arrive as a batch of one.
+       * @param setter The function pointer to use for recieving data.
+       * @param req Whether or not this subscription is required.
+       * @param args The arguments that make up the name of the signal to recieve data from.
+       */
+      template<typename ... Keys, class Value>
+      inline void enroll( void (*setter)( const Value*, unsigned, unsigned ), Requirement req, Keys... args ) ;
+      
       /** Method to enroll a method subscription in the bus.
        * @param obj The object to use for calling the subscription.
        * @param setter The function pointer to the setter to recieve data via copy.
@@ -257,6 +1173,15 @@ namespace iris
       template<typename ... Keys, class Object, class Value>
       inline void enroll( Object* obj, void (Object::*setter)( Value const & ), Requirement req, Keys... args ) ;
       
+      /** Method to enroll a method subscription in the bus that takes ownership of data.
+       * @note Data is moved in when this is the last subscriber of a moved emit, and copied in otherwise.
+       * @param obj The object to use for calling the subscription.
+       * @param setter The function pointer to the setter to recieve data via rvalue-reference.
+       * @param args The arguments that make up the name of the signal to send data over.
+       */
+      template<typename ... Keys, class Object, class Value>
+      inline void enroll( Object* obj, void (Object::*setter)( Value&& ), Requirement req, Keys... args ) ;
+      
       /** Method to enroll an indexed method subscription in the bus.
        * @param obj The object to use for calling the subscription.
        * @param setter The function pointer to the setter to recieve data via copy.
@@ -273,6 +1198,16 @@ namespace iris
       template<typename ... Keys, class Object, class Value>
       inline void enroll( Object* obj, void (Object::*setter)( unsigned, Value const & ), Requirement req, Keys... args ) ;
       
+      /** Method to enroll a batch method subscription in the bus.
+       * @note The setter is given the data, the amount of data and the index of the first value. Single emits arrive as a batch of one.
+       * @param obj The object to use for calling the subscription function.
+       * @param setter The function pointer to use for recieving data.
+       * @param req Whether or not this subscription is required.
+       * @param args The arguments that make up the name of the signal to recieve data from.
+       */
+      template<typename ... Keys, class Object, class Value>
+      inline void enroll( Object* obj, void (Object::*setter)( const Value*, unsigned, unsigned ), Requirement req, Keys... args ) ;
+      
       /** Method to set a publisher in the bus.
        * @param getter The function pointer to use for publishing data via copy.
        * @param args The arguments that make up the name of the signal to send data over.
@@ -368,9 +1303,155 @@ namespace iris
       void setChannel( unsigned id ) ;
       
     private:
+      friend struct   BusData  ;
+      friend class    Replayer ;
+      friend unsigned subscribedTypes( TopicId, unsigned*, unsigned ) ;
       
       constexpr static unsigned UNIVERSAL_TYPE = 0x0000000 ;
       
+      /** Structure to contain the functions a retained topic uses to copy data of one type, and to release the copy.
+       */
+      struct Retainer
+      {
+        void* ( *copy    )( const void* values, unsigned count ) ;
+        void  ( *release )( void* values, unsigned count ) ;
+      };
+      
+      /** Method to retrieve the functions to retain data of the input template type with.
+       * @return Reference to the retainer of the type, or to one without functions if the type can not be copy constructed.
+       */
+      template<class Type>
+      inline static const Retainer& retainer() ;
+      
+      /** Static method to copy a contiguous batch of data. The copies are copy constructed, so the type needs no default constructor or assignment.
+       * @param values The data to copy.
+       * @param count The amount of data to copy.
+       * @return The copy.
+       */
+      template<class Type>
+      static void* copyValues( const void* values, unsigned count ) ;
+      
+      /** Static method to release data made by copyValues.
+       * @param values The copy to release.
+       * @param count The amount of data in the copy.
+       */
+      template<class Type>
+      static void releaseValues( void* values, unsigned count ) ;
+      
+      /** Template class to encapsulate a subscriber that queues it's data to be delivered on another thread.
+       */
+      template<class Type, bool HasValue = true>
+      class AsyncSubscriber : public Mailbox
+      {
+        public:
+          AsyncSubscriber( const Delegate& delegate ) ;
+          ~AsyncSubscriber() ;
+        private:
+          void allocate( unsigned cells ) ;
+          void store( unsigned cell, const void* pointer ) ;
+          void move( unsigned cell, void* pointer ) ;
+          void deliver( unsigned cell, unsigned idx ) ;
+          
+          Delegate delegate ;
+          Type*    values   ;
+      };
+      
+      /** Template class to encapsulate a subscriber that is called at most as often as it's topic's limit allows.
+       * @note Holds two cells, so data can be held while the previously held data is being delivered.
+       */
+      template<class Type, bool HasValue = true>
+      class LimitedSubscriber : public Limiter
+      {
+        public:
+          LimitedSubscriber( const Delegate& delegate, Limit limit, unsigned milliseconds ) ;
+        private:
+          void allocate( unsigned cells ) ;
+          void store( unsigned cell, const void* pointer ) ;
+          void deliver( unsigned cell, unsigned idx ) ;
+          
+          Type values[ 2 ] ;
+      };
+      
+      /** Template class to carry a request to it's server, along with where to put the answer.
+       * @note Holds a reference to the reply, so queued requests keep it alive.
+       */
+      template<class Request, class Response>
+      class Envelope
+      {
+        public:
+          Envelope() ;
+          Envelope( const Envelope& envelope ) ;
+          Envelope& operator=( const Envelope& envelope ) ;
+          ~Envelope() ;
+          
+          Request               request ; ///< The request.
+          ReplyValue<Response>* reply   ; ///< The reply to answer, or nullptr for an empty envelope.
+      };
+      
+      /** Static trampoline to answer the request in an envelope with a server function or method.
+       * @param delegate The delegate of the server.
+       * @param pointer Pointer to the envelope.
+       * @param idx Unused, as requests are not indexed.
+       */
+      template<class Request, class Response, class Object, class Callback>
+      static void callServer( const Delegate& delegate, const void* pointer, unsigned idx ) ;
+      
+      /** Template class to encapsulate a subscriber that queues it's data for a coroutine to take one value at a time.
+       */
+      template<class Type>
+      class AwaitedSubscriber : public Mailbox
+      {
+        public:
+          AwaitedSubscriber() ;
+          ~AwaitedSubscriber() ;
+          
+          Type     current ; ///< The data last taken.
+          unsigned index   ; ///< The index of the data last taken.
+          
+        private:
+          void allocate( unsigned cells ) ;
+          void store( unsigned cell, const void* pointer ) ;
+          void move( unsigned cell, void* pointer ) ;
+          void deliver( unsigned cell, unsigned idx ) ;
+          
+          Type* values ;
+      };
+      
+      /** Structure to describe the limit set on this bus's subscriptions to a topic.
+       */
+      struct Rate
+      {
+        Limit    limit        ; ///< The policy of the limit.
+        unsigned milliseconds ; ///< The period of the limit.
+      };
+      
+      /** Method to wrap a subscription in a mailbox if it's requirement asks for asynchronous delivery, and in a limiter if it's topic is limited.
+       * @note Mailboxes and limiters hold their data in cells, so types that can not be default constructed and copy assigned are delivered synchronously instead.
+       * @param delegate The subscription to wrap.
+       * @param req The requirement the subscription was enrolled with.
+       * @param key The topic the subscription is enrolled to.
+       * @return The subscription to enroll.
+       */
+      template<class Type, bool HasValue = true>
+      inline Delegate wrap( const Delegate& delegate, Requirement req, TopicId key ) ;
+      
+      /** Method to retrieve the limit set on this bus's subscriptions to a topic.
+       * @param key The topic.
+       * @return The limit of the topic. Limit::None if none was set.
+       */
+      Rate rateOf( TopicId key ) ;
+      
+      /** Static method to report that a subscription asked to be queued or limited, but it's type can not be held.
+       * @param key The topic the subscription is enrolled to.
+       */
+      static void reportUnqueued( TopicId key ) ;
+      
+      /** Method to set the limit of this bus's subscriptions to a topic.
+       * @param key The topic.
+       * @param rate The limit.
+       */
+      void limitBase( TopicId key, const Rate& rate ) ;
+      
       /** Template class to encapsulate a publisher that emits via object.
        */
       template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue = true>
@@ -402,39 +1483,94 @@ namespace iris
           Callback callback ;
       };
       
-      /** Template class to encapsulate a subscriber that recieves data via object.
+      /** Method to make a delegate that calls a function.
+       * @note Owned callbacks take their data by value or by rvalue-reference, so moved emits may move data into them.
+       * @param callback The function to call.
+       * @return The delegate.
        */
-      template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue = true>
-      class MethodSubscriber : public Subscriber
-      {
-        public:
-          typedef void (Object::*Callback                  )( Type                  ) ;
-          typedef void (Object::*IndexedCallback           )( unsigned, Type        ) ;
-          typedef void (Object::*ReferencedCallback        )( const Type&           ) ;
-          typedef void (Object::*IndexedReferencedCallback )( unsigned, const Type& ) ;
-          
-          MethodSubscriber( Object* obj, Callback callback ) ;
-          
-          void execute( const void* pointer, unsigned idx = 0 ) ;
-        private:
-          Object*  object   ;
-          Callback callback ;
-      };
-
-      /** Template class to encapsulate a subscriber that recieves data via function.
-       */      
-      template<class Type, bool Referenced, bool Indexed, bool HasValue = true>
-      class FunctionSubscriber : public Subscriber
-      {
-        public:
-          typedef void (*Callback)( Type ) ;
-
-          FunctionSubscriber( Callback callback ) ;
-          
-          void execute( const void* pointer, unsigned idx = 0 ) ;
-        private:
-          Callback callback ;
-      };
+      template<class Type, bool Indexed, bool HasValue = true, bool Owned = false, class Callback>
+      inline static Delegate function( Callback callback ) ;
+      
+      /** Method to make a delegate that calls a method of an object.
+       * @note Owned callbacks take their data by value or by rvalue-reference, so moved emits may move data into them.
+       * @param obj The object to call the method on.
+       * @param callback The method to call.
+       * @return The delegate.
+       */
+      template<class Type, bool Indexed, bool HasValue = true, bool Owned = false, class Object, class Callback>
+      inline static Delegate method( Object* obj, Callback callback ) ;
+      
+      /** Static trampoline to call a function stored in a delegate.
+       * @param delegate The delegate holding the function.
+       * @param pointer Pointer to the data to send.
+       * @param idx The index of the data.
+       */
+      template<class Type, bool Indexed, bool HasValue, class Callback>
+      static void callFunction( const Delegate& delegate, const void* pointer, unsigned idx ) ;
+      
+      /** Static trampoline to call a method stored in a delegate.
+       * @param delegate The delegate holding the object and method.
+       * @param pointer Pointer to the data to send.
+       * @param idx The index of the data.
+       */
+      template<class Type, bool Indexed, bool HasValue, class Object, class Callback>
+      static void callMethod( const Delegate& delegate, const void* pointer, unsigned idx ) ;
+      
+      /** Static trampoline to move data into a function stored in a delegate.
+       * @param delegate The delegate holding the function.
+       * @param pointer Pointer to the data to move.
+       * @param idx The index of the data.
+       */
+      template<class Type, bool Indexed, class Callback>
+      static void sinkFunction( const Delegate& delegate, void* pointer, unsigned idx ) ;
+      
+      /** Static trampoline to move data into a method stored in a delegate.
+       * @param delegate The delegate holding the object and method.
+       * @param pointer Pointer to the data to move.
+       * @param idx The index of the data.
+       */
+      template<class Type, bool Indexed, class Object, class Callback>
+      static void sinkMethod( const Delegate& delegate, void* pointer, unsigned idx ) ;
+      
+      /** Method to make a delegate that calls a function with whole batches of data.
+       * @param callback The function to call.
+       * @return The delegate.
+       */
+      template<class Type, class Callback>
+      inline static Delegate batchFunction( Callback callback ) ;
+      
+      /** Method to make a delegate that calls a method of an object with whole batches of data.
+       * @param obj The object to call the method on.
+       * @param callback The method to call.
+       * @return The delegate.
+       */
+      template<class Type, class Object, class Callback>
+      inline static Delegate batchMethod( Object* obj, Callback callback ) ;
+      
+      /** Static batch trampoline to call a function stored in a delegate.
+       * @param delegate The delegate holding the function.
+       * @param values Pointer to the data to send.
+       * @param count The amount of data to send.
+       * @param first The index of the first value.
+       */
+      template<class Type, class Callback>
+      static void callBatchFunction( const Delegate& delegate, const void* values, unsigned count, unsigned first ) ;
+      
+      /** Static batch trampoline to call a method stored in a delegate.
+       * @param delegate The delegate holding the object and method.
+       * @param values Pointer to the data to send.
+       * @param count The amount of data to send.
+       * @param first The index of the first value.
+       */
+      template<class Type, class Object, class Callback>
+      static void callBatchMethod( const Delegate& delegate, const void* values, unsigned count, unsigned first ) ;
+      
+      /** Static trampoline to hand a single value to a batch delegate, as a batch of one.
+       * @param delegate The batch delegate.
+       * @param pointer Pointer to the data to send.
+       * @param idx The index of the data.
+       */
+      static void callBatch( const Delegate& delegate, const void* pointer, unsigned idx ) ;
       
       /** Forward declared structure to contain this object's internal data.
        */
@@ -450,96 +1586,209 @@ namespace iris
        */
       const BusData& data() const ;
       
-      /** Method to enroll a publisher in this bus.
+      /** Method to find the mailbox of this bus's stream of a topic & type, reporting a subscription of any other kind that a new stream would replace.
+       * @param key The topic.
+       * @param type_id The hash of the type of data the stream recieves.
+       * @return The mailbox, with a reference added for the caller, or nullptr if this bus has no such stream.
+       */
+      Mailbox* findStream( TopicId key, unsigned type_id ) ;
+      
+      /** Method to retrieve the executor set on this bus.
+       * @return The executor, or nullptr if there is none.
+       */
+      Executor* executor() ;
+      
+      /** Method to enroll a publisher in this bus.
        * @param key The key of signal to use to publish over.
        * @param publisher The publisher object to use for handling data.
        * @param type_id The hash representing the type of data being transferred.
        * @param type_name The name of the type being transferred.
        */
-      void enrollBase( const Key& key, Publisher* publisher, unsigned type_id ) ;
+      void enrollBase( TopicId key, Publisher* publisher, unsigned type_id ) ;
       
       /** Method to enroll a publisher in this bus.
        * @param key The key of signal to use to publish over.
        * @param publisher The publisher object to use for handling data.
        * @param type_name The name of the type being transferred.
        */
-      void enrollBase( const Key& key, Publisher* publisher ) ;
+      void enrollBase( TopicId key, Publisher* publisher ) ;
       
       /** Method to enroll a subscriber in this bus.
        * @param key The key of signal to use to subscribe to.
-       * @param subscriber The subscriber object to use for handling data.
+       * @param delegate The subscription to use for handling data.
        * @param type_id The hash representing the type of data being transferred.
-       * @param type_name The name of the type being transferred.
        */
-      void enrollBase( const Key& key, Subscriber* subscriber, Requirement req, unsigned type_id ) ;
+      void enrollBase( TopicId key, const Delegate& delegate, Requirement req, unsigned type_id ) ;
       
       /** Method to enroll a subscriber in this bus.
        * @param key The key of signal to use to subscribe to.
        * @param subscriber The subscriber object to use for handling data.
        */
-      void enrollBase( const Key& key, Subscriber* subscriber, Requirement req ) ;
+      void enrollBase( TopicId key, Subscriber* subscriber, Requirement req ) ;
+      
+      /** Method to enroll a wildcard subscription in this bus.
+       * @param key The pattern of the topics to subscribe to.
+       * @param delegate The subscription to use for handling data.
+       * @param type_id The hash representing the type of data being transferred.
+       */
+      void enrollPattern( TopicId key, const Delegate& delegate, unsigned type_id ) ;
       
       /** Method to manually emit data over the data bus.
        * @param key The key of signal to use to publish over.
        * @param value The value to send over the busu.
        * @param type_id The hash representing the type of data being transferred.
        * @param idx The index of data to send over.
-       * @param type_name The name of the type being transferred.
+       * @param retainer The functions to keep a copy of the data with, if the topic is retained.
+       */
+      void emitBase( TopicId key, const void* value, unsigned type_id, unsigned idx, const Retainer& retainer ) ;
+      
+      /** Method to emit data straight to a resolved slot of subscribers.
+       * @param slot The slot of subscribers to send the data to.
+       * @param value The value to send over the bus.
+       * @param idx The index of data to send over.
+       * @param retainer The functions to keep a copy of the data with, if the topic is retained.
+       */
+      static void emitBase( SignalSlot* slot, const void* value, unsigned idx, const Retainer& retainer ) ;
+      
+      /** Method to manually emit data over the data bus, moving it into the last subscriber that takes ownership.
+       * @param key The key of signal to use to publish over.
+       * @param value The value to send over the bus. Left moved-from.
+       * @param type_id The hash representing the type of data being transferred.
+       * @param idx The index of data to send over.
+       * @param retainer The functions to keep a copy of the data with, if the topic is retained.
+       */
+      void emitMovedBase( TopicId key, void* value, unsigned type_id, unsigned idx, const Retainer& retainer ) ;
+      
+      /** Method to emit data straight to a resolved slot of subscribers, moving it into the last subscriber that takes ownership.
+       * @param slot The slot of subscribers to send the data to.
+       * @param value The value to send over the bus. Left moved-from.
+       * @param idx The index of data to send over.
+       * @param retainer The functions to keep a copy of the data with, if the topic is retained.
+       */
+      static void emitMovedBase( SignalSlot* slot, void* value, unsigned idx, const Retainer& retainer ) ;
+      
+      /** Method to send the publishers of a single topic out through the bus.
+       * @param key The key of signal to publish over.
+       * @param idx The index to publish with.
+       */
+      void pullBase( TopicId key, unsigned idx ) ;
+      
+      /** Method to emit a contiguous batch of data over the data bus.
+       * @param key The key of signal to use to publish over.
+       * @param values The data to send over the bus.
+       * @param stride The size of a single value, in bytes.
+       * @param count The amount of data to send.
+       * @param type_id The hash representing the type of data being transferred.
+       * @param first The index of the first value.
+       * @param retainer The functions to keep a copy of the data with, if the topic is retained.
+       */
+      void emitBatchBase( TopicId key, const void* values, unsigned stride, unsigned count, unsigned type_id, unsigned first, const Retainer& retainer ) ;
+      
+      /** Method to emit a contiguous batch of data straight to a resolved slot of subscribers.
+       * @param slot The slot of subscribers to send the data to.
+       * @param values The data to send over the bus.
+       * @param stride The size of a single value, in bytes.
+       * @param count The amount of data to send.
+       * @param first The index of the first value.
+       * @param retainer The functions to keep a copy of the data with, if the topic is retained.
+       */
+      static void emitBatchBase( SignalSlot* slot, const void* values, unsigned stride, unsigned count, unsigned first, const Retainer& retainer ) ;
+      
+      /** Method to keep a copy of a batch of data on a slot, if it's topic is retained.
+       * @param slot The slot the data was emitted to.
+       * @param values The data to keep.
+       * @param stride The size of a single value, in bytes.
+       * @param count The amount of data to keep.
+       * @param first The index of the first value.
+       * @param retainer The functions to copy the data with. Data without a copy function, such as replayed data, is not kept.
        */
-      void emitBase( const Key& key, const void* value, unsigned type_id, unsigned idx ) ;
+      static void retain( SignalSlot* slot, const void* values, unsigned stride, unsigned count, unsigned first, const Retainer& retainer ) ;
+      
+      /** Method to find the slot of subscribers for a type of data on a topic, making it if needed.
+       * @param key The topic to resolve.
+       * @param type_id The hash representing the type of data being transferred.
+       * @return The slot of subscribers. Slots live for the lifetime of the program.
+       */
+      static SignalSlot* resolve( TopicId key, unsigned type_id ) ;
   };
   
   template<typename Type>
-  const TypeInfo& typeinfo()
+  constexpr TypeInfo buildTypeinfo()
   {
-    static TypeInfo type_info ;
-    #if defined( __GNUC__ )
+    #if defined( __clang__ )
+    const char* base_str  = __PRETTY_FUNCTION__ ;
+    const char  beg_str[] = "[Type = "          ;
+    const char  end_str[] = "]"                 ;    
+    #elif defined( __GNUC__ )
     const char* base_str  = __PRETTY_FUNCTION__ ;
     const char  beg_str[] = "[with Type ="      ;
     const char  end_str[] = "]"                 ;
     #elif defined( _MSC_VER )
-    const char* base_str  = __FUNCSIG__ ;
-    const char  beg_str[] = "typeinfo<" ;
-    const char  end_str[] = ">("        ;    
-    #elif defined( __clang__ )
-    const char* base_str  = __PRETTY_FUNCTION__ ;
-    const char  beg_str[] = "[Type = "          ;
-    const char  end_str[] = "]"                 ;    
+    const char* base_str  = __FUNCSIG__         ;
+    const char  beg_str[] = "buildTypeinfo<"    ;
+    const char  end_str[] = ">("                ;    
     #else
     const char* base_str  = "[UNKNOWN_TYPE]" ;
     const char  beg_str[] = "[" ;
     const char  end_str[] = "]" ;    
     #endif 
     
-    type_info.ctti_name   =     base_str + find( base_str, beg_str )                  ;
-    type_info.ctti_length =     find( base_str, end_str ) - find( base_str, beg_str ) ;
-    type_info.ctti_hash   = 1 + hash( type_info.ctti_name, 0, type_info.ctti_length ) ;
+    const unsigned begin = find( base_str, beg_str ) ;
+    const unsigned end   = find( base_str, end_str ) ;
     
-    return type_info ;
+    return { end - begin, 1 + hash( base_str + begin, 0, end - begin ), base_str + begin } ;
+  }
+  
+  template<typename Type>
+  constexpr const TypeInfo& typeinfo()
+  {
+    return type_info<Type> ;
+  }
+  
+  template<const char* Name>
+  TopicId StaticTopic<Name>::id()
+  {
+    static const TopicId topic = ::iris::intern( Name, StaticTopic<Name>::length, StaticTopic<Name>::hash ) ;
+    return topic ;
   }
   
-  template<typename T>
-  Key concatenate( T type )
+  template<const char* Name>
+  TopicId intern( StaticTopic<Name> topic )
+  {
+    return topic.id() ;
+  }
+  
+  template<const char* Name>
+  void operator<<( Key& first, StaticTopic<Name> second )
+  {
+    first << second.id() ;
+  }
+  
+  template<typename... TYPES>
+  Key concatenate( TYPES... types )
   {
     Key str ;
     
-    str << type ;
+    ( ( str << types ), ... ) ;
     return str ;
   }
-
-  template<typename T, typename... TYPES>
-  Key concatenate( T first, TYPES... types )
+  
+  template<typename ... Keys>
+  TopicId intern( Keys... args )
   {
-    Key str ;
+    thread_local Key key ;
     
-    str << first ;
-    str << concatenate( types... ) ;
-    return str ;
+    key.clear() ;
+    ( ( key << args ), ... ) ;
+    return ::iris::intern( static_cast<const Key&>( key ) ) ;
   }
 
   constexpr unsigned hash( const char* str, unsigned start, unsigned end, unsigned h )
   {
-    return start == end ? h : hash( str, start + 1, end, ( ( h << 5 ) + h ) + static_cast<unsigned>( str[ start ] ) ) ;
+    // Iterative, so long type names do not run into the compiler's constexpr recursion limit.
+    for( ; start != end; ++start ) h = ( ( h << 5 ) + h ) + static_cast<unsigned>( str[ start ] ) ;
+    
+    return h ;
   }
   
   constexpr unsigned find( const char* str, const char* substr )
@@ -554,116 +1803,239 @@ namespace iris
     return current ;
   }
   
-  template<class Type, bool Referenced, bool Indexed, bool HasValue>
-  Bus::FunctionSubscriber<Type, Referenced, Indexed, HasValue>::FunctionSubscriber( FunctionSubscriber<Type, Referenced, Indexed, HasValue>::Callback callback )
+  constexpr unsigned length( const char* str )
+  {
+    unsigned current = 0 ;
+    
+    while( str[ current ] != '\0' ) ++current ;
+    
+    return current ;
+  }
+  
+  template<class Callback>
+  void Bus::Delegate::Callable::store( Callback callback )
   {
-    this->callback = callback ;
+    static_assert( sizeof( Callback ) <= sizeof( Callable::bytes ), "Iris Bus: Callback is too large to store in a delegate." ) ;
+    static_assert( std::is_trivially_copyable<Callback>::value    , "Iris Bus: Callback must be a function or member function pointer." ) ;
+    
+    const unsigned char* source = reinterpret_cast<const unsigned char*>( &callback ) ;
+    
+    // Clears every byte, as delegates are compared byte for byte on removal.
+    for( unsigned index = 0; index < sizeof( this->bytes ); index++ ) this->bytes[ index ] = index < sizeof( Callback ) ? source[ index ] : 0 ;
   }
   
-  template<class Type, bool Referenced, bool Indexed, bool HasValue>
-  void Bus::FunctionSubscriber<Type, Referenced, Indexed, HasValue>::execute( const void* pointer, unsigned idx )
+  template<class Callback>
+  Callback Bus::Delegate::Callable::load() const
   {
+    Callback       callback = nullptr                                       ;
+    unsigned char* target   = reinterpret_cast<unsigned char*>( &callback ) ;
     
-    typedef void ( *Callback                  )( Type                  ) ;
-    typedef void ( *IndexedCallback           )( unsigned, Type        ) ;
-    typedef void ( *ReferencedCallback        )( const Type&           ) ;
-    typedef void ( *IndexedReferencedCallback )( unsigned, const Type& ) ;
-    typedef void ( *EmptyCallback             )(                       ) ;
+    for( unsigned index = 0; index < sizeof( Callback ); index++ ) target[ index ] = this->bytes[ index ] ;
+    
+    return callback ;
+  }
+  
+  template<class Type, bool Indexed, bool HasValue, bool Owned, class Callback>
+  Bus::Delegate Bus::function( Callback callback )
+  {
+    Delegate delegate = {} ;
+    
+    delegate.object     = nullptr                                               ;
+    delegate.trampoline = &Bus::callFunction<Type, Indexed, HasValue, Callback> ;
+    delegate.callable.store( callback ) ;
+    
+    if constexpr( Owned && HasValue ) delegate.sink = &Bus::sinkFunction<Type, Indexed, Callback> ;
+    
+    return delegate ;
+  }
+  
+  template<class Type, bool Indexed, bool HasValue, bool Owned, class Object, class Callback>
+  Bus::Delegate Bus::method( Object* obj, Callback callback )
+  {
+    Delegate delegate = {} ;
+    
+    delegate.object     = static_cast<void*>( obj )                                   ;
+    delegate.trampoline = &Bus::callMethod<Type, Indexed, HasValue, Object, Callback> ;
+    delegate.callable.store( callback ) ;
+    
+    if constexpr( Owned && HasValue ) delegate.sink = &Bus::sinkMethod<Type, Indexed, Object, Callback> ;
+    
+    return delegate ;
+  }
+  
+  template<class Type, bool Indexed, bool HasValue, class Callback>
+  void Bus::callFunction( const Delegate& delegate, const void* pointer, unsigned idx )
+  {
+    auto cb = delegate.callable.load<Callback>() ;
     
     if constexpr( !HasValue )
     {
       pointer = pointer ;
       idx     = idx     ;
-
-      auto cb = reinterpret_cast<EmptyCallback>( this->callback ) ;
-      ( ( cb )() ) ;
+      ( cb )() ;
+    }
+    else if constexpr( Indexed )
+    {
+      ( cb )( idx, *static_cast<const Type*>( pointer ) ) ;
+    }
+    else if constexpr( !std::is_invocable<Callback, const Type&>::value )
+    {
+      // Takes an rvalue, so it is handed a copy of it's own.
+      idx = idx ;
+      ( cb )( Type( *static_cast<const Type*>( pointer ) ) ) ;
     }
     else
     {
-      if( Referenced )
-      {
-        if( Indexed )
-        {
-          auto cb = reinterpret_cast<IndexedReferencedCallback>( this->callback ) ;
-          ( cb )( idx, *static_cast<const Type*>( pointer ) ) ;
-        }
-        else
-        {
-          auto cb = reinterpret_cast<ReferencedCallback>( this->callback ) ;
-          ( cb )( *static_cast<const Type*>( pointer ) ) ;
-        }
-      }
-      else
-      {
-        if( Indexed )
-        {
-          auto cb = reinterpret_cast<IndexedCallback>( this->callback ) ;
-          ( cb )( idx, *static_cast<const Type*>( pointer ) ) ;
-        }
-        else
-        {
-          auto cb = reinterpret_cast<Callback>( this->callback ) ;
-          ( cb )( *static_cast<const Type*>( pointer ) ) ;
-        }
-      }
+      idx = idx ;
+      ( cb )( *static_cast<const Type*>( pointer ) ) ;
     }
   }
   
-  template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue>
-  Bus::MethodSubscriber<Object, Type, Referenced, Indexed, HasValue>::MethodSubscriber( Object* obj, Bus::MethodSubscriber<Object, Type, Referenced, Indexed, HasValue>::Callback callback )
+  template<class Type, bool Indexed, class Callback>
+  void Bus::sinkFunction( const Delegate& delegate, void* pointer, unsigned idx )
   {
-    this->object   = obj      ;
-    this->callback = callback ;
+    auto cb = delegate.callable.load<Callback>() ;
+    
+    if constexpr( Indexed )
+    {
+      ( cb )( idx, std::move( *static_cast<Type*>( pointer ) ) ) ;
+    }
+    else
+    {
+      idx = idx ;
+      ( cb )( std::move( *static_cast<Type*>( pointer ) ) ) ;
+    }
   }
   
-  template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue>
-  void Bus::MethodSubscriber<Object, Type, Referenced, Indexed, HasValue>::execute( const void* pointer, unsigned idx )
+  template<class Type, bool Indexed, bool HasValue, class Object, class Callback>
+  void Bus::callMethod( const Delegate& delegate, const void* pointer, unsigned idx )
   {
-    typedef void ( Object::*Callback                  )( Type                  ) ;
-    typedef void ( Object::*IndexedCallback           )( unsigned, Type        ) ;
-    typedef void ( Object::*ReferencedCallback        )( const Type&           ) ;
-    typedef void ( Object::*IndexedReferencedCallback )( unsigned, const Type& ) ;
-    typedef void ( Object::*EmptyCallback             )(                       ) ;
-    
-    idx = idx ; // Suppress warning.
+    auto obj = static_cast<Object*>( delegate.object ) ;
+    auto cb  = delegate.callable.load<Callback>()      ;
     
     if constexpr( !HasValue )
     {
       pointer = pointer ;
-      auto cb = reinterpret_cast<EmptyCallback>( this->callback ) ;
-      ( ( this->object )->*( cb ) )() ; 
+      idx     = idx     ;
+      ( obj->*( cb ) )() ;
+    }
+    else if constexpr( Indexed )
+    {
+      ( obj->*( cb ) )( idx, *static_cast<const Type*>( pointer ) ) ;
+    }
+    else if constexpr( !std::is_invocable<Callback, Object*, const Type&>::value )
+    {
+      // Takes an rvalue, so it is handed a copy of it's own.
+      idx = idx ;
+      ( obj->*( cb ) )( Type( *static_cast<const Type*>( pointer ) ) ) ;
     }
     else
     {
-      if constexpr( Referenced )
-      {
-        if constexpr( Indexed )
-        {
-          auto cb = reinterpret_cast<IndexedReferencedCallback>( this->callback ) ;
-          ( ( this->object )->*( cb ) )( idx, *static_cast<const Type*>( pointer ) ) ;
-        }
-        else
-        {
-          auto cb = reinterpret_cast<ReferencedCallback>( this->callback ) ;
-          ( ( this->object )->*( cb ) )( *static_cast<const Type*>( pointer ) ) ;
-        }
-      }
-      else
-      {
-        if constexpr( Indexed )
-        {
-          auto cb = reinterpret_cast<IndexedCallback>( this->callback ) ;
-          ( ( this->object )->*( cb ) )( idx, *static_cast<const Type*>( pointer ) ) ;
-        }
-        else
-        {
-          auto cb = reinterpret_cast<Callback>( this->callback ) ;
-          ( ( this->object )->*( cb ) )( *static_cast<const Type*>( pointer ) ) ;
-        }
-      }
+      idx = idx ;
+      ( obj->*( cb ) )( *static_cast<const Type*>( pointer ) ) ;
+    }
+  }
+  
+  template<class Type, bool Indexed, class Object, class Callback>
+  void Bus::sinkMethod( const Delegate& delegate, void* pointer, unsigned idx )
+  {
+    auto obj = static_cast<Object*>( delegate.object ) ;
+    auto cb  = delegate.callable.load<Callback>()      ;
+    
+    if constexpr( Indexed )
+    {
+      ( obj->*( cb ) )( idx, std::move( *static_cast<Type*>( pointer ) ) ) ;
+    }
+    else
+    {
+      idx = idx ;
+      ( obj->*( cb ) )( std::move( *static_cast<Type*>( pointer ) ) ) ;
     }
   }
   
+  template<class Type, class Callback>
+  Bus::Delegate Bus::batchFunction( Callback callback )
+  {
+    Delegate delegate = {} ;
+    
+    delegate.object     = nullptr                                 ;
+    delegate.trampoline = &Bus::callBatch                         ;
+    delegate.batch      = &Bus::callBatchFunction<Type, Callback> ;
+    delegate.callable.store( callback ) ;
+    
+    return delegate ;
+  }
+  
+  template<class Type, class Object, class Callback>
+  Bus::Delegate Bus::batchMethod( Object* obj, Callback callback )
+  {
+    Delegate delegate = {} ;
+    
+    delegate.object     = static_cast<void*>( obj )                     ;
+    delegate.trampoline = &Bus::callBatch                               ;
+    delegate.batch      = &Bus::callBatchMethod<Type, Object, Callback> ;
+    delegate.callable.store( callback ) ;
+    
+    return delegate ;
+  }
+  
+  template<class Type, class Callback>
+  void Bus::callBatchFunction( const Delegate& delegate, const void* values, unsigned count, unsigned first )
+  {
+    auto cb = delegate.callable.load<Callback>() ;
+    
+    ( cb )( static_cast<const Type*>( values ), count, first ) ;
+  }
+  
+  template<class Type, class Object, class Callback>
+  void Bus::callBatchMethod( const Delegate& delegate, const void* values, unsigned count, unsigned first )
+  {
+    auto obj = static_cast<Object*>( delegate.object ) ;
+    auto cb  = delegate.callable.load<Callback>()      ;
+    
+    ( obj->*( cb ) )( static_cast<const Type*>( values ), count, first ) ;
+  }
+  
+  template<class Type>
+  const Bus::Retainer& Bus::retainer()
+  {
+    // Only instantiated for types that can be copied, so emitting any other type still builds.
+    if constexpr( std::is_copy_constructible<Type>::value )
+    {
+      static constexpr Retainer functions = { &Bus::copyValues<Type>, &Bus::releaseValues<Type> } ;
+      
+      return functions ;
+    }
+    else
+    {
+      static constexpr Retainer functions = { nullptr, nullptr } ;
+      
+      return functions ;
+    }
+  }
+  
+  template<class Type>
+  void* Bus::copyValues( const void* values, unsigned count )
+  {
+    std::allocator<Type> allocator                                      ;
+    const Type*          source    = static_cast<const Type*>( values ) ;
+    Type*                copy      = allocator.allocate( count )        ;
+    
+    std::uninitialized_copy( source, source + count, copy ) ;
+    
+    return static_cast<void*>( copy ) ;
+  }
+  
+  template<class Type>
+  void Bus::releaseValues( void* values, unsigned count )
+  {
+    std::allocator<Type> allocator                                ;
+    Type*                copy      = static_cast<Type*>( values ) ;
+    
+    std::destroy_n( copy, count ) ;
+    allocator.deallocate( copy, count ) ;
+  }
+  
   template<class Type, bool Referenced, bool Indexed, bool HasValue>
   Bus::FunctionPublisher<Type, Referenced, Indexed, HasValue>::FunctionPublisher( FunctionPublisher::Callback callback )
   {
@@ -735,226 +2107,555 @@ namespace iris
   template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue>
   Bus::MethodPublisher<Object, Type, Referenced, Indexed, HasValue>::MethodPublisher( Object* obj, Bus::MethodPublisher<Object, Type, Referenced, Indexed, HasValue>::Callback callback )
   {
-    this->object   = obj      ;
-    this->callback = callback ; 
+    this->object   = obj      ;
+    this->callback = callback ; 
+  }
+  
+  template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue>
+  const void* Bus::MethodPublisher<Object, Type, Referenced, Indexed, HasValue>::publish( unsigned idx )
+  {
+    /** Note: Is this better to do than to just make different abstract classes for each specification? Surely the compiler figures this stuff out right? */
+    typedef Type        (Object::*Callback                  )(          ) ;
+    typedef Type        (Object::*IndexedCallback           )( unsigned ) ;
+    typedef const Type& (Object::*ReferencedCallback        )(          ) ;
+    typedef const Type& (Object::*IndexedReferencedCallback )( unsigned ) ;
+    typedef void        (Object::*VoidCallback              )(          ) ;
+    typedef void        (Object::*VoidIndexedCallback       )( unsigned ) ;
+    
+    static bool dummy = true ;
+    
+    if constexpr( !HasValue )
+    {
+      if constexpr( Indexed )
+      {
+        auto cb = reinterpret_cast<VoidIndexedCallback>( this->callback ) ;
+        ( ( ( this->object )->*( cb ) )( idx ) ) ;
+        return static_cast<const void*>( &dummy ) ;
+      }
+      else
+      {
+        auto cb = reinterpret_cast<VoidCallback>( this->callback ) ;
+       ( ( ( this->object )->*( cb ) )() ) ;
+        return static_cast<const void*>( &dummy ) ;
+      }
+    }
+    if( Referenced )
+    {
+      if( Indexed )
+      {
+        auto cb = reinterpret_cast<IndexedReferencedCallback>( this->callback ) ;
+        return static_cast<const void*>( &( ( ( this->object )->*( cb ) )( idx ) ) ) ;
+      }
+      else
+      {
+        auto cb = reinterpret_cast<ReferencedCallback>( this->callback ) ;
+        return static_cast<const void*>( &( ( ( this->object )->*( cb ) )() ) ) ;
+      }
+    }
+    else
+    {
+      if( Indexed )
+      {
+        auto cb = reinterpret_cast<IndexedCallback>( this->callback ) ;
+        this->local = ( ( ( this->object )->*( cb ) )( idx ) ) ;
+        
+        return static_cast<const void*>( &this->local ) ;
+      }
+      else
+      {
+        auto cb = reinterpret_cast<Callback>( this->callback ) ;
+        this->local = ( ( ( this->object )->*( cb ) )() ) ;
+        
+        return static_cast<const void*>( &this->local ) ;
+      }
+    }
+  }
+  
+  template<class Type, bool HasValue>
+  Bus::AsyncSubscriber<Type, HasValue>::AsyncSubscriber( const Delegate& delegate )
+  {
+    this->delegate = delegate ;
+    this->values   = nullptr  ;
+  }
+  
+  template<class Type, bool HasValue>
+  Bus::AsyncSubscriber<Type, HasValue>::~AsyncSubscriber()
+  {
+    delete[] this->values ;
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::AsyncSubscriber<Type, HasValue>::allocate( unsigned cells )
+  {
+    if constexpr( HasValue )
+    {
+      delete[] this->values ;
+      this->values = new Type[ cells ] ;
+    }
+    else
+    {
+      cells = cells ;
+    }
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::AsyncSubscriber<Type, HasValue>::store( unsigned cell, const void* pointer )
+  {
+    if constexpr( HasValue )
+    {
+      this->values[ cell ] = *static_cast<const Type*>( pointer ) ;
+    }
+    else
+    {
+      cell    = cell    ;
+      pointer = pointer ;
+    }
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::AsyncSubscriber<Type, HasValue>::move( unsigned cell, void* pointer )
+  {
+    if constexpr( HasValue )
+    {
+      this->values[ cell ] = std::move( *static_cast<Type*>( pointer ) ) ;
+    }
+    else
+    {
+      cell    = cell    ;
+      pointer = pointer ;
+    }
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::AsyncSubscriber<Type, HasValue>::deliver( unsigned cell, unsigned idx )
+  {
+    if constexpr( HasValue )
+    {
+      // The queued copy belongs to this mailbox alone, so subscribers that take ownership are handed it.
+      if( this->delegate.sink ) this->delegate.sink( this->delegate, static_cast<void*>( &this->values[ cell ] ), idx ) ;
+      else                      this->delegate.trampoline( this->delegate, static_cast<const void*>( &this->values[ cell ] ), idx ) ;
+      
+      // Let go of what the cell holds, so shared payloads return to their pool once delivered.
+      this->values[ cell ] = Type() ;
+    }
+    else
+    {
+      cell = cell ;
+      this->delegate.trampoline( this->delegate, nullptr, idx ) ;
+    }
+  }
+  
+  template<class Type>
+  Bus::AwaitedSubscriber<Type>::AwaitedSubscriber()
+  {
+    this->awaited = true    ;
+    this->index   = 0       ;
+    this->values  = nullptr ;
+  }
+  
+  template<class Type>
+  Bus::AwaitedSubscriber<Type>::~AwaitedSubscriber()
+  {
+    delete[] this->values ;
+  }
+  
+  template<class Type>
+  void Bus::AwaitedSubscriber<Type>::allocate( unsigned cells )
+  {
+    delete[] this->values ;
+    this->values = new Type[ cells ] ;
+  }
+  
+  template<class Type>
+  void Bus::AwaitedSubscriber<Type>::store( unsigned cell, const void* pointer )
+  {
+    this->values[ cell ] = *static_cast<const Type*>( pointer ) ;
+  }
+  
+  template<class Type>
+  void Bus::AwaitedSubscriber<Type>::move( unsigned cell, void* pointer )
+  {
+    this->values[ cell ] = std::move( *static_cast<Type*>( pointer ) ) ;
+  }
+  
+  template<class Type>
+  void Bus::AwaitedSubscriber<Type>::deliver( unsigned cell, unsigned idx )
+  {
+    this->current        = std::move( this->values[ cell ] ) ;
+    this->index          = idx                               ;
+    this->values[ cell ] = Type()                            ;
+  }
+  
+  template<class Type, bool HasValue>
+  Bus::LimitedSubscriber<Type, HasValue>::LimitedSubscriber( const Delegate& delegate, Limit limit, unsigned milliseconds ) : Limiter( delegate, limit, milliseconds )
+  {
+    this->values[ 0 ] = Type() ;
+    this->values[ 1 ] = Type() ;
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::LimitedSubscriber<Type, HasValue>::allocate( unsigned cells )
+  {
+    cells = cells ;
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::LimitedSubscriber<Type, HasValue>::store( unsigned cell, const void* pointer )
+  {
+    if constexpr( HasValue )
+    {
+      this->values[ cell ] = *static_cast<const Type*>( pointer ) ;
+    }
+    else
+    {
+      cell    = cell    ;
+      pointer = pointer ;
+    }
+  }
+  
+  template<class Type, bool HasValue>
+  void Bus::LimitedSubscriber<Type, HasValue>::deliver( unsigned cell, unsigned idx )
+  {
+    if constexpr( HasValue )
+    {
+      this->forward( static_cast<const void*>( &this->values[ cell ] ), idx ) ;
+      this->values[ cell ] = Type() ;
+    }
+    else
+    {
+      this->forward( nullptr, idx ) ;
+    }
   }
   
-  template<class Object, class Type, bool Referenced, bool Indexed, bool HasValue>
-  const void* Bus::MethodPublisher<Object, Type, Referenced, Indexed, HasValue>::publish( unsigned idx )
+  template<class Type, bool HasValue>
+  Bus::Delegate Bus::wrap( const Delegate& delegate, Requirement req, TopicId key )
   {
-    /** Note: Is this better to do than to just make different abstract classes for each specification? Surely the compiler figures this stuff out right? */
-    typedef Type        (Object::*Callback                  )(          ) ;
-    typedef Type        (Object::*IndexedCallback           )( unsigned ) ;
-    typedef const Type& (Object::*ReferencedCallback        )(          ) ;
-    typedef const Type& (Object::*IndexedReferencedCallback )( unsigned ) ;
-    typedef void        (Object::*VoidCallback              )(          ) ;
-    typedef void        (Object::*VoidIndexedCallback       )( unsigned ) ;
+    Delegate   wrapped = delegate           ;
+    const Rate rate    = this->rateOf( key ) ;
     
-    static bool dummy = true ;
-    
-    if constexpr( !HasValue )
+    // Only instantiate the cells for types that can fill them, so enrolling any other type still builds.
+    if constexpr( HasValue && !( std::is_default_constructible<Type>::value && std::is_copy_assignable<Type>::value ) )
     {
-      if constexpr( Indexed )
-      {
-        auto cb = reinterpret_cast<VoidIndexedCallback>( this->callback ) ;
-        ( ( ( this->object )->*( cb ) )( idx ) ) ;
-        return static_cast<const void*>( &dummy ) ;
-      }
-      else
-      {
-        auto cb = reinterpret_cast<VoidCallback>( this->callback ) ;
-       ( ( ( this->object )->*( cb ) )() ) ;
-        return static_cast<const void*>( &dummy ) ;
-      }
+      if( ( req & iris::ASYNC ) == iris::ASYNC || rate.limit != Limit::None ) Bus::reportUnqueued( key ) ;
     }
-    if( Referenced )
+    else
     {
-      if( Indexed )
+      if( ( req & iris::ASYNC ) == iris::ASYNC )
       {
-        auto cb = reinterpret_cast<IndexedReferencedCallback>( this->callback ) ;
-        return static_cast<const void*>( &( ( ( this->object )->*( cb ) )( idx ) ) ) ;
+        wrapped.object     = static_cast<void*>( static_cast<Mailbox*>( new AsyncSubscriber<Type, HasValue>( delegate ) ) ) ;
+        wrapped.trampoline = &Mailbox::call ;
+        wrapped.batch      = nullptr        ;
+        wrapped.sink       = &Mailbox::sink ;
       }
-      else
+      
+      if( rate.limit != Limit::None )
       {
-        auto cb = reinterpret_cast<ReferencedCallback>( this->callback ) ;
-        return static_cast<const void*>( &( ( ( this->object )->*( cb ) )() ) ) ;
+        wrapped.object     = static_cast<void*>( static_cast<Mailbox*>( new LimitedSubscriber<Type, HasValue>( wrapped, rate.limit, rate.milliseconds ) ) ) ;
+        wrapped.trampoline = &Limiter::call ;
+        wrapped.batch      = nullptr        ;
+        wrapped.sink       = nullptr        ;
       }
     }
-    else
+    
+    return wrapped ;
+  }
+  
+  template<typename ... Keys>
+  void Bus::limit( Limit limit, unsigned milliseconds, Keys... args )
+  {
+    this->limitBase( ::iris::intern( args... ), { limit, milliseconds } ) ;
+  }
+  
+  template<class Value>
+  Bus::Topic<Value>::Topic()
+  {
+    this->slot      = nullptr ;
+    this->key.value = 0       ;
+  }
+  
+  template<class Value>
+  void Bus::Topic<Value>::emit( const Value& value ) const
+  {
+    if( this->slot ) Bus::emitBase( this->slot, static_cast<const void*>( &value ), 0, Bus::retainer<Value>() ) ;
+  }
+  
+  template<class Value>
+  void Bus::Topic<Value>::emit( Value&& value ) const
+  {
+    if( this->slot ) Bus::emitMovedBase( this->slot, static_cast<void*>( &value ), 0, Bus::retainer<Value>() ) ;
+  }
+  
+  template<class Value>
+  void Bus::Topic<Value>::emitIndexed( const Value& value, unsigned idx ) const
+  {
+    if( this->slot ) Bus::emitBase( this->slot, static_cast<const void*>( &value ), idx, Bus::retainer<Value>() ) ;
+  }
+  
+  template<class Value>
+  void Bus::Topic<Value>::emitBatch( const Value* values, unsigned count, unsigned first ) const
+  {
+    if( this->slot ) Bus::emitBatchBase( this->slot, static_cast<const void*>( values ), sizeof( Value ), count, first, Bus::retainer<Value>() ) ;
+  }
+  
+  template<class Value>
+  TopicId Bus::Topic<Value>::id() const
+  {
+    return this->key ;
+  }
+  
+  template<class Value, typename ... Keys>
+  Bus::Topic<Value> Bus::topic( Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    Topic<Value>       handle ;
+    
+    handle.key  = ::iris::intern( args... )                   ;
+    handle.slot = Bus::resolve( handle.key, ctti.ctti_hash ) ;
+    
+    return handle ;
+  }
+  
+  template<class Value>
+  Bus::Stream<Value>::Stream()
+  {
+    this->executor = nullptr ;
+  }
+  
+  template<class Value>
+  typename Bus::Stream<Value>::Next Bus::Stream<Value>::next() const
+  {
+    Next awaitable ;
+    
+    awaitable.mailbox  = this->mailbox  ;
+    awaitable.executor = this->executor ;
+    awaitable.ready    = false          ;
+    
+    return awaitable ;
+  }
+  
+  template<class Value>
+  unsigned Bus::Stream<Value>::index() const
+  {
+    return this->mailbox.get() ? static_cast<AwaitedSubscriber<Value>*>( this->mailbox.get() )->index : 0 ;
+  }
+  
+  template<class Value>
+  bool Bus::Stream<Value>::Next::await_ready()
+  {
+    this->ready = this->mailbox.get()->take( false ) ;
+    return this->ready ;
+  }
+  
+  template<class Value>
+  template<class Handle>
+  bool Bus::Stream<Value>::Next::await_suspend( Handle handle )
+  {
+    return this->mailbox.get()->await( this->executor, &::iris::resumeCoroutine<Handle>, handle.address() ) ;
+  }
+  
+  template<class Value>
+  Value Bus::Stream<Value>::Next::await_resume()
+  {
+    // Resumed once data was queued, or never suspended as it was queued while suspending. Either way it is there.
+    if( !this->ready ) this->mailbox.get()->take( true ) ;
+    
+    return std::move( static_cast<AwaitedSubscriber<Value>*>( this->mailbox.get() )->current ) ;
+  }
+  
+  template<class Value, typename ... Keys>
+  Bus::Stream<Value> Bus::stream( Keys... args )
+  {
+    constexpr TypeInfo ctti   = typeinfo<Value>()          ;
+    const TopicId      key    = ::iris::intern( args... ) ;
+    Stream<Value>      handle                             ;
+    Delegate           sub    = {}                        ;
+    
+    handle.executor = this->executor()                                           ;
+    handle.mailbox  = MailboxHandle( this->findStream( key, ctti.ctti_hash ) ) ;
+    
+    if( handle.mailbox.get() == nullptr )
     {
-      if( Indexed )
-      {
-        auto cb = reinterpret_cast<IndexedCallback>( this->callback ) ;
-        this->local = ( ( ( this->object )->*( cb ) )( idx ) ) ;
-        
-        return static_cast<const void*>( &this->local ) ;
-      }
-      else
-      {
-        auto cb = reinterpret_cast<Callback>( this->callback ) ;
-        this->local = ( ( ( this->object )->*( cb ) )() ) ;
-        
-        return static_cast<const void*>( &this->local ) ;
-      }
+      Mailbox* mailbox = new AwaitedSubscriber<Value>() ;
+      
+      // One reference for the subscription, one for the handle.
+      mailbox->acquire() ;
+      handle.mailbox = MailboxHandle( mailbox ) ;
+      sub.object     = static_cast<void*>( mailbox ) ;
+      sub.trampoline = &Mailbox::call                ;
+      sub.sink       = &Mailbox::sink                ;
+      
+      this->enrollBase( key, sub, iris::OPTIONAL, ctti.ctti_hash ) ;
     }
+    
+    return handle ;
+  }
+  
+  template<class Value, typename ... Keys>
+  typename Bus::Stream<Value>::Next Bus::next( Keys... args )
+  {
+    return this->stream<Value>( args... ).next() ;
   }
   
   template<class Value, typename ... Keys>
   void Bus::emitIndexed( const Value& value, unsigned idx, Keys... args )
   {
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Key key ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     
-    key = ::iris::concatenate( "", args... ) ;
-    this->emitBase( key, static_cast<const void*>( &value ), ctti.ctti_hash, idx ) ;
+    this->emitBase( ::iris::intern( args... ), static_cast<const void*>( &value ), ctti.ctti_hash, idx, Bus::retainer<Value>() ) ;
   }
   
   template<class Value, typename ... Keys>
   void Bus::emit( const Value& value, Keys... args )
   {
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Key key ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    
+    this->emitBase( ::iris::intern( args... ), static_cast<const void*>( &value ), ctti.ctti_hash, 0, Bus::retainer<Value>() ) ;
+  }
+  
+  template<class Value, typename ... Keys, typename>
+  void Bus::emit( Value&& value, Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     
-    key = ::iris::concatenate( "", args... ) ;
-    this->emitBase( key, static_cast<const void*>( &value ), ctti.ctti_hash, 0 ) ;
+    this->emitMovedBase( ::iris::intern( args... ), static_cast<void*>( &value ), ctti.ctti_hash, 0, Bus::retainer<Value>() ) ;
   }
   
   template<typename ... Keys>
-  void Bus::enroll( void (*setter)(), Requirement req, Keys... args )
+  void Bus::pull( unsigned idx, Keys... args )
   {
-    typedef Bus::FunctionSubscriber<bool, false, false, false> Callback ;
-    Callback *callback ;
-    Key       key      ;
+    this->pullBase( ::iris::intern( args... ), idx ) ;
+  }
+  
+  template<class Value, typename ... Keys>
+  void Bus::emitBatch( const Value* values, unsigned count, unsigned first, Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     
-    callback = new Callback( reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    this->emitBatchBase( ::iris::intern( args... ), static_cast<const void*>( values ), sizeof( Value ), count, ctti.ctti_hash, first, Bus::retainer<Value>() ) ;
+  }
+  
+  template<typename ... Keys>
+  void Bus::enroll( void (*setter)(), Requirement req, Keys... args )
+  {
+    const TopicId key = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, dynamic_cast<Bus::Subscriber*>( callback ), req, UNIVERSAL_TYPE ) ;
+    this->enrollBase( key, this->wrap<bool, false>( Bus::function<bool, false, false>( setter ), req, key ), req, UNIVERSAL_TYPE ) ;
   }
   
   template<typename ... Keys, class Value>
   void Bus::enroll( void (*setter)( Value ), Requirement req, Keys... args )
   {
-    typedef Bus::FunctionSubscriber<Value, false, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    callback = new Callback( reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
-    
-    this->enrollBase( key, dynamic_cast<Bus::Subscriber*>( callback ), req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::function<Value, false, true, true>( setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Value>
   void Bus::enroll( void (*setter)( const Value& ), Requirement req, Keys... args )
   {
-    typedef Bus::FunctionSubscriber<Value, true, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    callback = new Callback( reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    this->enrollBase( key, this->wrap<Value>( Bus::function<Value, false>( setter ), req, key ), req, ctti.ctti_hash ) ;
+  }
+  
+  template<typename ... Keys, class Value>
+  void Bus::enroll( void (*setter)( Value&& ), Requirement req, Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, callback, req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::function<Value, false, true, true>( setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Value>
   void Bus::enroll( void (*setter)( unsigned, Value ), Requirement req, Keys... args )
   {
-    typedef Bus::FunctionSubscriber<Value, false, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
-    
-    callback = new Callback( reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, callback, req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::function<Value, true, true, true>( setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Value>
   void Bus::enroll( void (*setter)( unsigned, Value const & ), Requirement req, Keys... args )
   {
-    typedef Bus::FunctionSubscriber<Value, true, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    callback = new Callback( reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                      ;
+    this->enrollBase( key, this->wrap<Value>( Bus::function<Value, true>( setter ), req, key ), req, ctti.ctti_hash ) ;
+  }
+  
+  template<typename ... Keys, class Value>
+  void Bus::enroll( void (*setter)( const Value*, unsigned, unsigned ), Requirement req, Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, callback, req, ctti.ctti_hash) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::batchFunction<Value>( setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Object>
   void Bus::enroll( Object* obj, void (Object::*setter)(), Requirement req, Keys... args )
   {
-    typedef Bus::MethodSubscriber<Object, bool, false, false, false> Callback ;  
-    Callback *callback ;
-    Key       key      ;
+    const TopicId key = ::iris::intern( args... ) ;
     
-    callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
-    
-    this->enrollBase( key, callback, req, UNIVERSAL_TYPE ) ;
+    this->enrollBase( key, this->wrap<bool, false>( Bus::method<bool, false, false>( obj, setter ), req, key ), req, UNIVERSAL_TYPE ) ;
   }
   
   template<typename ... Keys, class Object, class Value>
   void Bus::enroll( Object* obj, void (Object::*setter)( Value ), Requirement req, Keys... args )
   {
-    typedef Bus::MethodSubscriber<Object, Value, false, false> Callback ;  
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
-    
-    this->enrollBase( key, callback, req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::method<Value, false, true, true>( obj, setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Object, class Value>
   void Bus::enroll( Object* obj, void (Object::*setter)( Value const & ), Requirement req, Keys... args )
   {
-    typedef Bus::MethodSubscriber<Object, Value, true, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    this->enrollBase( key, this->wrap<Value>( Bus::method<Value, false>( obj, setter ), req, key ), req, ctti.ctti_hash ) ;
+  }
+  
+  template<typename ... Keys, class Object, class Value>
+  void Bus::enroll( Object* obj, void (Object::*setter)( Value&& ), Requirement req, Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, callback, req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::method<Value, false, true, true>( obj, setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Object, class Value>
   void Bus::enroll( Object* obj, void (Object::*setter)( unsigned, Value ), Requirement req, Keys... args )
   {
-    typedef Bus::MethodSubscriber<Object, Value, false, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
-    
-    callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, callback, req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::method<Value, true, true, true>( obj, setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys, class Object, class Value>
   void Bus::enroll( Object* obj, void (Object::*setter)( unsigned, Value const & ), Requirement req, Keys... args )
   {
-    typedef Bus::MethodSubscriber<Object, Value, true, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
-    Callback *callback ;
-    Key       key      ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( setter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    this->enrollBase( key, this->wrap<Value>( Bus::method<Value, true>( obj, setter ), req, key ), req, ctti.ctti_hash ) ;
+  }
+  
+  template<typename ... Keys, class Object, class Value>
+  void Bus::enroll( Object* obj, void (Object::*setter)( const Value*, unsigned, unsigned ), Requirement req, Keys... args )
+  {
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
+    const TopicId      key  = ::iris::intern( args... ) ;
     
-    this->enrollBase( key, callback, req, ctti.ctti_hash ) ;
+    this->enrollBase( key, this->wrap<Value>( Bus::batchMethod<Value>( obj, setter ), req, key ), req, ctti.ctti_hash ) ;
   }
   
   template<typename ... Keys>
@@ -962,10 +2663,10 @@ namespace iris
   {
     typedef Bus::FunctionPublisher<bool, false, false, false> Callback ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, this->UNIVERSAL_TYPE ) ;
   }
@@ -974,12 +2675,12 @@ namespace iris
   void Bus::publish( Value (*getter)(), Keys... args )
   {
     typedef Bus::FunctionPublisher<Value, false, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -988,12 +2689,12 @@ namespace iris
   void Bus::publish( const Value& (*getter)(), Keys... args )
   {
     typedef Bus::FunctionPublisher<Value, true, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -1002,12 +2703,12 @@ namespace iris
   void Bus::publish( Value (*getter)( unsigned ), Keys... args )
   {
     typedef Bus::FunctionPublisher<Value, false, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -1016,12 +2717,12 @@ namespace iris
   void Bus::publish( const Value& (*getter)( unsigned ), Keys... args )
   {
     typedef Bus::FunctionPublisher<Value, true, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                     ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -1031,10 +2732,10 @@ namespace iris
   {
     typedef Bus::MethodPublisher<Object, bool, false, false, false> Callback ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                           ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, this->UNIVERSAL_TYPE ) ;
   }
@@ -1043,12 +2744,12 @@ namespace iris
   void Bus::publish( Object* obj, Value (Object::*getter)(), Keys... args )
   {
     typedef Bus::MethodPublisher<Object, Value, false, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -1057,12 +2758,12 @@ namespace iris
   void Bus::publish( Object* obj, const Value& (Object::*getter)(), Keys... args )
   {
     typedef Bus::MethodPublisher<Object, Value, true, false> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -1071,12 +2772,12 @@ namespace iris
   void Bus::publish( Object* obj, Value (Object::*getter)( unsigned ), Keys... args )
   {
     typedef Bus::MethodPublisher<Object, Value, false, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
@@ -1085,14 +2786,218 @@ namespace iris
   void Bus::publish( Object* obj, const Value& (Object::*getter)( unsigned ), Keys... args )
   {
     typedef Bus::MethodPublisher<Object, Value, true, true> Callback ;
-    const TypeInfo ctti = typeinfo<Value>() ;
+    constexpr TypeInfo ctti = typeinfo<Value>() ;
     Callback *callback ;
-    Key       key      ;
+    TopicId   key      ;
     
     callback = new Callback( obj, reinterpret_cast<typename Callback::Callback>( getter ) ) ;
-    key      = ::iris::concatenate( "", args... )                                          ;
+    key      = ::iris::intern( args... ) ;
     
     this->enrollBase( key, callback, ctti.ctti_hash ) ;
   }
+  
+  template<class Value>
+  Bus::Reply<Value>::Reply()
+  {
+    this->state    = nullptr ;
+    this->executor = nullptr ;
+  }
+  
+  template<class Value>
+  Bus::Reply<Value>::Reply( const Reply& reply )
+  {
+    this->state    = reply.state    ;
+    this->executor = reply.executor ;
+    
+    if( this->state ) this->state->acquire() ;
+  }
+  
+  template<class Value>
+  Bus::Reply<Value>& Bus::Reply<Value>::operator=( const Reply& reply )
+  {
+    if( reply.state ) reply.state->acquire() ;
+    if( this->state ) this->state->release() ;
+    
+    this->state    = reply.state    ;
+    this->executor = reply.executor ;
+    
+    return *this ;
+  }
+  
+  template<class Value>
+  Bus::Reply<Value>::~Reply()
+  {
+    if( this->state ) this->state->release() ;
+  }
+  
+  template<class Value>
+  bool Bus::Reply<Value>::ready() const
+  {
+    return this->state && this->state->ready() ;
+  }
+  
+  template<class Value>
+  bool Bus::Reply<Value>::answered() const
+  {
+    return this->state && this->state->answered() ;
+  }
+  
+  template<class Value>
+  bool Bus::Reply<Value>::wait( unsigned milliseconds ) const
+  {
+    return this->state && this->state->wait( milliseconds ) ;
+  }
+  
+  template<class Value>
+  const Value& Bus::Reply<Value>::get() const
+  {
+    static const Value empty = Value() ;
+    
+    if( this->state == nullptr ) return empty ;
+    
+    this->state->wait() ;
+    return this->state->answered() ? this->state->value : empty ;
+  }
+  
+  template<class Value>
+  bool Bus::Reply<Value>::await_ready() const
+  {
+    return this->state == nullptr || this->state->ready() ;
+  }
+  
+  template<class Value>
+  template<class Handle>
+  bool Bus::Reply<Value>::await_suspend( Handle handle )
+  {
+    return this->state->await( this->executor, &::iris::resumeCoroutine<Handle>, handle.address() ) ;
+  }
+  
+  template<class Value>
+  Value Bus::Reply<Value>::await_resume() const
+  {
+    return this->state && this->state->answered() ? this->state->value : Value() ;
+  }
+  
+  template<class Request, class Response>
+  Bus::Envelope<Request, Response>::Envelope()
+  {
+    this->reply = nullptr ;
+  }
+  
+  template<class Request, class Response>
+  Bus::Envelope<Request, Response>::Envelope( const Envelope& envelope )
+  {
+    this->request = envelope.request ;
+    this->reply   = envelope.reply   ;
+    
+    if( this->reply ) this->reply->acquireRequest() ;
+  }
+  
+  template<class Request, class Response>
+  Bus::Envelope<Request, Response>& Bus::Envelope<Request, Response>::operator=( const Envelope& envelope )
+  {
+    if( envelope.reply ) envelope.reply->acquireRequest() ;
+    if( this->reply    ) this->reply->releaseRequest()    ;
+    
+    this->request = envelope.request ;
+    this->reply   = envelope.reply   ;
+    
+    return *this ;
+  }
+  
+  template<class Request, class Response>
+  Bus::Envelope<Request, Response>::~Envelope()
+  {
+    // The last copy failing an unclaimed request covers requests shed by a full queue or dropped with their mailbox.
+    if( this->reply ) this->reply->releaseRequest() ;
+  }
+  
+  template<class Request, class Response, class Object, class Callback>
+  void Bus::callServer( const Delegate& delegate, const void* pointer, unsigned idx )
+  {
+    const auto& envelope = *static_cast<const Envelope<Request, Response>*>( pointer ) ;
+    
+    idx = idx ;
+    
+    if( envelope.reply == nullptr || !envelope.reply->claim() ) return ;
+    
+    // The request is claimed, so a throwing server has to finish it here or the caller waits forever.
+    try
+    {
+      if constexpr( std::is_void<Object>::value )
+      {
+        envelope.reply->value = ( delegate.callable.load<Callback>() )( envelope.request ) ;
+      }
+      else
+      {
+        envelope.reply->value = ( static_cast<Object*>( delegate.object )->*( delegate.callable.load<Callback>() ) )( envelope.request ) ;
+      }
+    }
+    catch( ... )
+    {
+      envelope.reply->complete( false ) ;
+      throw ;
+    }
+    
+    envelope.reply->complete( true ) ;
+  }
+  
+  template<class Response, class Request, typename ... Keys>
+  Bus::Reply<Response> Bus::request( const Request& request, Keys... args )
+  {
+    constexpr TypeInfo ctti  = typeinfo<Envelope<Request, Response>>() ;
+    Reply<Response>    reply                                           ;
+    
+    reply.state    = new ReplyValue<Response>() ;
+    reply.executor = this->executor()           ;
+    
+    {
+      Envelope<Request, Response> envelope ;
+      
+      envelope.request = request     ;
+      envelope.reply   = reply.state ;
+      envelope.reply->acquireRequest() ;
+      
+      // Never retained, as a late server would answer a request that is long finished.
+      this->emitBase( ::iris::intern( args... ), static_cast<const void*>( &envelope ), ctti.ctti_hash, 0, Retainer{ nullptr, nullptr } ) ;
+    }
+    
+    // If nothing answered or queued the request, dropping the envelope above already finished it unanswered.
+    
+    return reply ;
+  }
+  
+  template<typename ... Keys, class Request, class Response>
+  void Bus::serve( Response (*server)( const Request& ), Requirement req, Keys... args )
+  {
+    using Type     = Envelope<Request, Response> ;
+    using Callback = Response (*)( const Request& ) ;
+    
+    constexpr TypeInfo ctti     = typeinfo<Type>()          ;
+    const TopicId      key      = ::iris::intern( args... ) ;
+    Delegate           delegate = {}                        ;
+    
+    delegate.object     = nullptr                                             ;
+    delegate.trampoline = &Bus::callServer<Request, Response, void, Callback> ;
+    delegate.callable.store<Callback>( server ) ;
+    
+    this->enrollBase( key, this->wrap<Type>( delegate, req, key ), req, ctti.ctti_hash ) ;
+  }
+  
+  template<typename ... Keys, class Object, class Request, class Response>
+  void Bus::serve( Object* obj, Response (Object::*server)( const Request& ), Requirement req, Keys... args )
+  {
+    using Type     = Envelope<Request, Response> ;
+    using Callback = Response (Object::*)( const Request& ) ;
+    
+    constexpr TypeInfo ctti     = typeinfo<Type>()          ;
+    const TopicId      key      = ::iris::intern( args... ) ;
+    Delegate           delegate = {}                        ;
+    
+    delegate.object     = static_cast<void*>( obj )                             ;
+    delegate.trampoline = &Bus::callServer<Request, Response, Object, Callback> ;
+    delegate.callable.store<Callback>( server ) ;
+    
+    this->enrollBase( key, this->wrap<Type>( delegate, req, key ), req, ctti.ctti_hash ) ;
+  }
 }
-
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Conversion.h"
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace iris
+{
+  /** Structure to contain every registered conversion, by the hash of the type it converts into.
+   */
+  struct ConversionRegistry
+  {
+    std::mutex                                                        lock    ; ///< Lock for the entries.
+    std::unordered_map<unsigned, std::vector<const ConversionEntry*>> entries ; ///< The conversions, by the hash of the type they convert into.
+  };
+  
+  /** Function to retrieve the process-wide conversion registry.
+   * @return Reference to the conversion registry.
+   */
+  static ConversionRegistry& conversions()
+  {
+    // Intentionally never released, as buses may enroll while the program is shutting down.
+    static ConversionRegistry* reg = new ConversionRegistry() ;
+    return *reg ;
+  }
+  
+  std::vector<const ConversionEntry*> findConversions( unsigned type_id )
+  {
+    ConversionRegistry&          reg  = conversions()               ;
+    std::scoped_lock<std::mutex> lock( reg.lock )                   ;
+    auto                         iter = reg.entries.find( type_id ) ;
+    
+    return iter != reg.entries.end() ? iter->second : std::vector<const ConversionEntry*>() ;
+  }
+  
+  void registerConversionBase( const ConversionEntry& entry )
+  {
+    ConversionRegistry&          reg  = conversions()                     ;
+    std::scoped_lock<std::mutex> lock( reg.lock )                         ;
+    auto&                        list = reg.entries[ entry.to.ctti_hash ] ;
+    
+    for( auto registered : list )
+    {
+      if( registered == &entry ) return ;
+      
+      // The same pair may be instantiated by more than one library, so only a different type with the same hash is worth mentioning.
+      if( registered->from.ctti_hash == entry.from.ctti_hash )
+      {
+        if( std::string( registered->from.ctti_name, registered->from.ctti_length ) != std::string( entry.from.ctti_name, entry.from.ctti_length ) )
+        {
+          std::cout << "Iris Conversion: Type '" << std::string( entry.from.ctti_name, entry.from.ctti_length ) << "' has the same hash as '"
+                    << std::string( registered->from.ctti_name, registered->from.ctti_length ) << "' and can not be converted from." << std::endl ;
+        }
+        
+        return ;
+      }
+    }
+    
+    list.push_back( &entry ) ;
+  }
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace iris
+{
+  /** Traits to convert one type of data into another, so subscriptions can recieve data published as a different type.
+   * Numbers are converted between each other with a cast, written into std::string with std::to_string and parsed back out of strings.
+   * Any other pair of types can be converted by specializing this with the same member:
+   *
+   *   E.g.  template<>
+   *         struct iris::Converter<Celsius, Kelvin>
+   *         {
+   *           static Kelvin convert( const Celsius& value ) ;
+   *         };
+   *
+   * @note A pair is only used once registered with iris::registerConversion.
+   */
+  template<class From, class To, typename Enable = void>
+  struct Converter ;
+  
+  /** Converter between numbers, which is a single cast.
+   * @note Floating point numbers that do not fit the destination type are clamped to it's range, and NaN converts to 0 for integers.
+   *       Integers wrap between integer types, like any cast.
+   */
+  template<class From, class To>
+  struct Converter<From, To, std::enable_if_t<std::is_arithmetic<From>::value && std::is_arithmetic<To>::value>>
+  {
+    /** Static method to convert a value.
+     * @param value The value to convert.
+     * @return The converted value.
+     */
+    static To convert( const From& value ) ;
+  };
+  
+  /** Converter of numbers into strings.
+   */
+  template<class From>
+  struct Converter<From, std::string, std::enable_if_t<std::is_arithmetic<From>::value>>
+  {
+    static std::string convert( const From& value ) ;
+  };
+  
+  /** Converter of strings into numbers. See iris::parseNumber.
+   */
+  template<class To>
+  struct Converter<std::string, To, std::enable_if_t<std::is_arithmetic<To>::value>>
+  {
+    static To convert( const std::string& value ) ;
+  };
+  
+  /** Converter of C-strings into numbers. See iris::parseNumber.
+   */
+  template<class To>
+  struct Converter<const char*, To, std::enable_if_t<std::is_arithmetic<To>::value>>
+  {
+    static To convert( const char* const& value ) ;
+  };
+  
+  /** Function to parse a number out of a string, the way converters read strings.
+   * Strings that do not start with a number convert to 0. bool also reads "true" and "false".
+   * @param str The string to parse. nullptr converts to 0.
+   * @return The number.
+   */
+  template<class To>
+  To parseNumber( const char* str ) ;
+  
+  /** Type-erased conversion between one pair of types, for the bus to route data between them.
+   */
+  struct ConversionEntry
+  {
+    TypeInfo                  from       ; ///< The type info of the type published, as made by iris::typeinfo.
+    TypeInfo                  to         ; ///< The type info of the type subscribed to, as made by iris::typeinfo.
+    Bus::Delegate::Trampoline trampoline ; ///< Converts the published data and hands it to the delegate the calling delegate's object points to.
+  };
+  
+  /** Function to add the conversion between a pair of types to the process-wide registry.
+   * Subscriptions to @To enrolled afterwards also recieve data published as @From, converted once per emit.
+   * The conversion is resolved when subscribing, so emitting costs the same single look up as data of the subscribed type.
+   *
+   *   E.g.  iris::registerConversion<float, double>() ;
+   *         bus.enroll( &setDouble, iris::OPTIONAL, "imu::rate" ) ;
+   *         bus.emit( 0.5f, "imu::rate" ) ; // setDouble recieves 0.5.
+   *
+   * @note Registering a pair more than once is harmless. Subscriptions enrolled before registering are not affected, and neither are wildcard subscriptions.
+   * @return The type-erased conversion.
+   */
+  template<class From, class To>
+  const ConversionEntry& registerConversion() ;
+  
+  /** Function to register the conversions between every pair of a set of types, in both directions.
+   *
+   *   E.g.  iris::registerConversions<int, float, double, std::string>() ;
+   */
+  template<class ... Types>
+  void registerConversions() ;
+  
+  /** Function to register the conversions from one type to each of a set of types.
+   */
+  template<class From, class ... Types>
+  void registerConversionsFrom() ;
+  
+  /** Function to find every conversion into a type.
+   * @param type_id The hash of the type subscribed to, as made by iris::typeinfo.
+   * @return The conversions into the type, in the order they were registered.
+   */
+  std::vector<const ConversionEntry*> findConversions( unsigned type_id ) ;
+  
+  /** Function to add a type-erased conversion to the process-wide registry.
+   * @param entry The conversion. Must outlive the program, as it is referenced rather than copied.
+   */
+  void registerConversionBase( const ConversionEntry& entry ) ;
+  
+  template<class From, class To>
+  To Converter<From, To, std::enable_if_t<std::is_arithmetic<From>::value && std::is_arithmetic<To>::value>>::convert( const From& value )
+  {
+    // Casting a floating point number the destination can not hold is undefined, so those are clamped first.
+    if constexpr( std::is_floating_point<From>::value && std::is_integral<To>::value && !std::is_same<To, bool>::value )
+    {
+      if( std::isnan( value )                                           ) return To()                              ;
+      if( value <= static_cast<From>( std::numeric_limits<To>::lowest() ) ) return std::numeric_limits<To>::lowest() ;
+      if( value >= static_cast<From>( std::numeric_limits<To>::max()    ) ) return std::numeric_limits<To>::max()    ;
+    }
+    else if constexpr( std::is_floating_point<From>::value && std::is_floating_point<To>::value && sizeof( To ) < sizeof( From ) )
+    {
+      if( std::isfinite( value ) && value < static_cast<From>( std::numeric_limits<To>::lowest() ) ) return std::numeric_limits<To>::lowest() ;
+      if( std::isfinite( value ) && value > static_cast<From>( std::numeric_limits<To>::max()    ) ) return std::numeric_limits<To>::max()    ;
+    }
+    
+    return static_cast<To>( value ) ;
+  }
+  
+  template<class From>
+  std::string Converter<From, std::string, std::enable_if_t<std::is_arithmetic<From>::value>>::convert( const From& value )
+  {
+    return std::to_string( value ) ;
+  }
+  
+  template<class To>
+  To Converter<std::string, To, std::enable_if_t<std::is_arithmetic<To>::value>>::convert( const std::string& value )
+  {
+    return parseNumber<To>( value.c_str() ) ;
+  }
+  
+  template<class To>
+  To Converter<const char*, To, std::enable_if_t<std::is_arithmetic<To>::value>>::convert( const char* const& value )
+  {
+    return parseNumber<To>( value ) ;
+  }
+  
+  template<class To>
+  To parseNumber( const char* str )
+  {
+    if( str == nullptr ) return To() ;
+    
+    if constexpr( std::is_same<To, bool>::value )
+    {
+      if( std::string( str ) == "true"  ) return true  ;
+      if( std::string( str ) == "false" ) return false ;
+      
+      return std::strtoll( str, nullptr, 10 ) != 0 ;
+    }
+    else if constexpr( std::is_floating_point<To>::value )
+    {
+      return Converter<double, To>::convert( std::strtod( str, nullptr ) ) ;
+    }
+    else if constexpr( std::is_signed<To>::value )
+    {
+      return static_cast<To>( std::strtoll( str, nullptr, 10 ) ) ;
+    }
+    else
+    {
+      return static_cast<To>( std::strtoull( str, nullptr, 10 ) ) ;
+    }
+  }
+  
+  template<class From, class To>
+  const ConversionEntry& registerConversion()
+  {
+    static const ConversionEntry entry =
+    {
+      typeinfo<From>(),
+      typeinfo<To>(),
+      []( const Bus::Delegate& delegate, const void* pointer, unsigned idx )
+      {
+        const Bus::Delegate& target = *static_cast<const Bus::Delegate*>( delegate.object ) ;
+        To                   value  = Converter<From, To>::convert( *static_cast<const From*>( pointer ) ) ;
+        
+        // The converted value is a temporary of it's own, so subscribers that take ownership are handed it.
+        if( target.sink ) target.sink      ( target, static_cast<void*>( &value ), idx ) ;
+        else              target.trampoline( target, static_cast<const void*>( &value ), idx ) ;
+      }
+    };
+    
+    registerConversionBase( entry ) ;
+    return entry ;
+  }
+  
+  template<class ... Types>
+  void registerConversions()
+  {
+    ( registerConversionsFrom<Types, Types...>(), ... ) ;
+  }
+  
+  template<class From, class ... Types>
+  void registerConversionsFrom()
+  {
+    ( []()
+    {
+      if constexpr( !std::is_same<From, Types>::value ) registerConversion<From, Types>() ;
+    }(), ... ) ;
+  }
+}
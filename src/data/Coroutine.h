@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+#include "Executor.h"
+
+// Only compiled in as C++20. Configure with -DCOROUTINES=ON to build the library that way.
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+  #include <coroutine>
+  #include <exception>
+
+  #define IRIS_COROUTINES 1
+#endif
+
+#ifdef IRIS_COROUTINES
+namespace iris
+{
+  /** Return type of a coroutine that runs on it's own once called, like a lightweight module pipeline.
+   * The coroutine runs on the calling thread until it first suspends, and afterwards on whichever thread resumes it.
+   * It's frame is released once it finishes.
+   *
+   *   E.g.  iris::Task pipeline( iris::Bus& bus, iris::Executor& executor )
+   *         {
+   *           co_await executor.schedule() ;
+   *
+   *           while( true )
+   *           {
+   *             const Frame frame = co_await bus.next<Frame>( "camera::frame" ) ;
+   *             bus.emit( process( frame ), "camera::processed" ) ;
+   *           }
+   *         }
+   *
+   * @note Exceptions that escape the coroutine terminate the program, as there is nobody left to rethrow them to.
+   */
+  class Task
+  {
+    public:
+      struct promise_type
+      {
+        Task               get_return_object()          { return Task() ;    }
+        std::suspend_never initial_suspend()            { return {} ;        }
+        std::suspend_never final_suspend() noexcept     { return {} ;        }
+        void               return_void()                {                    }
+        void               unhandled_exception()        { std::terminate() ; }
+      };
+  };
+}
+#endif
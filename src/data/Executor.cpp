@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Executor.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace iris
+{
+  /** Structure to contain an Executor's data.
+   */
+  struct ExecutorData
+  {
+    using Queue = std::deque<std::pair<Executor::Task, void*>> ;
+    
+    Queue                    queue   ; ///< The tasks waiting to run, with their arguments.
+    std::vector<std::thread> threads ; ///< The threads started by start.
+    mutable std::mutex       lock    ; ///< Lock for the queue.
+    std::condition_variable  cv      ; ///< Wakes threads once a task is posted or they are stopped.
+    bool                     running ; ///< Whether or not the threads should keep running tasks.
+    
+    /** Constructor.
+     */
+    ExecutorData() ;
+    
+    /** Method run by each thread started by start.
+     */
+    void work() ;
+  };
+  
+  ExecutorData::ExecutorData()
+  {
+    this->running = false ;
+  }
+  
+  void ExecutorData::work()
+  {
+    std::unique_lock<std::mutex> lock( this->lock ) ;
+    
+    while( true )
+    {
+      this->cv.wait( lock, [this] () { return !this->running || !this->queue.empty() ; } ) ;
+      
+      if( !this->running ) return ;
+      
+      const auto task = this->queue.front() ;
+      this->queue.pop_front() ;
+      
+      lock.unlock() ;
+      task.first( task.second ) ;
+      lock.lock() ;
+    }
+  }
+  
+  Executor::Executor()
+  {
+    this->executor_data = new ExecutorData() ;
+  }
+  
+  Executor::~Executor()
+  {
+    this->stop() ;
+    delete this->executor_data ;
+  }
+  
+  void Executor::post( Task task, void* argument )
+  {
+    {
+      std::scoped_lock<std::mutex> lock( data().lock ) ;
+      data().queue.emplace_back( task, argument ) ;
+    }
+    
+    data().cv.notify_one() ;
+  }
+  
+  unsigned Executor::run()
+  {
+    ExecutorData::Queue tasks ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( data().lock ) ;
+      tasks.swap( data().queue ) ;
+    }
+    
+    for( auto& task : tasks ) task.first( task.second ) ;
+    
+    return static_cast<unsigned>( tasks.size() ) ;
+  }
+  
+  void Executor::start( unsigned threads )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    
+    data().running = true ;
+    
+    for( unsigned index = 0; index < threads; index++ )
+    {
+      data().threads.emplace_back( &ExecutorData::work, &data() ) ;
+    }
+  }
+  
+  void Executor::stop()
+  {
+    std::vector<std::thread> threads ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( data().lock ) ;
+      
+      data().running = false ;
+      threads.swap( data().threads ) ;
+    }
+    
+    data().cv.notify_all() ;
+    
+    for( auto& thread : threads ) thread.join() ;
+  }
+  
+  unsigned Executor::pending() const
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    return static_cast<unsigned>( data().queue.size() ) ;
+  }
+  
+  Executor::Schedule Executor::schedule()
+  {
+    Schedule schedule ;
+    
+    schedule.executor = this ;
+    return schedule ;
+  }
+  
+  ExecutorData& Executor::data()
+  {
+    return *this->executor_data ;
+  }
+  
+  const ExecutorData& Executor::data() const
+  {
+    return *this->executor_data ;
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace iris
+{
+  /** Function to resume a suspended coroutine from it's address.
+   * @note Lets code that is built without coroutine support hold on to a coroutine as a plain function & pointer.
+   * @param address The address of the coroutine, as made by it's handle.
+   */
+  template<class Handle>
+  void resumeCoroutine( void* address ) ;
+  
+  /** Class to run small tasks on a shared pool of threads, or on whichever thread runs it.
+   * Mostly used to resume coroutines awaiting bus data, so that many of them can share a few threads instead of one thread each.
+   *
+   *   E.g.  iris::Executor executor ;
+   *         executor.start( 2 ) ;
+   *         bus.setExecutor( &executor ) ; // Coroutines awaiting this bus's data now resume on the executor's threads.
+   *
+   * @note Tasks run in the order they were posted, but with more than one thread, tasks may run at the same time.
+   */
+  class Executor
+  {
+    public:
+      using Task = void (*)( void* argument ) ;
+      
+      /** Awaitable that moves the awaiting coroutine onto an executor.
+       *
+       *   E.g.  co_await executor.schedule() ; // Everything after this runs on the executor.
+       */
+      class Schedule
+      {
+        public:
+          bool await_ready() const { return false ; }
+          void await_resume() const {}
+          
+          template<class Handle>
+          void await_suspend( Handle handle ) const ;
+        
+        private:
+          friend class Executor ;
+          
+          Executor* executor ;
+      };
+      
+      /** Default constructor. No threads run tasks until start is called.
+       */
+      Executor() ;
+      
+      /** Deconstructor. Stops every thread. Tasks still queued are not run.
+       */
+      ~Executor() ;
+      
+      /** Method to queue a task to run.
+       * @note Safe to call from any thread, including from a running task.
+       * @param task The function to run.
+       * @param argument The argument to run the function with.
+       */
+      void post( Task task, void* argument ) ;
+      
+      /** Method to run every task queued so far on the calling thread.
+       * @note Tasks posted while running are left for the next call, so a task re-posting itself can not starve the caller.
+       * @return The amount of tasks run.
+       */
+      unsigned run() ;
+      
+      /** Method to start threads that run tasks as they are posted.
+       * @param threads The amount of threads to run.
+       */
+      void start( unsigned threads = 1 ) ;
+      
+      /** Method to stop the threads started by start, once they finish the task they are running.
+       */
+      void stop() ;
+      
+      /** Method to retrieve the amount of tasks waiting to run.
+       * @return The amount of tasks queued.
+       */
+      unsigned pending() const ;
+      
+      /** Method to make an awaitable that moves the awaiting coroutine onto this executor.
+       * @return The awaitable.
+       */
+      Schedule schedule() ;
+    
+    private:
+      struct ExecutorData* executor_data ;
+      ExecutorData& data() ;
+      const ExecutorData& data() const ;
+  };
+  
+  template<class Handle>
+  void resumeCoroutine( void* address )
+  {
+    Handle::from_address( address ).resume() ;
+  }
+  
+  template<class Handle>
+  void Executor::Schedule::await_suspend( Handle handle ) const
+  {
+    this->executor->post( &::iris::resumeCoroutine<Handle>, handle.address() ) ;
+  }
+}
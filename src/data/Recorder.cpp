@@ -0,0 +1,634 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Recorder.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace iris
+{
+  static constexpr std::uint32_t LOG_MAGIC    = 0x49524c47 ; ///< Marks a file as a segment of a log.
+  static constexpr std::uint32_t LOG_VERSION  = 1          ; ///< The version of the log layout.
+  static constexpr std::uint32_t RECORD_ALIGN = 16         ; ///< The alignment of every record, so data can be emitted straight out of the log.
+  static constexpr std::uint32_t TOPIC_RECORD = 1          ; ///< Set in a record's flags when it holds a topic name instead of data.
+  static constexpr double        MAX_DELAY    = 1e18       ; ///< The longest a replay waits for a record in nanoseconds, so slow replays stay in range of the clock.
+  
+  /** Structure at the start of every segment file.
+   */
+  struct LogHeader
+  {
+    std::uint32_t              magic    ; ///< LOG_MAGIC.
+    std::uint32_t              version  ; ///< LOG_VERSION.
+    std::uint64_t              capacity ; ///< The size of the segment.
+    std::atomic<std::uint64_t> used     ; ///< The amount of the segment given out. May pass @capacity once the segment is full.
+    std::uint64_t              reserved ; ///< Pads the header to the record alignment.
+  };
+  
+  /** Structure at the start of every record, followed by the data.
+   */
+  struct RecordHeader
+  {
+    std::atomic<std::uint32_t> size    ; ///< The size of the record, header and padding included. 0 until the record is complete.
+    std::uint32_t              flags   ; ///< TOPIC_RECORD for topic names.
+    std::uint64_t              time    ; ///< The time of the emit in nanoseconds, on the recorder's steady clock.
+    std::uint32_t              topic   ; ///< The recorder's id of the topic.
+    std::uint32_t              type_id ; ///< The hash of the type of data.
+    std::uint32_t              idx     ; ///< The index the data was emitted with.
+    std::uint32_t              length  ; ///< The length of the data.
+  };
+  
+  static_assert( sizeof( LogHeader    ) % RECORD_ALIGN == 0, "Records must start aligned." ) ;
+  static_assert( sizeof( RecordHeader ) % RECORD_ALIGN == 0, "Record data must start aligned." ) ;
+  
+  /** Structure to contain a single mapped segment file.
+   */
+  struct LogSegment
+  {
+    char*      base   ; ///< The start of the mapping.
+    LogHeader* header ; ///< The header of the segment.
+    size_t     length ; ///< The length of the mapping.
+    int        fd     ; ///< The file of the segment.
+  };
+  
+  /** Structure to contain a recorded topic.
+   */
+  struct RecordTopic
+  {
+    struct RecorderData*      recorder ; ///< The recorder the topic is recorded by.
+    TopicId                   topic    ; ///< The topic.
+    std::uint32_t             type_id  ; ///< The hash of the type of data.
+    std::uint32_t             size     ; ///< The size of the type of data.
+    mutable std::atomic<bool> warned   ; ///< Whether or not dropping the topic's data was reported already.
+  };
+  
+  /** Structure to contain a Recorder's data.
+   */
+  struct RecorderData
+  {
+    iris::Bus                       bus          ; ///< The bus to enroll writers on.
+    std::string                     path         ; ///< The path of the log.
+    size_t                          segment_size ; ///< The size of each segment file.
+    std::atomic<LogSegment*>        current      ; ///< The segment being appended to.
+    std::vector<LogSegment*>        segments     ; ///< Every segment of the log. Guarded by @lock.
+    std::vector<RecordWriter*>      writers      ; ///< The writers of every recorded topic. Guarded by @lock.
+    std::mutex                      lock         ; ///< Lock for adding segments & writers.
+    std::atomic<unsigned>           active       ; ///< The amount of writers appending right now.
+    std::atomic<bool>               recording    ; ///< Whether or not writers may append.
+    std::atomic<unsigned long long> count        ; ///< The amount of data recorded.
+    
+    /** Constructor.
+     */
+    RecorderData() ;
+    
+    /** Method to reserve room for records at the end of the log, moving on to a new segment when the current one is full.
+     * @param size The amount of room.
+     * @return Pointer to the room, or nullptr if there is none.
+     */
+    char* reserve( size_t size ) ;
+    
+    /** Method to move on to a new segment. Only the first caller for a full segment makes one.
+     * @param full The segment that ran out of room.
+     * @return The segment to append to now, or nullptr if one could not be made.
+     */
+    LogSegment* roll( LogSegment* full ) ;
+    
+    /** Method to trim & close every segment.
+     */
+    void close() ;
+  };
+  
+  /** Structure to contain a Replayer's data.
+   */
+  struct ReplayerData
+  {
+    iris::Bus                                   bus      ; ///< The bus to emit over.
+    std::vector<LogSegment*>                    segments ; ///< Every segment of the log.
+    std::unordered_map<std::uint32_t, TopicId> topics   ; ///< The local topic of each of the recorder's topic ids.
+    double                                      speed    ; ///< The speed to replay at, or 0 for as fast as possible.
+    
+    /** Constructor.
+     */
+    ReplayerData() ;
+    
+    /** Method to close every segment.
+     */
+    void close() ;
+  };
+  
+  /** Function to round a size up to the record alignment.
+   * @param size The size.
+   * @return The aligned size.
+   */
+  static size_t alignRecord( size_t size )
+  {
+    return ( size + RECORD_ALIGN - 1 ) / RECORD_ALIGN * RECORD_ALIGN ;
+  }
+  
+  /** Function to make the name of a segment file.
+   * @param path The path of the log.
+   * @param index The number of the segment.
+   * @return The name of the segment file.
+   */
+  static std::string segmentFile( const std::string& path, size_t index )
+  {
+    return path + "." + std::to_string( index ) ;
+  }
+  
+  /** Function to retrieve the time records are stamped with.
+   * @return The time in nanoseconds.
+   */
+  static std::uint64_t recordTime()
+  {
+    return static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ) ;
+  }
+  
+#ifdef __linux__
+  /** Function to make a new, empty segment file and map it.
+   * @param name The name of the file. Any file there is replaced.
+   * @param size The size of the segment.
+   * @return The segment, or nullptr if it could not be made.
+   */
+  static LogSegment* createSegment( const std::string& name, size_t size )
+  {
+    LogSegment* segment = nullptr ;
+    void*       memory  = nullptr ;
+    const int   fd      = ::open( name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 ) ;
+    
+    if( fd < 0 ) return nullptr ;
+    
+    if( ::ftruncate( fd, static_cast<off_t>( size ) ) != 0 || ( memory = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) ) == MAP_FAILED )
+    {
+      ::close( fd ) ;
+      return nullptr ;
+    }
+    
+    segment         = new LogSegment()                       ;
+    segment->base   = static_cast<char*>( memory )           ;
+    segment->header = reinterpret_cast<LogHeader*>( memory ) ;
+    segment->length = size                                   ;
+    segment->fd     = fd                                     ;
+    
+    segment->header->magic    = LOG_MAGIC           ;
+    segment->header->version  = LOG_VERSION         ;
+    segment->header->capacity = size                ;
+    segment->header->used     = sizeof( LogHeader ) ;
+    
+    return segment ;
+  }
+  
+  /** Function to map an existing segment file to read.
+   * @param name The name of the file.
+   * @return The segment, or nullptr if it does not exist or is not a segment.
+   */
+  static LogSegment* openSegment( const std::string& name )
+  {
+    struct stat info          ;
+    LogSegment* segment = nullptr ;
+    void*       memory  = nullptr ;
+    const int   fd      = ::open( name.c_str(), O_RDONLY | O_CLOEXEC ) ;
+    
+    if( fd < 0 ) return nullptr ;
+    
+    if( ::fstat( fd, &info ) != 0 || static_cast<size_t>( info.st_size ) < sizeof( LogHeader ) || ( memory = ::mmap( nullptr, static_cast<size_t>( info.st_size ), PROT_READ, MAP_SHARED, fd, 0 ) ) == MAP_FAILED )
+    {
+      ::close( fd ) ;
+      return nullptr ;
+    }
+    
+    segment         = new LogSegment()                       ;
+    segment->base   = static_cast<char*>( memory )           ;
+    segment->header = reinterpret_cast<LogHeader*>( memory ) ;
+    segment->length = static_cast<size_t>( info.st_size )    ;
+    segment->fd     = fd                                     ;
+    
+    if( segment->header->magic != LOG_MAGIC || segment->header->version != LOG_VERSION )
+    {
+      std::cout << "Iris Replayer: '" << name << "' is not a log segment this version can read." << std::endl ;
+      ::munmap( memory, segment->length ) ;
+      ::close( fd ) ;
+      delete segment ;
+      return nullptr ;
+    }
+    
+    return segment ;
+  }
+  
+  /** Function to unmap & close a segment.
+   * @param segment The segment.
+   * @param trim Whether or not to cut the file down to the part given out.
+   */
+  static void closeSegment( LogSegment* segment, bool trim )
+  {
+    const std::uint64_t used = segment->header->used.load() ;
+    const std::uint64_t size = used < segment->length ? used : segment->length ;
+    
+    ::munmap( static_cast<void*>( segment->base ), segment->length ) ;
+    if( trim ) static_cast<void>( ::ftruncate( segment->fd, static_cast<off_t>( size ) ) ) ;
+    ::close( segment->fd ) ;
+    
+    delete segment ;
+  }
+  
+  /** Function to remove a file.
+   * @param name The name of the file.
+   * @return Whether or not there was a file to remove.
+   */
+  static bool removeFile( const std::string& name )
+  {
+    return ::unlink( name.c_str() ) == 0 ;
+  }
+#else
+  static LogSegment* createSegment( const std::string&, size_t )
+  {
+    std::cout << "Iris Recorder: Memory-mapped logs are only supported on Linux." << std::endl ;
+    return nullptr ;
+  }
+  
+  static LogSegment* openSegment ( const std::string&  ) { return nullptr ; }
+  static void        closeSegment( LogSegment*, bool   ) {}
+  static bool        removeFile  ( const std::string&  ) { return false   ; }
+#endif
+  
+  RecorderData::RecorderData()
+  {
+    this->segment_size = Recorder::DEFAULT_SEGMENT ;
+    this->current      = nullptr                   ;
+    this->active       = 0                         ;
+    this->recording    = false                     ;
+    this->count        = 0                         ;
+  }
+  
+  char* RecorderData::reserve( size_t size )
+  {
+    LogSegment*   segment = this->current.load( std::memory_order_acquire ) ;
+    std::uint64_t offset  = 0                                               ;
+    
+    if( size > this->segment_size - sizeof( LogHeader ) ) return nullptr ;
+    
+    while( segment != nullptr )
+    {
+      offset = segment->header->used.fetch_add( size, std::memory_order_relaxed ) ;
+      
+      if( offset + size <= segment->length ) return segment->base + offset ;
+      
+      segment = this->roll( segment ) ;
+    }
+    
+    return nullptr ;
+  }
+  
+  LogSegment* RecorderData::roll( LogSegment* full )
+  {
+    std::scoped_lock<std::mutex> lock( this->lock ) ;
+    LogSegment*                  segment = this->current.load() ;
+    
+    if( segment != full ) return segment ;
+    
+    segment = createSegment( segmentFile( this->path, this->segments.size() ), this->segment_size ) ;
+    
+    if( segment == nullptr )
+    {
+      std::cout << "Iris Recorder: Unable to make segment " << this->segments.size() << " of '" << this->path << "'. Recording stopped." << std::endl ;
+      this->recording = false ;
+    }
+    else
+    {
+      this->segments.push_back( segment ) ;
+    }
+    
+    this->current.store( segment, std::memory_order_release ) ;
+    return segment ;
+  }
+  
+  void RecorderData::close()
+  {
+    std::scoped_lock<std::mutex> lock( this->lock ) ;
+    
+    for( auto segment : this->segments ) closeSegment( segment, true ) ;
+    
+    this->segments.clear() ;
+    this->current = nullptr ;
+  }
+  
+  ReplayerData::ReplayerData()
+  {
+    this->speed = 1.0 ;
+  }
+  
+  void ReplayerData::close()
+  {
+    for( auto segment : this->segments ) closeSegment( segment, false ) ;
+    
+    this->segments.clear() ;
+  }
+  
+  void RecordWriter::writeBase( const void* values, unsigned count, unsigned first )
+  {
+    const RecordTopic&  topic    = *this->topic                                              ;
+    RecorderData&       recorder = *topic.recorder                                           ;
+    const char*         bytes    = static_cast<const char*>( values )                        ;
+    const size_t        stride   = alignRecord( sizeof( RecordHeader ) + topic.size )        ;
+    const size_t        fits     = ( recorder.segment_size - sizeof( LogHeader ) ) / stride ;
+    const std::uint64_t time     = recordTime()                                              ;
+    char*               memory   = nullptr                                                   ;
+    unsigned            done     = 0                                                         ;
+    unsigned            chunk    = 0                                                         ;
+    
+    // The time is taken before reserving, so a record this thread reserves later is never stamped earlier.
+    
+    // Counted before checking, so stop() can wait out every writer that saw the recorder running.
+    recorder.active.fetch_add( 1, std::memory_order_seq_cst ) ;
+    
+    if( recorder.recording.load( std::memory_order_seq_cst ) )
+    {
+      if( fits == 0 && !topic.warned.exchange( true ) )
+      {
+        std::cout << "Iris Recorder: Data of '" << iris::topicName( topic.topic ) << "' is larger than a segment of '" << recorder.path << "'. It is not recorded." << std::endl ;
+      }
+      
+      // Batches larger than a segment are split across segments.
+      for( done = 0; fits != 0 && done < count; done += chunk )
+      {
+        chunk  = static_cast<unsigned>( std::min<size_t>( count - done, fits ) ) ;
+        memory = recorder.reserve( stride * chunk )                               ;
+        
+        if( memory == nullptr ) break ;
+        
+        for( unsigned index = 0; index < chunk; index++ )
+        {
+          RecordHeader* record = reinterpret_cast<RecordHeader*>( memory + stride * index ) ;
+          
+          record->flags   = 0                        ;
+          record->time    = time                     ;
+          record->topic   = topic.topic.value        ;
+          record->type_id = topic.type_id            ;
+          record->idx     = first + done + index     ;
+          record->length  = topic.size               ;
+          std::memcpy( static_cast<void*>( record + 1 ), bytes + static_cast<size_t>( done + index ) * topic.size, topic.size ) ;
+          
+          record->size.store( static_cast<std::uint32_t>( stride ), std::memory_order_release ) ;
+        }
+        
+        recorder.count.fetch_add( chunk, std::memory_order_relaxed ) ;
+      }
+    }
+    
+    recorder.active.fetch_sub( 1, std::memory_order_release ) ;
+  }
+  
+  Recorder::Recorder()
+  {
+    this->recorder_data = new RecorderData() ;
+  }
+  
+  Recorder::~Recorder()
+  {
+    this->stop() ;
+    delete this->recorder_data ;
+  }
+  
+  bool Recorder::initialize( const char* path, unsigned segment_size )
+  {
+    LogSegment* segment = nullptr ;
+    
+    this->stop() ;
+    
+    data().path         = path         ;
+    data().segment_size = segment_size ;
+    data().count        = 0            ;
+    
+    // Segments left over from a longer log would be replayed after this one.
+    for( size_t index = 0; removeFile( segmentFile( data().path, index ) ); index++ ) {} ;
+    
+    segment = createSegment( segmentFile( data().path, 0 ), data().segment_size ) ;
+    
+    if( segment == nullptr )
+    {
+      std::cout << "Iris Recorder: Unable to make a log at '" << path << "'." << std::endl ;
+      return false ;
+    }
+    
+    data().segments.push_back( segment ) ;
+    data().current   = segment ;
+    data().recording = true    ;
+    
+    return true ;
+  }
+  
+  RecordWriter* Recorder::recordBase( TopicId topic, unsigned type_id, unsigned size )
+  {
+    const char*   name   = iris::topicName( topic )                                              ;
+    const size_t  length = std::strlen( name )                                                  ;
+    char*         memory = nullptr                                                              ;
+    RecordTopic*  record = nullptr                                                              ;
+    RecordWriter* writer = nullptr                                                              ;
+    
+    if( !data().recording.load() ) return nullptr ;
+    
+    // The name is logged, as ids are only meaningful inside this process.
+    memory = data().reserve( alignRecord( sizeof( RecordHeader ) + length ) ) ;
+    
+    if( memory != nullptr )
+    {
+      RecordHeader* header = reinterpret_cast<RecordHeader*>( memory ) ;
+      
+      header->flags   = TOPIC_RECORD                          ;
+      header->time    = recordTime()                          ;
+      header->topic   = topic.value                           ;
+      header->type_id = type_id                               ;
+      header->idx     = 0                                     ;
+      header->length  = static_cast<std::uint32_t>( length ) ;
+      std::memcpy( static_cast<void*>( header + 1 ), name, length ) ;
+      
+      header->size.store( static_cast<std::uint32_t>( alignRecord( sizeof( RecordHeader ) + length ) ), std::memory_order_release ) ;
+    }
+    
+    record           = new RecordTopic() ;
+    record->recorder = &data()           ;
+    record->topic    = topic             ;
+    record->type_id  = type_id           ;
+    record->size     = size              ;
+    record->warned   = false             ;
+    writer           = new RecordWriter() ;
+    writer->topic    = record            ;
+    
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    data().writers.push_back( writer ) ;
+    
+    return writer ;
+  }
+  
+  unsigned long long Recorder::count() const
+  {
+    return data().count.load() ;
+  }
+  
+  void Recorder::stop()
+  {
+    data().recording.store( false, std::memory_order_seq_cst ) ;
+    
+    while( data().active.load( std::memory_order_seq_cst ) != 0 ) std::this_thread::yield() ;
+    
+    data().bus.clearSubscriptions() ;
+    data().close() ;
+    
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    
+    for( auto writer : data().writers )
+    {
+      delete writer->topic ;
+      delete writer        ;
+    }
+    
+    data().writers.clear() ;
+  }
+  
+  RecorderData& Recorder::data()
+  {
+    return *this->recorder_data ;
+  }
+  
+  const RecorderData& Recorder::data() const
+  {
+    return *this->recorder_data ;
+  }
+  
+  Bus& Recorder::bus()
+  {
+    return data().bus ;
+  }
+  
+  Replayer::Replayer()
+  {
+    this->replayer_data = new ReplayerData() ;
+  }
+  
+  Replayer::~Replayer()
+  {
+    data().close() ;
+    delete this->replayer_data ;
+  }
+  
+  bool Replayer::initialize( const char* path )
+  {
+    LogSegment* segment = nullptr ;
+    
+    data().close() ;
+    
+    for( size_t index = 0; ( segment = openSegment( segmentFile( path, index ) ) ) != nullptr; index++ )
+    {
+      data().segments.push_back( segment ) ;
+    }
+    
+    if( data().segments.empty() ) std::cout << "Iris Replayer: No log found at '" << path << "'." << std::endl ;
+    
+    return !data().segments.empty() ;
+  }
+  
+  void Replayer::setSpeed( double speed )
+  {
+    data().speed = speed ;
+  }
+  
+  unsigned long long Replayer::replay()
+  {
+    static const Bus::Retainer NO_RETAINER = { nullptr, nullptr } ;
+    
+    using Clock = std::chrono::steady_clock ;
+    
+    Clock::time_point  start   = Clock::now() ;
+    std::uint64_t      first   = 0            ;
+    bool               started = false        ;
+    unsigned long long count   = 0            ;
+    
+    data().topics.clear() ;
+    
+    for( auto segment : data().segments )
+    {
+      const std::uint64_t used   = segment->header->used.load() ;
+      const std::uint64_t end    = used < segment->length ? used : segment->length ;
+      std::uint64_t       offset = sizeof( LogHeader ) ;
+      
+      while( offset + sizeof( RecordHeader ) <= end )
+      {
+        const RecordHeader* record  = reinterpret_cast<const RecordHeader*>( segment->base + offset ) ;
+        const std::uint32_t size    = record->size.load( std::memory_order_acquire )                  ;
+        const char*         payload = reinterpret_cast<const char*>( record + 1 )                     ;
+        
+        // Never finished, as the recorder stopped part way through it. Nothing after it in this segment was either.
+        if( size == 0 || offset + size > end ) break ;
+        
+        offset += size ;
+        
+        if( record->flags & TOPIC_RECORD )
+        {
+          data().topics[ record->topic ] = iris::intern( std::string( payload, record->length ).c_str() ) ;
+          continue ;
+        }
+        
+        auto topic = data().topics.find( record->topic ) ;
+        if( topic == data().topics.end() ) continue ;
+        
+        if( data().speed > 0.0 )
+        {
+          if( !started )
+          {
+            first   = record->time ;
+            start   = Clock::now() ;
+            started = true         ;
+          }
+          
+          // Emits racing each other can be logged a little out of time order. Those are replayed straight away.
+          const double elapsed = record->time > first ? static_cast<double>( record->time - first ) / data().speed : 0.0 ;
+          
+          std::this_thread::sleep_until( start + std::chrono::nanoseconds( static_cast<long long>( std::min( elapsed, MAX_DELAY ) ) ) ) ;
+        }
+        
+        data().bus.emitBase( topic->second, static_cast<const void*>( payload ), record->type_id, record->idx, NO_RETAINER ) ;
+        count++ ;
+      }
+    }
+    
+    return count ;
+  }
+  
+  ReplayerData& Replayer::data()
+  {
+    return *this->replayer_data ;
+  }
+  
+  const ReplayerData& Replayer::data() const
+  {
+    return *this->replayer_data ;
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+#include <type_traits>
+
+namespace iris
+{
+  /** Object that appends the data of one topic and type to a Recorder's log.
+   * @note Made and owned by a Recorder. Only exists so the recorder can enroll it on it's bus.
+   */
+  class RecordWriter
+  {
+    public:
+      /** Method to append a batch of data to the log.
+       * @param values The data to append.
+       * @param count The amount of data.
+       * @param first The index of the first value.
+       */
+      template<class Value>
+      void write( const Value* values, unsigned count, unsigned first ) ;
+
+    private:
+      friend class Recorder ;
+
+      struct RecordTopic* topic ;
+
+      /** Method to append type-erased data to the log.
+       * @param values The data to append.
+       * @param count The amount of data.
+       * @param first The index of the first value.
+       */
+      void writeBase( const void* values, unsigned count, unsigned first ) ;
+  };
+
+  /** Class to capture the traffic of a set of topics into a memory-mapped, append-only log.
+   * The log is split into fixed size segment files named <path>.0, <path>.1, ... Each emit becomes a record of
+   * ( timestamp, topic id, type hash, index, bytes ), reserved with a single atomic add and filled with a single copy.
+   *
+   *   E.g.  iris::Recorder recorder ;
+   *         recorder.initialize( "/tmp/run" ) ;
+   *         recorder.record<float>( "camera::gain" ) ;
+   *         ...
+   *         recorder.stop() ;
+   *
+   * @note Only trivially-copyable data can be recorded, as it is copied byte for byte.
+   */
+  class Recorder
+  {
+    public:
+      static constexpr unsigned DEFAULT_SEGMENT = 64u << 20 ; ///< The default size of a segment file in bytes.
+
+      /** Default constructor.
+       */
+      Recorder() ;
+
+      /** Deconstructor. Stops recording.
+       */
+      ~Recorder() ;
+
+      /** Method to start a new log, replacing any log at the same path.
+       * @param path The path of the log. Segment files are made by appending their number to it.
+       * @param segment_size The size of each segment file in bytes.
+       * @return Whether or not the first segment could be made.
+       */
+      bool initialize( const char* path, unsigned segment_size = DEFAULT_SEGMENT ) ;
+
+      /** Method to append all data emitted over a topic to the log.
+       * @param args The arguments that make up the name of the topic.
+       */
+      template<class Value, typename ... Keys>
+      void record( Keys... args ) ;
+
+      /** Method to retrieve the amount of data recorded so far.
+       * @return The amount of records.
+       */
+      unsigned long long count() const ;
+
+      /** Method to stop recording, and trim & close every segment file.
+       */
+      void stop() ;
+
+    private:
+      /** Method to make a writer for a topic & type, and log the topic's name.
+       * @param topic The topic.
+       * @param type_id The hash of the type of data.
+       * @param size The size of the type of data.
+       * @return The writer to enroll, or nullptr if this object is not recording.
+       */
+      RecordWriter* recordBase( TopicId topic, unsigned type_id, unsigned size ) ;
+
+      struct RecorderData* recorder_data ;
+      RecorderData& data() ;
+      const RecorderData& data() const ;
+
+      /** Method to retrieve the bus this object subscribes with.
+       * @return Reference to the bus.
+       */
+      Bus& bus() ;
+  };
+
+  /** Class to re-emit the traffic captured by a Recorder.
+   * Records are emitted through the bus in the order they were made, straight out of the mapped log, as any type of data.
+   *
+   *   E.g.  iris::Replayer replayer ;
+   *         replayer.initialize( "/tmp/run" ) ;
+   *         replayer.setSpeed( 2.0 ) ; // Twice as fast as it was recorded.
+   *         replayer.replay() ;
+   *
+   * @note Replayed data is not kept by retained topics, as there is no type to copy it with.
+   */
+  class Replayer
+  {
+    public:
+      /** Default constructor.
+       */
+      Replayer() ;
+
+      /** Deconstructor. Closes the log.
+       */
+      ~Replayer() ;
+
+      /** Method to open a log made by a Recorder.
+       * @param path The path the log was recorded with.
+       * @return Whether or not the log had any segments.
+       */
+      bool initialize( const char* path ) ;
+
+      /** Method to set how fast the log is replayed.
+       * @param speed 1 for the speed it was recorded at, above 1 to speed it up, below 1 to slow it down, or 0 to replay as fast as possible.
+       */
+      void setSpeed( double speed ) ;
+
+      /** Method to emit every record in the log on the calling thread, waiting between them as set by setSpeed.
+       * @return The amount of data emitted.
+       */
+      unsigned long long replay() ;
+
+    private:
+      struct ReplayerData* replayer_data ;
+      ReplayerData& data() ;
+      const ReplayerData& data() const ;
+  };
+
+  template<class Value>
+  void RecordWriter::write( const Value* values, unsigned count, unsigned first )
+  {
+    this->writeBase( static_cast<const void*>( values ), count, first ) ;
+  }
+
+  template<class Value, typename ... Keys>
+  void Recorder::record( Keys... args )
+  {
+    static_assert( std::is_trivially_copyable<Value>::value, "Only trivially-copyable data can be recorded." ) ;
+
+    const TopicId topic  = ::iris::intern( args... ) ;
+    RecordWriter* writer = this->recordBase( topic, typeinfo<Value>().ctti_hash, sizeof( Value ) ) ;
+
+    if( writer ) this->bus().enroll( writer, &RecordWriter::write<Value>, iris::OPTIONAL, topic ) ;
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Serializer.h"
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace iris
+{
+  /** Structure to contain every registered serializer, by the hash of it's type.
+   */
+  struct SerializerRegistry
+  {
+    std::mutex                                             lock    ; ///< Lock for the entries.
+    std::unordered_map<unsigned, const SerializerEntry*> entries ; ///< The serializers, by the hash of their type.
+  };
+  
+  /** Function to retrieve the process-wide serializer registry.
+   * @return Reference to the serializer registry.
+   */
+  static SerializerRegistry& serializers()
+  {
+    // Intentionally never released, as transports may look up types while the program is shutting down.
+    static SerializerRegistry* reg = new SerializerRegistry() ;
+    return *reg ;
+  }
+  
+  /** Function to register the serializers every transport can count on, once.
+   */
+  static void registerDefaults()
+  {
+    static const bool registered = []()
+    {
+      registerSerializer<bool       >() ;
+      registerSerializer<int        >() ;
+      registerSerializer<unsigned   >() ;
+      registerSerializer<float      >() ;
+      registerSerializer<double     >() ;
+      registerSerializer<std::string>() ;
+      return true ;
+    }() ;
+    
+    static_cast<void>( registered ) ;
+  }
+  
+  const SerializerEntry* findSerializer( unsigned type_id )
+  {
+    SerializerRegistry& reg = serializers() ;
+    
+    registerDefaults() ;
+    
+    std::scoped_lock<std::mutex> lock( reg.lock ) ;
+    auto                         iter = reg.entries.find( type_id ) ;
+    
+    return iter != reg.entries.end() ? iter->second : nullptr ;
+  }
+  
+  void registerSerializerBase( const SerializerEntry& entry )
+  {
+    SerializerRegistry&          reg  = serializers() ;
+    std::scoped_lock<std::mutex> lock( reg.lock )     ;
+    auto                         iter = reg.entries.emplace( entry.type.ctti_hash, &entry ).first ;
+    
+    if( iter->second != &entry && std::string( iter->second->type.ctti_name, iter->second->type.ctti_length ) != std::string( entry.type.ctti_name, entry.type.ctti_length ) )
+    {
+      std::cout << "Iris Serializer: Type '" << std::string( entry.type.ctti_name, entry.type.ctti_length ) << "' has the same hash as '"
+                << std::string( iter->second->type.ctti_name, iter->second->type.ctti_length ) << "' and can not be found by it." << std::endl ;
+    }
+  }
+}
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace iris
+{
+  /** Traits to turn a type of data into bytes and back, for carrying it outside of the process.
+   * Trivially-copyable types are copied byte for byte. std::string and std::vector are written as a 32-bit length followed by their contents.
+   * Any other type can be carried by specializing this with the same members:
+   *
+   *   E.g.  template<>
+   *         struct iris::Serializer<Path>
+   *         {
+   *           static constexpr bool trivial = false ;
+   *           static unsigned size ( const Path& value                                   ) ;
+   *           static unsigned write( const Path& value, unsigned char* out               ) ;
+   *           static unsigned read ( Path& value, const unsigned char* in, unsigned length ) ;
+   *         };
+   *
+   * @note Bytes are in the host's byte order, so both ends must share it as well as the layout of trivial types.
+   */
+  template<class Value, typename Enable = void>
+  struct Serializer ;
+  
+  /** Serializer of trivially-copyable types, which is a single copy of the value.
+   */
+  template<class Value>
+  struct Serializer<Value, std::enable_if_t<std::is_trivially_copyable<Value>::value>>
+  {
+    static constexpr bool trivial = true ; ///< Whether or not the bytes are the value itself, so transports may copy it directly.
+    
+    /** Static method to retrieve the amount of bytes a value is written as.
+     * @param value The value.
+     * @return The size of the value in bytes.
+     */
+    static constexpr unsigned size( const Value& value ) ;
+    
+    /** Static method to write a value.
+     * @param value The value to write.
+     * @param out The bytes to write to. Must hold at least size( value ) bytes.
+     * @return The amount of bytes written.
+     */
+    static unsigned write( const Value& value, unsigned char* out ) ;
+    
+    /** Static method to read a value.
+     * @param value The value to read into.
+     * @param in The bytes to read from.
+     * @param length The amount of bytes available.
+     * @return The amount of bytes read, or 0 if there were not enough.
+     */
+    static unsigned read( Value& value, const unsigned char* in, unsigned length ) ;
+  };
+  
+  /** Serializer of strings, as their length followed by their characters.
+   */
+  template<>
+  struct Serializer<std::string>
+  {
+    static constexpr bool trivial = false ;
+    
+    static unsigned size ( const std::string& value                                     ) ;
+    static unsigned write( const std::string& value, unsigned char* out                 ) ;
+    static unsigned read ( std::string& value, const unsigned char* in, unsigned length ) ;
+  };
+  
+  /** Serializer of vectors, as their length followed by each element.
+   * Vectors of trivially-copyable elements are written & read with a single copy.
+   */
+  template<class Value, class Allocator>
+  struct Serializer<std::vector<Value, Allocator>>
+  {
+    static constexpr bool trivial = false ;
+    
+    static unsigned size ( const std::vector<Value, Allocator>& value                                     ) ;
+    static unsigned write( const std::vector<Value, Allocator>& value, unsigned char* out                 ) ;
+    static unsigned read ( std::vector<Value, Allocator>& value, const unsigned char* in, unsigned length ) ;
+    
+    private:
+      /** Whether or not the elements are stored contiguously as themselves. Not so for std::vector<bool>.
+       */
+      static constexpr bool contiguous = Serializer<Value>::trivial && !std::is_same<Value, bool>::value ;
+  };
+  
+  /** Type-erased serializer of one type of data, for code that only knows the type's hash.
+   */
+  struct SerializerEntry
+  {
+    using Size  = unsigned (*)( const void* value                                                            ) ;
+    using Write = unsigned (*)( const void* value, unsigned char* out                                        ) ;
+    using Read  = unsigned (*)( void* value, const unsigned char* in, unsigned length                         ) ;
+    using Emit  = unsigned (*)( Bus& bus, TopicId topic, const unsigned char* in, unsigned length, unsigned idx ) ;
+    
+    TypeInfo type    ; ///< The type info of the type, as made by iris::typeinfo.
+    bool     trivial ; ///< Whether or not the bytes are the value itself.
+    Size     size    ; ///< Retrieves the amount of bytes a value is written as.
+    Write    write   ; ///< Writes a value. Returns the amount of bytes written.
+    Read     read    ; ///< Reads into an existing value of the type. Returns the amount of bytes read, or 0 on failure.
+    Emit     emit    ; ///< Reads a value and emits it over a bus with an index. Returns the amount of bytes read, or 0 on failure, in which case nothing is emitted.
+  };
+  
+  /** Function to add the serializer of a type to the process-wide registry, so it can be found by the type's hash.
+   * @note Registering a type more than once is harmless. bool, int, unsigned, float, double and std::string are always registered.
+   * @return The type-erased serializer of the type.
+   */
+  template<class Value>
+  const SerializerEntry& registerSerializer() ;
+  
+  /** Function to find the serializer of a type by it's hash.
+   * @param type_id The hash of the type, as made by iris::typeinfo.
+   * @return The serializer of the type, or nullptr if it was never registered.
+   */
+  const SerializerEntry* findSerializer( unsigned type_id ) ;
+  
+  /** Function to add a type-erased serializer to the process-wide registry.
+   * @param entry The serializer. Must outlive the program, as it is referenced rather than copied.
+   */
+  void registerSerializerBase( const SerializerEntry& entry ) ;
+  
+  /** Function to write the 32-bit length that prefixes strings & vectors.
+   * @param length The length.
+   * @param out The bytes to write to.
+   */
+  inline void writeLength( std::uint32_t length, unsigned char* out )
+  {
+    std::copy_n( reinterpret_cast<const unsigned char*>( &length ), sizeof( std::uint32_t ), out ) ;
+  }
+  
+  /** Function to read the 32-bit length that prefixes strings & vectors.
+   * @param in The bytes to read from. Must hold at least 4 bytes.
+   * @return The length.
+   */
+  inline std::uint32_t readLength( const unsigned char* in )
+  {
+    std::uint32_t length = 0 ;
+    
+    std::copy_n( in, sizeof( std::uint32_t ), reinterpret_cast<unsigned char*>( &length ) ) ;
+    return length ;
+  }
+  
+  template<class Value>
+  constexpr unsigned Serializer<Value, std::enable_if_t<std::is_trivially_copyable<Value>::value>>::size( const Value& )
+  {
+    return sizeof( Value ) ;
+  }
+  
+  template<class Value>
+  unsigned Serializer<Value, std::enable_if_t<std::is_trivially_copyable<Value>::value>>::write( const Value& value, unsigned char* out )
+  {
+    std::copy_n( reinterpret_cast<const unsigned char*>( &value ), sizeof( Value ), out ) ;
+    return sizeof( Value ) ;
+  }
+  
+  template<class Value>
+  unsigned Serializer<Value, std::enable_if_t<std::is_trivially_copyable<Value>::value>>::read( Value& value, const unsigned char* in, unsigned length )
+  {
+    if( length < sizeof( Value ) ) return 0 ;
+    
+    std::copy_n( in, sizeof( Value ), reinterpret_cast<unsigned char*>( &value ) ) ;
+    return sizeof( Value ) ;
+  }
+  
+  inline unsigned Serializer<std::string>::size( const std::string& value )
+  {
+    return static_cast<unsigned>( sizeof( std::uint32_t ) + value.size() ) ;
+  }
+  
+  inline unsigned Serializer<std::string>::write( const std::string& value, unsigned char* out )
+  {
+    writeLength( static_cast<std::uint32_t>( value.size() ), out ) ;
+    std::copy_n( value.data(), value.size(), out + sizeof( std::uint32_t ) ) ;
+    
+    return Serializer<std::string>::size( value ) ;
+  }
+  
+  inline unsigned Serializer<std::string>::read( std::string& value, const unsigned char* in, unsigned length )
+  {
+    std::uint32_t count = 0 ;
+    
+    if( length < sizeof( std::uint32_t ) ) return 0 ;
+    
+    count = readLength( in ) ;
+    if( count > length - sizeof( std::uint32_t ) ) return 0 ;
+    
+    value.assign( reinterpret_cast<const char*>( in + sizeof( std::uint32_t ) ), count ) ;
+    return static_cast<unsigned>( sizeof( std::uint32_t ) + count ) ;
+  }
+  
+  template<class Value, class Allocator>
+  unsigned Serializer<std::vector<Value, Allocator>>::size( const std::vector<Value, Allocator>& value )
+  {
+    unsigned amount = sizeof( std::uint32_t ) ;
+    
+    if constexpr( Serializer<std::vector<Value, Allocator>>::contiguous )
+    {
+      amount += static_cast<unsigned>( value.size() * sizeof( Value ) ) ;
+    }
+    else
+    {
+      for( const auto& element : value ) amount += Serializer<Value>::size( element ) ;
+    }
+    
+    return amount ;
+  }
+  
+  template<class Value, class Allocator>
+  unsigned Serializer<std::vector<Value, Allocator>>::write( const std::vector<Value, Allocator>& value, unsigned char* out )
+  {
+    unsigned offset = sizeof( std::uint32_t ) ;
+    
+    writeLength( static_cast<std::uint32_t>( value.size() ), out ) ;
+    
+    if constexpr( Serializer<std::vector<Value, Allocator>>::contiguous )
+    {
+      std::copy_n( reinterpret_cast<const unsigned char*>( value.data() ), value.size() * sizeof( Value ), out + offset ) ;
+      offset += static_cast<unsigned>( value.size() * sizeof( Value ) ) ;
+    }
+    else
+    {
+      for( const auto& element : value ) offset += Serializer<Value>::write( element, out + offset ) ;
+    }
+    
+    return offset ;
+  }
+  
+  template<class Value, class Allocator>
+  unsigned Serializer<std::vector<Value, Allocator>>::read( std::vector<Value, Allocator>& value, const unsigned char* in, unsigned length )
+  {
+    std::uint32_t count  = 0                       ;
+    unsigned      offset = sizeof( std::uint32_t ) ;
+    
+    if( length < sizeof( std::uint32_t ) ) return 0 ;
+    
+    count = readLength( in ) ;
+    
+    if constexpr( Serializer<std::vector<Value, Allocator>>::contiguous )
+    {
+      if( count > ( length - offset ) / sizeof( Value ) ) return 0 ;
+      
+      value.resize( count ) ;
+      std::copy_n( in + offset, count * sizeof( Value ), reinterpret_cast<unsigned char*>( value.data() ) ) ;
+      offset += static_cast<unsigned>( count * sizeof( Value ) ) ;
+    }
+    else
+    {
+      // Every element takes at least a byte, so a corrupt count can not make this allocate more than the input.
+      if( count > length - offset ) return 0 ;
+      
+      value.clear() ;
+      value.reserve( count ) ;
+      
+      for( std::uint32_t index = 0; index < count; index++ )
+      {
+        Value          element {} ;
+        const unsigned used    = Serializer<Value>::read( element, in + offset, length - offset ) ;
+        
+        if( used == 0 ) return 0 ;
+        
+        value.push_back( std::move( element ) ) ;
+        offset += used ;
+      }
+    }
+    
+    return offset ;
+  }
+  
+  template<class Value>
+  const SerializerEntry& registerSerializer()
+  {
+    static const SerializerEntry entry =
+    {
+      typeinfo<Value>(),
+      Serializer<Value>::trivial,
+      []( const void* value ) -> unsigned
+      {
+        return Serializer<Value>::size( *static_cast<const Value*>( value ) ) ;
+      },
+      []( const void* value, unsigned char* out ) -> unsigned
+      {
+        return Serializer<Value>::write( *static_cast<const Value*>( value ), out ) ;
+      },
+      []( void* value, const unsigned char* in, unsigned length ) -> unsigned
+      {
+        return Serializer<Value>::read( *static_cast<Value*>( value ), in, length ) ;
+      },
+      []( Bus& bus, TopicId topic, const unsigned char* in, unsigned length, unsigned idx ) -> unsigned
+      {
+        Value          value {} ;
+        const unsigned used  = Serializer<Value>::read( value, in, length ) ;
+        
+        if( used != 0 ) bus.emitIndexed( value, idx, topic ) ;
+        return used ;
+      }
+    };
+    
+    registerSerializerBase( entry ) ;
+    return entry ;
+  }
+}
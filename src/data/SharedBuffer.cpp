@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedBuffer.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace iris
+{
+  /** Structure to contain the buffers of one topic and type that nobody refers to.
+   * @note Pools are never released, so blocks may hold on to them for the lifetime of the program.
+   */
+  struct BufferPool
+  {
+    static constexpr unsigned MAX_FREE = 64 ; ///< The most free buffers kept around. Any more are released.
+    
+    std::mutex                lock               ; ///< Lock for the free list.
+    std::vector<BufferBlock*> free               ; ///< The buffers waiting to be reused.
+    void*                   (*make    )()        ; ///< Function to make a new buffer.
+    void                    (*release )( void* ) ; ///< Function to release a buffer.
+  };
+  
+  /** Structure to contain a single pooled buffer and it's reference count.
+   */
+  struct BufferBlock
+  {
+    std::atomic<unsigned> refs  ; ///< The amount of references to this buffer.
+    void*                 value ; ///< The buffer itself.
+    BufferPool*           pool  ; ///< The pool to return this buffer to.
+  };
+  
+  /** Structure to contain every buffer pool, keyed by topic and type.
+   */
+  struct BufferRegistry
+  {
+    using Key = std::pair<unsigned, unsigned> ;
+    
+    std::mutex                 lock  ; ///< Lock for the pool map.
+    std::map<Key, BufferPool*> pools ; ///< The pools, keyed by topic id and type hash.
+  };
+  
+  /** Function to retrieve the process-wide buffer registry.
+   * @return Reference to the buffer registry.
+   */
+  static BufferRegistry& buffers()
+  {
+    // Intentionally never released, as buffers may be dropped while the program is shutting down.
+    static BufferRegistry* reg = new BufferRegistry() ;
+    return *reg ;
+  }
+  
+  /** Function to drop a reference to a block, returning it to it's pool if it was the last.
+   * @param block The block to drop.
+   */
+  static void drop( BufferBlock* block )
+  {
+    if( block == nullptr || block->refs.fetch_sub( 1, std::memory_order_acq_rel ) != 1 ) return ;
+    
+    BufferPool* pool = block->pool ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( pool->lock ) ;
+      if( pool->free.size() < BufferPool::MAX_FREE )
+      {
+        pool->free.push_back( block ) ;
+        return ;
+      }
+    }
+    
+    pool->release( block->value ) ;
+    delete block ;
+  }
+  
+  BufferReference::BufferReference()
+  {
+    this->block = nullptr ;
+  }
+  
+  BufferReference::BufferReference( const BufferReference& reference )
+  {
+    this->block = reference.block ;
+    if( this->block ) this->block->refs.fetch_add( 1, std::memory_order_relaxed ) ;
+  }
+  
+  BufferReference& BufferReference::operator=( const BufferReference& reference )
+  {
+    // Take the new reference first, so assigning a reference to itself never drops the buffer.
+    if( reference.block ) reference.block->refs.fetch_add( 1, std::memory_order_relaxed ) ;
+    drop( this->block ) ;
+    this->block = reference.block ;
+    
+    return *this ;
+  }
+  
+  BufferReference::~BufferReference()
+  {
+    drop( this->block ) ;
+  }
+  
+  BufferReference BufferReference::acquire( TopicId topic, unsigned type_id, void* (*make)(), void (*release)( void* ) )
+  {
+    BufferRegistry& reg  = buffers() ;
+    BufferPool*     pool = nullptr   ;
+    BufferReference reference        ;
+    
+    {
+      std::scoped_lock<std::mutex> lock( reg.lock ) ;
+      
+      auto iter = reg.pools.find( { topic.value, type_id } ) ;
+      
+      if( iter == reg.pools.end() )
+      {
+        pool          = new BufferPool() ;
+        pool->make    = make             ;
+        pool->release = release          ;
+        reg.pools.insert( { { topic.value, type_id }, pool } ) ;
+      }
+      else
+      {
+        pool = iter->second ;
+      }
+    }
+    
+    {
+      std::scoped_lock<std::mutex> lock( pool->lock ) ;
+      
+      if( !pool->free.empty() )
+      {
+        reference.block = pool->free.back() ;
+        pool->free.pop_back() ;
+      }
+    }
+    
+    if( reference.block == nullptr )
+    {
+      reference.block        = new BufferBlock() ;
+      reference.block->value = pool->make()      ;
+      reference.block->pool  = pool              ;
+    }
+    
+    reference.block->refs.store( 1, std::memory_order_relaxed ) ;
+    
+    return reference ;
+  }
+  
+  void* BufferReference::get() const
+  {
+    return this->block ? this->block->value : nullptr ;
+  }
+  
+  unsigned BufferReference::references() const
+  {
+    return this->block ? this->block->refs.load( std::memory_order_relaxed ) : 0 ;
+  }
+  
+  void BufferReference::reset()
+  {
+    drop( this->block ) ;
+    this->block = nullptr ;
+  }
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+
+namespace iris
+{
+  /** Type-erased, reference counted handle to a pooled buffer. Backs SharedBuffer.
+   * @note Copying a reference only bumps the count. The buffer goes back to it's pool when the last reference is dropped.
+   */
+  class BufferReference
+  {
+    public:
+      /** Default constructor. Refers to nothing.
+       */
+      BufferReference() ;
+      
+      /** Copy constructor. Shares the input's buffer.
+       * @param reference The reference to share.
+       */
+      BufferReference( const BufferReference& reference ) ;
+      
+      /** Assignment operator. Drops this object's buffer and shares the input's.
+       * @param reference The reference to share.
+       * @return Reference to this object after assignment.
+       */
+      BufferReference& operator=( const BufferReference& reference ) ;
+      
+      /** Deconstructor. Drops this object's buffer.
+       */
+      ~BufferReference() ;
+      
+      /** Static method to take a buffer from the pool of a topic and type, making one if the pool is empty.
+       * @param topic The topic whose pool to use.
+       * @param type_id The hash of the type of the buffer.
+       * @param make Function to make a new buffer.
+       * @param release Function to release a buffer.
+       * @return A reference to the buffer, the only one in existance.
+       */
+      static BufferReference acquire( TopicId topic, unsigned type_id, void* (*make)(), void (*release)( void* ) ) ;
+      
+      /** Method to retrieve the buffer this object refers to.
+       * @return Pointer to the buffer, or nullptr if this object refers to nothing.
+       */
+      void* get() const ;
+      
+      /** Method to retrieve how many references share this object's buffer.
+       * @return The amount of references, or 0 if this object refers to nothing.
+       */
+      unsigned references() const ;
+      
+      /** Method to drop this object's buffer, leaving it refering to nothing.
+       */
+      void reset() ;
+      
+    private:
+      struct BufferBlock* block ;
+  };
+  
+  /** Reference counted payload that is recycled through a per-topic pool.
+   * Emitting a SharedBuffer over the Bus only copies the handle, so a single allocation reaches every subscriber.
+   * 
+   *   E.g.  auto frame = iris::SharedBuffer<Image>::acquire( "camera::frame" ) ;
+   *         frame->resize( width, height ) ;
+   *         bus.emit( frame, "camera::frame" ) ;
+   * 
+   * @note A recycled buffer still holds the data of it's last use, so resized storage is reused instead of reallocated.
+   */
+  template<class Type>
+  class SharedBuffer
+  {
+    public:
+      /** Default constructor. Refers to no buffer.
+       */
+      SharedBuffer() = default ;
+      
+      /** Static method to take a buffer from the pool of a topic.
+       * @param args The arguments that make up the name of the topic.
+       * @return A handle to the buffer.
+       */
+      template<typename ... Keys>
+      static SharedBuffer<Type> acquire( Keys... args ) ;
+      
+      /** Method to retrieve the buffer this handle refers to.
+       * @return Pointer to the buffer, or nullptr if this handle refers to nothing.
+       */
+      Type* get() const ;
+      
+      /** Member access operator.
+       * @return Pointer to the buffer.
+       */
+      Type* operator->() const ;
+      
+      /** Dereference operator.
+       * @return Reference to the buffer.
+       */
+      Type& operator*() const ;
+      
+      /** Conversion operator.
+       * @return Whether or not this handle refers to a buffer.
+       */
+      explicit operator bool() const ;
+      
+      /** Method to retrieve how many handles share this handle's buffer.
+       * @return The amount of handles.
+       */
+      unsigned references() const ;
+      
+      /** Method to drop this handle's buffer.
+       */
+      void reset() ;
+      
+    private:
+      BufferReference reference ;
+  };
+  
+  template<class Type>
+  template<typename ... Keys>
+  SharedBuffer<Type> SharedBuffer<Type>::acquire( Keys... args )
+  {
+    SharedBuffer<Type> buffer ;
+    
+    buffer.reference = BufferReference::acquire( iris::intern( args... ), typeinfo<Type>().ctti_hash, 
+                                                 [] () -> void* { return new Type() ; }, 
+                                                 [] ( void* ptr ) { delete static_cast<Type*>( ptr ) ; } ) ;
+    return buffer ;
+  }
+  
+  template<class Type>
+  Type* SharedBuffer<Type>::get() const
+  {
+    return static_cast<Type*>( this->reference.get() ) ;
+  }
+  
+  template<class Type>
+  Type* SharedBuffer<Type>::operator->() const
+  {
+    return this->get() ;
+  }
+  
+  template<class Type>
+  Type& SharedBuffer<Type>::operator*() const
+  {
+    return *this->get() ;
+  }
+  
+  template<class Type>
+  SharedBuffer<Type>::operator bool() const
+  {
+    return this->get() != nullptr ;
+  }
+  
+  template<class Type>
+  unsigned SharedBuffer<Type>::references() const
+  {
+    return this->reference.references() ;
+  }
+  
+  template<class Type>
+  void SharedBuffer<Type>::reset()
+  {
+    this->reference.reset() ;
+  }
+}
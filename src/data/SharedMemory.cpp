@@ -0,0 +1,666 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedMemory.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+  #include <climits>
+  #include <ctime>
+  #include <fcntl.h>
+  #include <linux/futex.h>
+  #include <sys/file.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace iris
+{
+  static constexpr std::uint32_t SEGMENT_MAGIC = 0x49524953 ; ///< Marks a segment as made by this transport.
+  static constexpr unsigned      MAX_RINGS     = 128        ; ///< The most rings a segment can hold.
+  static constexpr unsigned      NAME_LENGTH   = 116        ; ///< The longest topic name a ring can hold, including the terminator.
+  static constexpr unsigned      SLOT_ALIGN    = 64         ; ///< The alignment of every slot, so neighbouring slots do not share a cache line.
+  
+  static_assert( std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory rings need address-free 64-bit atomics." ) ;
+  static_assert( std::atomic<std::uint32_t>::is_always_lock_free, "Shared memory rings need address-free 32-bit atomics." ) ;
+  
+  /** Structure to describe a single ring in a segment. Lives in shared memory.
+   */
+  struct RingHeader
+  {
+    char                       name[ NAME_LENGTH ] ; ///< The name of the topic.
+    std::uint32_t              type_id             ; ///< The hash of the type of data.
+    std::uint32_t              size                ; ///< The size of the type of data.
+    std::uint32_t              stride              ; ///< The size of a slot.
+    std::uint32_t              capacity            ; ///< The amount of slots. Always a power of two.
+    std::uint64_t              offset              ; ///< The offset of the first slot from the start of the segment.
+    std::atomic<std::uint64_t> head                ; ///< The sequence of the next slot to write.
+  };
+  
+  /** Structure to describe a single slot of a ring. Lives in shared memory, followed by the data.
+   * Works as a sequence lock. The sequence is odd while the slot is written, and 2 * ( n + 1 ) once the n-th data is in it.
+   */
+  struct SlotHeader
+  {
+    std::atomic<std::uint64_t> sequence ; ///< The state of the slot.
+    std::uint32_t              idx      ; ///< The index the data was emitted with.
+    std::uint32_t              source   ; ///< The transport that wrote the data.
+  };
+  
+  /** Structure at the start of every segment. Lives in shared memory.
+   */
+  struct SegmentHeader
+  {
+    std::uint32_t              magic               ; ///< SEGMENT_MAGIC once the segment is set up.
+    std::atomic<std::uint32_t> lock                ; ///< Spin lock for adding rings.
+    std::atomic<std::uint32_t> ring_count          ; ///< The amount of rings in the segment.
+    std::atomic<std::uint32_t> signal              ; ///< Futex word. Bumped whenever data is written.
+    std::atomic<std::uint32_t> waiters             ; ///< The amount of threads waiting on @signal.
+    std::uint64_t              size                ; ///< The size of the segment.
+    std::uint64_t              used                ; ///< The amount of the segment given out. Guarded by @lock.
+    RingHeader                 rings[ MAX_RINGS ]  ; ///< The rings of the segment.
+  };
+  
+  /** Structure to contain this process's view of a ring.
+   */
+  struct SharedRing
+  {
+    using Receiver = void (*)( Bus& bus, TopicId topic, const void* value, unsigned idx ) ;
+    
+    SegmentHeader* segment  ; ///< The segment the ring is in.
+    RingHeader*    header   ; ///< The ring.
+    char*          slots    ; ///< The first slot of the ring.
+    std::uint32_t  source   ; ///< The transport that owns this view.
+    std::uint64_t  next     ; ///< The sequence of the next slot to read. Only used by readers.
+    TopicId        topic    ; ///< The local topic of the ring.
+    Receiver       receiver ; ///< The function to emit read data with. Only used by readers.
+    
+    /** Method to retrieve a slot of the ring.
+     * @param sequence The sequence of the data in the slot.
+     * @return Pointer to the slot.
+     */
+    SlotHeader* slot( std::uint64_t sequence ) const ;
+  };
+  
+  /** Structure to contain a SharedTransport's data.
+   */
+  struct SharedTransportData
+  {
+    iris::Bus                       bus     ; ///< The bus to enroll writers on and emit read data over.
+    SegmentHeader*                  segment ; ///< The attached segment, or nullptr.
+    size_t                          length  ; ///< The mapped length of the segment.
+    unsigned                        depth   ; ///< The amount of data each new ring holds.
+    std::uint32_t                   source  ; ///< The id this transport writes with, so it can skip it's own data.
+    unsigned                        largest ; ///< The size of the largest type read.
+    std::vector<SharedWriter*>      writers ; ///< The writers of every published topic.
+    std::vector<SharedRing*>        readers ; ///< The rings of every subscribed topic.
+    std::recursive_mutex            lock    ; ///< Lock for the readers. Recursive, as subscribers may poll or subscribe.
+    std::thread                     thread  ; ///< The thread started by start().
+    std::atomic<bool>               running ; ///< Whether or not @thread should keep running.
+    std::atomic<unsigned long long> dropped ; ///< The amount of data lost by falling behind.
+    
+    /** Constructor.
+     */
+    SharedTransportData() ;
+    
+    /** Method to find the ring of a topic & type, making it if it does not exist.
+     * @param topic The topic.
+     * @param type_id The hash of the type of data.
+     * @param size The size of the type of data.
+     * @return A new view of the ring, or nullptr if it could not be made.
+     */
+    SharedRing* find( TopicId topic, unsigned type_id, unsigned size ) ;
+  };
+  
+  /** Structure to contain what a reset transport had attached, until no emitter can still be writing into it.
+   */
+  struct DetachedSegment
+  {
+    std::vector<SharedWriter*> writers ; ///< The writers that were enrolled on the transport's bus.
+    std::vector<SharedRing*>   rings   ; ///< The rings that were read, and the rings of the writers.
+    SegmentHeader*             segment ; ///< The segment, or nullptr.
+    size_t                     length  ; ///< The mapped length of the segment.
+  };
+  
+  /** The ring currently being read on this thread, so data re-emitted from it is not written straight back.
+   */
+  static thread_local const SharedRing* delivering = nullptr ;
+  
+  /** Function to make a process-wide unique id for a transport.
+   * @return The id.
+   */
+  static std::uint32_t makeSource()
+  {
+    static std::atomic<std::uint32_t> counter( 1 ) ;
+    
+#ifdef __linux__
+    return ( static_cast<std::uint32_t>( ::getpid() ) << 8 ) ^ counter.fetch_add( 1 ) ;
+#else
+    return counter.fetch_add( 1 ) ;
+#endif
+  }
+  
+  /** Function to make the system name of a segment.
+   * @param name The name of the segment.
+   * @return The system name.
+   */
+  static std::string segmentName( const char* name )
+  {
+    return std::string( "/iris_" ) + name ;
+  }
+  
+#ifdef __linux__
+  /** Function to attach to a segment, making and setting it up if it does not exist.
+   * @param name The name of the segment.
+   * @param size The size to make the segment with.
+   * @param length Reference to store the mapped length in.
+   * @return The segment, or nullptr if it could not be attached to.
+   */
+  static SegmentHeader* mapSegment( const char* name, unsigned size, size_t& length )
+  {
+    struct stat    info    ;
+    SegmentHeader* segment ;
+    void*          memory  ;
+    int            fd      ;
+    
+    if( size < sizeof( SegmentHeader ) ) size = sizeof( SegmentHeader ) ;
+    
+    fd = ::shm_open( segmentName( name ).c_str(), O_RDWR | O_CREAT, 0600 ) ;
+    if( fd < 0 ) return nullptr ;
+    
+    // Held while the segment is sized & set up, so every process maps the same size.
+    ::flock( fd, LOCK_EX ) ;
+    
+    if( ::fstat( fd, &info ) != 0 || ( info.st_size == 0 && ::ftruncate( fd, size ) != 0 ) || ::fstat( fd, &info ) != 0 )
+    {
+      ::flock( fd, LOCK_UN ) ;
+      ::close( fd ) ;
+      return nullptr ;
+    }
+    
+    length = static_cast<size_t>( info.st_size ) ;
+    memory = ::mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) ;
+    
+    if( memory == MAP_FAILED )
+    {
+      ::flock( fd, LOCK_UN ) ;
+      ::close( fd ) ;
+      return nullptr ;
+    }
+    
+    segment = static_cast<SegmentHeader*>( memory ) ;
+    
+    // New segments are zeroed by the system, which is a valid state for every atomic in it.
+    if( segment->magic != SEGMENT_MAGIC )
+    {
+      segment->size  = length                                                                 ;
+      segment->used  = ( sizeof( SegmentHeader ) + SLOT_ALIGN - 1 ) / SLOT_ALIGN * SLOT_ALIGN ;
+      segment->magic = SEGMENT_MAGIC                                                          ;
+    }
+    
+    ::flock( fd, LOCK_UN ) ;
+    ::close( fd ) ;
+    
+    return segment ;
+  }
+  
+  /** Function to detach from a segment.
+   * @param segment The segment.
+   * @param length The mapped length of the segment.
+   */
+  static void unmapSegment( SegmentHeader* segment, size_t length )
+  {
+    ::munmap( static_cast<void*>( segment ), length ) ;
+  }
+  
+  /** Function to sleep until a futex word changes from a value, or the timeout passes.
+   * @param word The futex word.
+   * @param value The value the word had.
+   * @param milliseconds The most time to sleep.
+   */
+  static void futexWait( std::atomic<std::uint32_t>* word, std::uint32_t value, unsigned milliseconds )
+  {
+    struct timespec timeout ;
+    
+    timeout.tv_sec  = milliseconds / 1000                              ;
+    timeout.tv_nsec = static_cast<long>( milliseconds % 1000 ) * 1000000 ;
+    
+    // Not FUTEX_PRIVATE, as wakers live in other processes.
+    ::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( word ), FUTEX_WAIT, value, &timeout, nullptr, 0 ) ;
+  }
+  
+  /** Function to wake every thread sleeping on a futex word.
+   * @param word The futex word.
+   */
+  static void futexWake( std::atomic<std::uint32_t>* word )
+  {
+    ::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( word ), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 ) ;
+  }
+  
+  /** Function to remove a segment from the system.
+   * @param name The name of the segment.
+   */
+  static void unlinkSegment( const char* name )
+  {
+    ::shm_unlink( segmentName( name ).c_str() ) ;
+  }
+#else
+  static SegmentHeader* mapSegment( const char*, unsigned, size_t& )
+  {
+    std::cout << "Iris Shared Transport: Shared memory segments are only supported on Linux." << std::endl ;
+    return nullptr ;
+  }
+  
+  static void unmapSegment( SegmentHeader*, size_t )
+  {
+  }
+  
+  static void futexWait( std::atomic<std::uint32_t>*, std::uint32_t, unsigned milliseconds )
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds( milliseconds ) ) ;
+  }
+  
+  static void futexWake( std::atomic<std::uint32_t>* )
+  {
+  }
+  
+  static void unlinkSegment( const char* )
+  {
+  }
+#endif
+
+  /** Function to free the writers and rings of a reset transport and detach from it's segment. Run by iris::retireObject.
+   * @param pointer The DetachedSegment to release.
+   */
+  static void releaseDetached( void* pointer )
+  {
+    DetachedSegment* detached = static_cast<DetachedSegment*>( pointer ) ;
+    
+    for( auto writer : detached->writers ) delete writer ;
+    for( auto ring   : detached->rings   ) delete ring   ;
+    
+    if( detached->segment ) unmapSegment( detached->segment, detached->length ) ;
+    
+    delete detached ;
+  }
+  
+  /** Function to wake every thread waiting on a segment.
+   * @param segment The segment.
+   */
+  static void notify( SegmentHeader* segment )
+  {
+    segment->signal.fetch_add( 1, std::memory_order_seq_cst ) ;
+    
+    // Skip the system call when nobody sleeps on the segment.
+    if( segment->waiters.load( std::memory_order_seq_cst ) != 0 ) futexWake( &segment->signal ) ;
+  }
+  
+  SlotHeader* SharedRing::slot( std::uint64_t sequence ) const
+  {
+    return reinterpret_cast<SlotHeader*>( this->slots + ( sequence & ( this->header->capacity - 1 ) ) * this->header->stride ) ;
+  }
+  
+  SharedTransportData::SharedTransportData()
+  {
+    this->segment = nullptr ;
+    this->length  = 0       ;
+    this->depth   = 0       ;
+    this->source  = 0       ;
+    this->largest = 0       ;
+    this->running = false   ;
+    this->dropped = 0       ;
+  }
+  
+  SharedRing* SharedTransportData::find( TopicId topic, unsigned type_id, unsigned size )
+  {
+    const char*   name   = iris::topicName( topic ) ;
+    RingHeader*   header = nullptr                  ;
+    std::uint32_t count  = 0                        ;
+    SharedRing*   ring   = nullptr                  ;
+    
+    if( this->segment == nullptr ) return nullptr ;
+    
+    if( std::strlen( name ) >= NAME_LENGTH )
+    {
+      std::cout << "Iris Shared Transport: Topic '" << name << "' is too long to share." << std::endl ;
+      return nullptr ;
+    }
+    
+    while( this->segment->lock.exchange( 1, std::memory_order_acquire ) != 0 ) std::this_thread::yield() ;
+    
+    count = this->segment->ring_count.load( std::memory_order_relaxed ) ;
+    
+    for( unsigned index = 0; index < count && header == nullptr; index++ )
+    {
+      RingHeader& candidate = this->segment->rings[ index ] ;
+      if( candidate.type_id == type_id && std::strcmp( candidate.name, name ) == 0 ) header = &candidate ;
+    }
+    
+    if( header == nullptr )
+    {
+      std::uint32_t capacity = 2                                                                      ;
+      std::uint32_t stride   = ( sizeof( SlotHeader ) + size + SLOT_ALIGN - 1 ) / SLOT_ALIGN * SLOT_ALIGN ;
+      
+      while( capacity < this->depth ) capacity <<= 1 ;
+      
+      if( count < MAX_RINGS && this->segment->used + static_cast<std::uint64_t>( capacity ) * stride <= this->segment->size )
+      {
+        header           = &this->segment->rings[ count ] ;
+        header->type_id  = type_id                        ;
+        header->size     = size                           ;
+        header->stride   = stride                         ;
+        header->capacity = capacity                       ;
+        header->offset   = this->segment->used            ;
+        std::strcpy( header->name, name ) ;
+        
+        this->segment->used += static_cast<std::uint64_t>( capacity ) * stride ;
+        this->segment->ring_count.store( count + 1, std::memory_order_release ) ;
+      }
+      else
+      {
+        std::cout << "Iris Shared Transport: Out of room in the segment for topic '" << name << "'." << std::endl ;
+      }
+    }
+    else if( header->size != size )
+    {
+      std::cout << "Iris Shared Transport: Topic '" << name << "' is shared with a different size of data." << std::endl ;
+      header = nullptr ;
+    }
+    
+    this->segment->lock.store( 0, std::memory_order_release ) ;
+    
+    if( header == nullptr ) return nullptr ;
+    
+    ring           = new SharedRing()                                          ;
+    ring->segment  = this->segment                                             ;
+    ring->header   = header                                                    ;
+    ring->slots    = reinterpret_cast<char*>( this->segment ) + header->offset ;
+    ring->source   = this->source                                              ;
+    ring->next     = header->head.load( std::memory_order_acquire )            ;
+    ring->topic    = topic                                                     ;
+    ring->receiver = nullptr                                                   ;
+    
+    return ring ;
+  }
+  
+  void SharedWriter::writeBase( const void* values, unsigned count, unsigned first )
+  {
+    const SharedRing&   ring  = *this->ring                        ;
+    const char*         bytes = static_cast<const char*>( values ) ;
+    const std::uint32_t size  = ring.header->size                  ;
+    std::uint64_t       start ;
+    
+    // This is the data being read on this thread, re-emitted. Sending it back would echo it forever.
+    if( count == 0 || ( delivering && delivering->topic.value == ring.topic.value && delivering->header->type_id == ring.header->type_id ) ) return ;
+    
+    start = ring.header->head.fetch_add( count, std::memory_order_acq_rel ) ;
+    
+    for( unsigned index = 0; index < count; index++ )
+    {
+      const std::uint64_t sequence = start + index         ;
+      SlotHeader*         slot     = ring.slot( sequence ) ;
+      
+      slot->sequence.store( 2 * sequence + 1, std::memory_order_relaxed ) ;
+      std::atomic_thread_fence( std::memory_order_release ) ;
+      
+      slot->idx    = first + index ;
+      slot->source = ring.source   ;
+      std::memcpy( reinterpret_cast<char*>( slot + 1 ), bytes + static_cast<size_t>( index ) * size, size ) ;
+      
+      slot->sequence.store( 2 * sequence + 2, std::memory_order_release ) ;
+    }
+    
+    notify( ring.segment ) ;
+  }
+  
+  SharedTransport::SharedTransport()
+  {
+    this->transport_data = new SharedTransportData() ;
+  }
+  
+  SharedTransport::~SharedTransport()
+  {
+    this->reset() ;
+    delete this->transport_data ;
+  }
+  
+  bool SharedTransport::initialize( const char* name, unsigned size, unsigned depth )
+  {
+    this->reset() ;
+    
+    data().segment = mapSegment( name, size, data().length ) ;
+    data().depth   = depth                                  ;
+    data().source  = makeSource()                           ;
+    
+    if( data().segment == nullptr ) std::cout << "Iris Shared Transport: Unable to attach to segment '" << name << "'." << std::endl ;
+    
+    return data().segment != nullptr ;
+  }
+  
+  bool SharedTransport::isInitialized() const
+  {
+    return data().segment != nullptr ;
+  }
+  
+  SharedWriter* SharedTransport::publishBase( TopicId topic, unsigned type_id, unsigned size )
+  {
+    SharedRing*   ring   = data().find( topic, type_id, size ) ;
+    SharedWriter* writer = nullptr                             ;
+    
+    if( ring == nullptr ) return nullptr ;
+    
+    writer       = new SharedWriter() ;
+    writer->ring = ring               ;
+    data().writers.push_back( writer ) ;
+    
+    return writer ;
+  }
+  
+  bool SharedTransport::subscribeBase( TopicId topic, unsigned type_id, unsigned size, Receiver receiver )
+  {
+    std::scoped_lock<std::recursive_mutex> lock( data().lock )                        ;
+    SharedRing*                            ring = data().find( topic, type_id, size ) ;
+    
+    if( ring == nullptr ) return false ;
+    
+    ring->receiver = receiver ;
+    data().readers.push_back( ring ) ;
+    if( size > data().largest ) data().largest = size ;
+    
+    return true ;
+  }
+  
+  unsigned SharedTransport::poll()
+  {
+    std::scoped_lock<std::recursive_mutex> lock( data().lock ) ;
+    std::vector<std::max_align_t>          buffer              ;
+    const SharedRing*                      previous = delivering ;
+    unsigned                               count    = 0          ;
+    
+    if( data().readers.empty() ) return 0 ;
+    
+    // Data is copied out before it is emitted, as a writer may lap the slot while subscribers use it.
+    buffer.resize( data().largest / sizeof( std::max_align_t ) + 1 ) ;
+    
+    // Indexed, as subscribers may subscribe to more topics while this runs.
+    for( size_t index = 0; index < data().readers.size(); index++ )
+    {
+      SharedRing&         ring     = *data().readers[ index ]                                 ;
+      const std::uint64_t head     = ring.header->head.load( std::memory_order_acquire )      ;
+      const std::uint64_t capacity = ring.header->capacity                                    ;
+      const std::uint32_t size     = ring.header->size                                        ;
+      
+      if( head - ring.next > capacity )
+      {
+        data().dropped += head - capacity - ring.next ;
+        ring.next       = head - capacity             ;
+      }
+      
+      while( ring.next < head )
+      {
+        const std::uint64_t sequence = ring.next                                             ;
+        const SlotHeader*   slot     = ring.slot( sequence )                                 ;
+        const std::uint64_t expected = 2 * sequence + 2                                      ;
+        const std::uint64_t before   = slot->sequence.load( std::memory_order_acquire )      ;
+        std::uint32_t       idx      = 0                                                     ;
+        std::uint32_t       source   = 0                                                     ;
+        
+        // Still being written. Picked up on the next poll.
+        if( before < expected ) break ;
+        
+        ring.next++ ;
+        
+        if( before == expected )
+        {
+          idx    = slot->idx    ;
+          source = slot->source ;
+          std::memcpy( static_cast<void*>( buffer.data() ), reinterpret_cast<const char*>( slot + 1 ), size ) ;
+          std::atomic_thread_fence( std::memory_order_acquire ) ;
+        }
+        
+        // Overwritten by a writer a whole ring ahead, either before or during the copy.
+        if( before != expected || slot->sequence.load( std::memory_order_relaxed ) != expected )
+        {
+          data().dropped++ ;
+          continue ;
+        }
+        
+        if( source == data().source ) continue ;
+        
+        delivering = &ring ;
+        ring.receiver( data().bus, ring.topic, static_cast<const void*>( buffer.data() ), idx ) ;
+        delivering = previous ;
+        count++ ;
+      }
+    }
+    
+    return count ;
+  }
+  
+  void SharedTransport::wait( unsigned milliseconds )
+  {
+    SegmentHeader* segment = data().segment ;
+    std::uint32_t  value   ;
+    bool           pending = false ;
+    
+    if( segment == nullptr )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( milliseconds ) ) ;
+      return ;
+    }
+    
+    value = segment->signal.load( std::memory_order_seq_cst ) ;
+    segment->waiters.fetch_add( 1, std::memory_order_seq_cst ) ;
+    
+    {
+      std::scoped_lock<std::recursive_mutex> lock( data().lock ) ;
+      for( auto ring : data().readers )
+      {
+        if( ring->header->head.load( std::memory_order_acquire ) != ring->next ) pending = true ;
+      }
+    }
+    
+    if( !pending ) futexWait( &segment->signal, value, milliseconds ) ;
+    
+    segment->waiters.fetch_sub( 1, std::memory_order_seq_cst ) ;
+  }
+  
+  void SharedTransport::start()
+  {
+    if( data().segment == nullptr || data().running.exchange( true ) ) return ;
+    
+    data().thread = std::thread( [this] ()
+    {
+      while( this->data().running.load() )
+      {
+        if( this->poll() == 0 ) this->wait( 100 ) ;
+      }
+    } ) ;
+  }
+  
+  void SharedTransport::stop()
+  {
+    if( !data().running.exchange( false ) ) return ;
+    
+    // Wakes every waiter on the segment, not just this one. They find nothing and go back to sleep.
+    notify( data().segment ) ;
+    data().thread.join() ;
+  }
+  
+  unsigned long long SharedTransport::dropped() const
+  {
+    return data().dropped.load() ;
+  }
+  
+  void SharedTransport::reset()
+  {
+    this->stop() ;
+    
+    std::scoped_lock<std::recursive_mutex> lock( data().lock ) ;
+    
+    data().bus.clearSubscriptions() ;
+    
+    // Emitters on other threads may still be writing through the old subscriptions, so what they reach is released once they are done.
+    DetachedSegment* detached = new DetachedSegment() ;
+    
+    detached->writers = std::move( data().writers ) ;
+    detached->rings   = std::move( data().readers ) ;
+    detached->segment = data().segment              ;
+    detached->length  = data().length               ;
+    
+    for( auto writer : detached->writers ) detached->rings.push_back( writer->ring ) ;
+    
+    retireObject( static_cast<void*>( detached ), &releaseDetached ) ;
+    
+    data().writers.clear() ;
+    data().readers.clear() ;
+    data().largest = 0       ;
+    data().segment = nullptr ;
+    data().length  = 0       ;
+  }
+  
+  void SharedTransport::unlink( const char* name )
+  {
+    unlinkSegment( name ) ;
+  }
+  
+  SharedTransportData& SharedTransport::data()
+  {
+    return *this->transport_data ;
+  }
+  
+  const SharedTransportData& SharedTransport::data() const
+  {
+    return *this->transport_data ;
+  }
+  
+  Bus& SharedTransport::bus()
+  {
+    return data().bus ;
+  }
+}
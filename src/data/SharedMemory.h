@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+#include <type_traits>
+
+namespace iris
+{
+  /** Object that copies the data of one topic and type into a shared memory ring.
+   * @note Made and owned by a SharedTransport. Only exists so the transport can enroll it on it's bus.
+   */
+  class SharedWriter
+  {
+    public:
+      /** Method to copy a batch of data into this object's ring.
+       * @param values The data to copy.
+       * @param count The amount of data.
+       * @param first The index of the first value.
+       */
+      template<class Value>
+      void write( const Value* values, unsigned count, unsigned first ) ;
+    
+    private:
+      friend class SharedTransport ;
+      
+      struct SharedRing* ring ;
+      
+      /** Method to copy type-erased data into this object's ring.
+       * @param values The data to copy.
+       * @param count The amount of data.
+       * @param first The index of the first value.
+       */
+      void writeBase( const void* values, unsigned count, unsigned first ) ;
+  };
+  
+  /** Class to carry topics between processes on the same host through a POSIX shared memory segment.
+   * Every topic and type shared gets a lock-free ring in the segment. Data emitted locally is copied once into the ring,
+   * and every other process using the segment re-emits it to it's own subscribers.
+   *
+   *   E.g.  iris::SharedTransport transport ;
+   *         transport.initialize( "camera" ) ;
+   *         transport.publish  <float>   ( "camera::gain"     ) ; // Local emits go out to the segment.
+   *         transport.subscribe<unsigned>( "camera::exposure" ) ; // Segment data is emitted locally.
+   *         transport.start() ;
+   *
+   * @note Only trivially-copyable data can be shared, as it is copied byte for byte. Readers that fall a whole ring behind lose the oldest data.
+   */
+  class SharedTransport
+  {
+    public:
+      static constexpr unsigned DEFAULT_SIZE  = 8u << 20 ; ///< The default size of a segment in bytes.
+      static constexpr unsigned DEFAULT_DEPTH = 256      ; ///< The default amount of data each ring holds.
+      
+      /** Default constructor.
+       */
+      SharedTransport() ;
+      
+      /** Deconstructor. Stops and detaches from the segment. The segment itself stays until unlink is called.
+       */
+      ~SharedTransport() ;
+      
+      /** Method to attach to a segment, making it if no other process has.
+       * @param name The name of the segment. Every process that uses the same name shares topics.
+       * @param size The size of the segment in bytes. Only used by the process that makes it.
+       * @param depth The amount of data each ring holds, rounded up to a power of two.
+       * @return Whether or not the segment could be attached to.
+       */
+      bool initialize( const char* name, unsigned size = DEFAULT_SIZE, unsigned depth = DEFAULT_DEPTH ) ;
+      
+      /** Method to retrieve whether or not this object is attached to a segment.
+       * @return Whether or not this object is initialized.
+       */
+      bool isInitialized() const ;
+      
+      /** Method to send the data emitted locally over a topic out to the segment.
+       * @param args The arguments that make up the name of the topic.
+       * @return Whether or not the topic has a ring in the segment.
+       */
+      template<class Value, typename ... Keys>
+      bool publish( Keys... args ) ;
+      
+      /** Method to emit the data sent to the segment over a topic to local subscribers.
+       * @note Only data sent after this call is recieved.
+       * @param args The arguments that make up the name of the topic.
+       * @return Whether or not the topic has a ring in the segment.
+       */
+      template<class Value, typename ... Keys>
+      bool subscribe( Keys... args ) ;
+      
+      /** Method to emit all data waiting in the segment for this object's subscriptions, on the calling thread.
+       * @return The amount of data emitted.
+       */
+      unsigned poll() ;
+      
+      /** Method to wait until more data is sent to the segment, or the timeout passes.
+       * @param milliseconds The most time to wait.
+       */
+      void wait( unsigned milliseconds ) ;
+      
+      /** Method to start a thread that polls this object whenever data is sent to the segment.
+       */
+      void start() ;
+      
+      /** Method to stop the thread started by start.
+       */
+      void stop() ;
+      
+      /** Method to retrieve how much data this object's subscriptions lost by falling a whole ring behind.
+       * @return The amount of data lost.
+       */
+      unsigned long long dropped() const ;
+      
+      /** Method to stop, drop every publication & subscription and detach from the segment.
+       */
+      void reset() ;
+      
+      /** Static method to remove a segment from the system. Processes already attached keep using it.
+       * @param name The name of the segment.
+       */
+      static void unlink( const char* name ) ;
+    
+    private:
+      using Receiver = void (*)( Bus& bus, TopicId topic, const void* value, unsigned idx ) ;
+      
+      /** Static method to restore the type of data read from the segment and emit it locally.
+       * @param bus The bus to emit over.
+       * @param topic The topic to emit over.
+       * @param value Pointer to the data.
+       * @param idx The index of the data.
+       */
+      template<class Value>
+      static void receive( Bus& bus, TopicId topic, const void* value, unsigned idx ) ;
+      
+      /** Method to find or make the ring of a topic & type, and a writer for it.
+       * @param topic The topic.
+       * @param type_id The hash of the type of data.
+       * @param size The size of the type of data.
+       * @return The writer to enroll, or nullptr if the topic could not be shared.
+       */
+      SharedWriter* publishBase( TopicId topic, unsigned type_id, unsigned size ) ;
+      
+      /** Method to find or make the ring of a topic & type, and start reading it.
+       * @param topic The topic.
+       * @param type_id The hash of the type of data.
+       * @param size The size of the type of data.
+       * @param receiver The function to emit the data read with.
+       * @return Whether or not the topic could be shared.
+       */
+      bool subscribeBase( TopicId topic, unsigned type_id, unsigned size, Receiver receiver ) ;
+      
+      struct SharedTransportData* transport_data ;
+      SharedTransportData& data() ;
+      const SharedTransportData& data() const ;
+      
+      /** Method to retrieve the bus this object emits and subscribes with.
+       * @return Reference to the bus.
+       */
+      Bus& bus() ;
+  };
+  
+  template<class Value>
+  void SharedWriter::write( const Value* values, unsigned count, unsigned first )
+  {
+    this->writeBase( static_cast<const void*>( values ), count, first ) ;
+  }
+  
+  template<class Value>
+  void SharedTransport::receive( Bus& bus, TopicId topic, const void* value, unsigned idx )
+  {
+    bus.emitIndexed( *static_cast<const Value*>( value ), idx, topic ) ;
+  }
+  
+  template<class Value, typename ... Keys>
+  bool SharedTransport::publish( Keys... args )
+  {
+    static_assert( std::is_trivially_copyable<Value>::value, "Only trivially-copyable data can be shared between processes." ) ;
+    
+    const TopicId topic  = ::iris::intern( args... ) ;
+    SharedWriter* writer = this->publishBase( topic, typeinfo<Value>().ctti_hash, sizeof( Value ) ) ;
+    
+    if( writer ) this->bus().enroll( writer, &SharedWriter::write<Value>, iris::OPTIONAL, topic ) ;
+    
+    return writer != nullptr ;
+  }
+  
+  template<class Value, typename ... Keys>
+  bool SharedTransport::subscribe( Keys... args )
+  {
+    static_assert( std::is_trivially_copyable<Value>::value, "Only trivially-copyable data can be shared between processes." ) ;
+    
+    return this->subscribeBase( ::iris::intern( args... ), typeinfo<Value>().ctti_hash, sizeof( Value ), &SharedTransport::receive<Value> ) ;
+  }
+}
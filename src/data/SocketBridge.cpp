@@ -0,0 +1,925 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SocketBridge.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+  #include <ctime>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+
+namespace iris
+{
+  static constexpr std::uint32_t ANNOUNCE   = 0x80000000u ; ///< Set in a frame's length when the frame announces a topic name instead of carrying data.
+  static constexpr std::uint32_t MAX_LENGTH = 1u << 24    ; ///< The largest payload accepted. Anything larger means the stream is corrupt.
+  static constexpr size_t        READ_SIZE  = 1u << 16    ; ///< The most bytes read from a peer at once.
+  
+  /** Structure at the start of every frame on the wire.
+   */
+  struct FrameHeader
+  {
+    std::uint32_t topic   ; ///< The sender's id of the topic.
+    std::uint32_t type_id ; ///< The hash of the type of data.
+    std::uint32_t length  ; ///< The length of the payload that follows. The top bit is set for announcements.
+    std::uint32_t idx     ; ///< The index the data was emitted with.
+  };
+  
+  /** Structure to contain a topic published to peers.
+   */
+  struct BridgeTopic
+  {
+    struct SocketBridgeData* bridge  ; ///< The bridge the topic is published on.
+    TopicId                  topic   ; ///< The topic.
+    std::uint32_t            type_id ; ///< The hash of the type of data.
+    std::uint32_t            size    ; ///< The size of the type of data.
+  };
+  
+  /** Structure to contain a topic recieved from peers.
+   */
+  struct BridgeRoute
+  {
+    using Receiver = void (*)( Bus& bus, TopicId topic, const void* value, unsigned idx ) ;
+    
+    TopicId       topic    ; ///< The local topic.
+    std::uint32_t type_id  ; ///< The hash of the type of data.
+    std::uint32_t size     ; ///< The size of the type of data.
+    Receiver      receiver ; ///< The function to emit the data with.
+  };
+  
+  /** Structure to contain a single peer.
+   */
+  struct BridgeConnection
+  {
+    using Name = std::pair<std::string, std::uint32_t> ;
+    
+    int                                                   fd      ; ///< The socket of the peer. Non-blocking.
+    bool                                                  broken  ; ///< Whether or not the peer went away. Guarded by the bridge's lock.
+    std::vector<char>                                     input   ; ///< Bytes read from the peer that are not a whole frame yet.
+    std::vector<char>                                     output  ; ///< Bytes waiting for the peer to take them. Guarded by the bridge's lock.
+    size_t                                                written ; ///< The amount of @output already written. Guarded by the bridge's lock.
+    std::unordered_map<std::uint32_t, Name>               names   ; ///< The name & type of every topic the peer announced, by the peer's id.
+    std::unordered_map<std::uint32_t, const BridgeRoute*> routes  ; ///< Cache of the route of every topic the peer announced. nullptr if it is not subscribed to.
+  };
+  
+  /** Structure to contain a SocketBridge's data.
+   */
+  struct SocketBridgeData
+  {
+    using Clock    = std::chrono::steady_clock                                      ;
+    using RouteMap = std::map<std::pair<std::string, std::uint32_t>, BridgeRoute*> ;
+    
+    iris::Bus                       bus            ; ///< The bus to enroll writers on and emit recieved data over.
+    int                             listener       ; ///< The listening socket, or -1.
+    int                             wake[ 2 ]      ; ///< Pipe used to wake the polling thread.
+    std::string                     path           ; ///< The path of the listening socket.
+    std::vector<BridgeConnection*>  connections    ; ///< Every peer. Guarded by @lock.
+    std::vector<BridgeWriter*>      writers        ; ///< The writers of every published topic. Guarded by @lock.
+    RouteMap                        routes         ; ///< The route of every subscribed topic, by name & type. Guarded by @poll_lock.
+    std::vector<char>               batch          ; ///< The frames waiting to be written. Guarded by @lock.
+    unsigned                        batched        ; ///< The amount of data in @batch. Guarded by @lock.
+    Clock::time_point               first          ; ///< The time the first frame went into @batch. Guarded by @lock.
+    unsigned                        depth          ; ///< How many polls deep the polling thread is. Guarded by @poll_lock.
+    std::atomic<unsigned>           window         ; ///< The batching window in microseconds.
+    std::atomic<unsigned>           batch_size     ; ///< The size a batch is written at.
+    std::atomic<unsigned>           output_limit   ; ///< The most bytes a peer may have waiting to be written.
+    std::mutex                      lock           ; ///< Lock for writing.
+    std::recursive_mutex            poll_lock      ; ///< Lock for reading. Recursive, as subscribers may subscribe to more topics.
+    std::thread                     thread         ; ///< The thread started by start().
+    std::atomic<bool>               running        ; ///< Whether or not @thread should keep running.
+    std::atomic<unsigned long long> sent           ; ///< The amount of data written to peers.
+    std::atomic<unsigned long long> sent_bytes     ; ///< The amount of bytes written to peers.
+    std::atomic<unsigned long long> received       ; ///< The amount of data read from peers.
+    std::atomic<unsigned long long> received_bytes ; ///< The amount of bytes read from peers.
+    std::atomic<unsigned long long> flushes        ; ///< The amount of batches written.
+    std::atomic<unsigned long long> dropped        ; ///< The amount of data not sent to a peer that was too far behind.
+    
+    /** Constructor.
+     */
+    SocketBridgeData() ;
+    
+    /** Method to add a frame to the batch. Must hold @lock.
+     * @param header The header of the frame.
+     * @param payload The payload of the frame.
+     */
+    void append( const FrameHeader& header, const void* payload ) ;
+    
+    /** Method to queue the batch to every peer and write as much of it as they take. Must hold @lock.
+     * @note Never blocks. A peer that has more than the output limit waiting has the batch's data dropped instead.
+     */
+    void flushLocked() ;
+    
+    /** Method to write as much of a peer's waiting output as it takes without blocking. Must hold @lock.
+     * @param connection The peer.
+     * @return Whether or not output is still waiting.
+     */
+    bool writeOut( BridgeConnection& connection ) ;
+    
+    /** Method to add a peer and announce every published topic to it. Must hold @lock.
+     * @param fd The socket of the peer.
+     */
+    void addConnection( int fd ) ;
+    
+    /** Method to emit every whole frame read from a peer. Must hold @poll_lock.
+     * @param connection The peer.
+     * @return The amount of data emitted.
+     */
+    unsigned dispatch( BridgeConnection& connection ) ;
+    
+    /** Method to find the route of a topic a peer announced. Must hold @poll_lock.
+     * @param connection The peer.
+     * @param topic The peer's id of the topic.
+     * @return The route, or nullptr if the topic is not subscribed to.
+     */
+    const BridgeRoute* route( BridgeConnection& connection, std::uint32_t topic ) ;
+  };
+  
+  /** The route currently being emitted on this thread, so data re-emitted from it is not sent straight back.
+   */
+  static thread_local const BridgeRoute* delivering = nullptr ;
+  
+  /** Function to copy only the announcements out of a batch of frames, so a peer that has data dropped still learns every topic.
+   * @param batch The frames.
+   * @param out The buffer to append the announcements to.
+   */
+  static void keepAnnouncements( const std::vector<char>& batch, std::vector<char>& out )
+  {
+    FrameHeader header ;
+    size_t      offset = 0 ;
+    size_t      length = 0 ;
+    
+    while( batch.size() - offset >= sizeof( FrameHeader ) )
+    {
+      std::memcpy( &header, batch.data() + offset, sizeof( FrameHeader ) ) ;
+      length = sizeof( FrameHeader ) + ( header.length & ~ANNOUNCE ) ;
+      
+      if( header.length & ANNOUNCE ) out.insert( out.end(), batch.data() + offset, batch.data() + offset + length ) ;
+      offset += length ;
+    }
+  }
+  
+  /** Function to make the announcement frame of a published topic.
+   * @param topic The published topic.
+   * @param header Reference to the header to fill.
+   * @return The name of the topic, which is the payload.
+   */
+  static const char* announcement( const BridgeTopic& topic, FrameHeader& header )
+  {
+    const char* name = iris::topicName( topic.topic ) ;
+    
+    header.topic   = topic.topic.value                                          ;
+    header.type_id = topic.type_id                                              ;
+    header.length  = static_cast<std::uint32_t>( std::strlen( name ) ) | ANNOUNCE ;
+    header.idx     = 0                                                          ;
+    
+    return name ;
+  }
+  
+#ifdef __linux__
+  /** Function to fill the address of a Unix domain socket.
+   * @param path The path of the socket.
+   * @param address Reference to the address to fill.
+   * @return Whether or not the path fits.
+   */
+  static bool makeAddress( const char* path, sockaddr_un& address )
+  {
+    std::memset( &address, 0, sizeof( address ) ) ;
+    address.sun_family = AF_UNIX ;
+    
+    if( std::strlen( path ) >= sizeof( address.sun_path ) ) return false ;
+    
+    std::strcpy( address.sun_path, path ) ;
+    return true ;
+  }
+  
+  static int listenSocket( const char* path )
+  {
+    sockaddr_un address ;
+    int         fd      ;
+    
+    if( !makeAddress( path, address ) ) return -1 ;
+    
+    fd = ::socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 ) ;
+    if( fd < 0 ) return -1 ;
+    
+    ::unlink( path ) ;
+    
+    if( ::bind( fd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) != 0 || ::listen( fd, 16 ) != 0 )
+    {
+      ::close( fd ) ;
+      return -1 ;
+    }
+    
+    return fd ;
+  }
+  
+  static int connectSocket( const char* path )
+  {
+    sockaddr_un address ;
+    int         fd      ;
+    
+    if( !makeAddress( path, address ) ) return -1 ;
+    
+    fd = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 ) ;
+    if( fd < 0 ) return -1 ;
+    
+    if( ::connect( fd, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) != 0 )
+    {
+      ::close( fd ) ;
+      return -1 ;
+    }
+    
+    // Connected first, so connecting still waits for the listener. Writing never does.
+    ::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL ) | O_NONBLOCK ) ;
+    
+    return fd ;
+  }
+  
+  static int acceptSocket( int listener )
+  {
+    return ::accept4( listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC ) ;
+  }
+  
+  /** Function to write as much as a socket takes without blocking.
+   * @return The amount of bytes written, or -1 if the peer went away.
+   */
+  static long sendSome( int fd, const char* bytes, size_t length )
+  {
+    while( true )
+    {
+      const ssize_t amount = ::send( fd, bytes, length, MSG_NOSIGNAL | MSG_DONTWAIT ) ;
+      
+      if( amount >= 0                                    ) return static_cast<long>( amount ) ;
+      if( errno == EINTR                                 ) continue ;
+      if( errno == EAGAIN || errno == EWOULDBLOCK        ) return 0 ;
+      
+      return -1 ;
+    }
+  }
+  
+  /** Function to read as much as is waiting on a socket or pipe without blocking.
+   * @return The amount of bytes read, 0 if nothing is waiting, or -1 if the other end went away.
+   */
+  static long readSome( int fd, char* bytes, size_t length )
+  {
+    while( true )
+    {
+      const ssize_t amount = ::read( fd, bytes, length ) ;
+      
+      if( amount > 0                              ) return static_cast<long>( amount ) ;
+      if( amount == 0                             ) return -1 ;
+      if( errno == EINTR                          ) continue ;
+      if( errno == EAGAIN || errno == EWOULDBLOCK ) return 0 ;
+      
+      return -1 ;
+    }
+  }
+  
+  static void closeSocket( int fd )
+  {
+    ::close( fd ) ;
+  }
+  
+  static void removeSocket( const char* path )
+  {
+    ::unlink( path ) ;
+  }
+  
+  static void openWake( int* fds )
+  {
+    if( ::pipe2( fds, O_NONBLOCK | O_CLOEXEC ) != 0 ) fds[ 0 ] = fds[ 1 ] = -1 ;
+  }
+  
+  static void signalWake( int fd )
+  {
+    const char byte = 0 ;
+    
+    if( fd >= 0 ) static_cast<void>( ::write( fd, &byte, 1 ) ) ;
+  }
+  
+  /** Function to wait until any of a set of sockets is readable, or writable if it has output waiting.
+   * @param fds The sockets.
+   * @param writes Whether or not to wait for each socket to be writable too.
+   * @param readable Reference to store whether or not each socket is readable, or went away.
+   * @param writable Reference to store whether or not each socket is writable.
+   * @param microseconds The most time to wait.
+   */
+  static void waitReady( const std::vector<int>& fds, const std::vector<bool>& writes, std::vector<bool>& readable, std::vector<bool>& writable, long long microseconds )
+  {
+    std::vector<pollfd> events( fds.size() ) ;
+    struct timespec     timeout              ;
+    
+    for( size_t index = 0; index < fds.size(); index++ )
+    {
+      events[ index ].fd      = fds[ index ]                                             ;
+      events[ index ].events  = static_cast<short>( writes[ index ] ? POLLIN | POLLOUT : POLLIN ) ;
+      events[ index ].revents = 0                                                        ;
+    }
+    
+    timeout.tv_sec  = static_cast<time_t>( microseconds / 1000000 )        ;
+    timeout.tv_nsec = static_cast<long  >( microseconds % 1000000 ) * 1000 ;
+    
+    ::ppoll( events.data(), events.size(), &timeout, nullptr ) ;
+    
+    readable.assign( fds.size(), false ) ;
+    writable.assign( fds.size(), false ) ;
+    for( size_t index = 0; index < fds.size(); index++ )
+    {
+      readable[ index ] = ( events[ index ].revents & ~POLLOUT ) != 0 ;
+      writable[ index ] = ( events[ index ].revents &  POLLOUT ) != 0 ;
+    }
+  }
+#else
+  static int listenSocket( const char* )
+  {
+    std::cout << "Iris Socket Bridge: Unix domain sockets are only supported on Linux." << std::endl ;
+    return -1 ;
+  }
+  
+  static int connectSocket( const char* path )
+  {
+    return listenSocket( path ) ;
+  }
+  
+  static int  acceptSocket( int                            ) { return -1    ; }
+  static long sendSome    ( int, const char*, size_t       ) { return -1    ; }
+  static long readSome    ( int, char*, size_t             ) { return -1    ; }
+  static void closeSocket ( int                            ) {}
+  static void removeSocket( const char*                    ) {}
+  static void openWake    ( int* fds                       ) { fds[ 0 ] = fds[ 1 ] = -1 ; }
+  static void signalWake  ( int                            ) {}
+  
+  static void waitReady( const std::vector<int>& fds, const std::vector<bool>&, std::vector<bool>& readable, std::vector<bool>& writable, long long microseconds )
+  {
+    std::this_thread::sleep_for( std::chrono::microseconds( microseconds ) ) ;
+    readable.assign( fds.size(), false ) ;
+    writable.assign( fds.size(), false ) ;
+  }
+#endif
+  
+  SocketBridgeData::SocketBridgeData()
+  {
+    this->listener       = -1                           ;
+    this->batched        = 0                            ;
+    this->depth          = 0                            ;
+    this->window         = SocketBridge::DEFAULT_WINDOW ;
+    this->batch_size     = SocketBridge::DEFAULT_BATCH  ;
+    this->output_limit   = SocketBridge::DEFAULT_OUTPUT ;
+    this->running        = false                        ;
+    this->sent           = 0                            ;
+    this->sent_bytes     = 0                            ;
+    this->received       = 0                            ;
+    this->received_bytes = 0                            ;
+    this->flushes        = 0                            ;
+    this->dropped        = 0                            ;
+    
+    openWake( this->wake ) ;
+  }
+  
+  void SocketBridgeData::append( const FrameHeader& header, const void* payload )
+  {
+    const char* head = reinterpret_cast<const char*>( &header ) ;
+    const char* body = static_cast<const char*>( payload )      ;
+    
+    this->batch.insert( this->batch.end(), head, head + sizeof( FrameHeader )          ) ;
+    this->batch.insert( this->batch.end(), body, body + ( header.length & ~ANNOUNCE ) ) ;
+  }
+  
+  void SocketBridgeData::flushLocked()
+  {
+    bool written = false ;
+    bool waiting = false ;
+    
+    if( this->batch.empty() ) return ;
+    
+    for( auto connection : this->connections )
+    {
+      if( connection->broken ) continue ;
+      
+      // A peer that stopped reading only costs memory up to the limit, and never stalls the emitting thread.
+      if( connection->output.size() - connection->written + this->batch.size() > this->output_limit.load() )
+      {
+        keepAnnouncements( this->batch, connection->output ) ;
+        this->dropped += this->batched ;
+      }
+      else
+      {
+        connection->output.insert( connection->output.end(), this->batch.begin(), this->batch.end() ) ;
+        written = true ;
+      }
+      
+      if( this->writeOut( *connection ) ) waiting = true ;
+    }
+    
+    if( written )
+    {
+      this->sent       += this->batched      ;
+      this->sent_bytes += this->batch.size() ;
+      this->flushes++ ;
+    }
+    
+    // The polling thread writes the rest once the peer takes it.
+    if( waiting ) signalWake( this->wake[ 1 ] ) ;
+    
+    this->batch.clear() ;
+    this->batched = 0 ;
+  }
+  
+  bool SocketBridgeData::writeOut( BridgeConnection& connection )
+  {
+    long amount = 0 ;
+    
+    while( !connection.broken && connection.written < connection.output.size() )
+    {
+      amount = sendSome( connection.fd, connection.output.data() + connection.written, connection.output.size() - connection.written ) ;
+      
+      if( amount <  0 ) connection.broken = true ;
+      if( amount <= 0 ) break ;
+      
+      connection.written += static_cast<size_t>( amount ) ;
+    }
+    
+    if( connection.broken || connection.written == connection.output.size() )
+    {
+      connection.output.clear() ;
+      connection.written = 0 ;
+      return false ;
+    }
+    
+    return true ;
+  }
+  
+  void SocketBridgeData::addConnection( int fd )
+  {
+    BridgeConnection* connection = new BridgeConnection() ;
+    FrameHeader       header                              ;
+    const char*       name                                ;
+    
+    connection->fd      = fd    ;
+    connection->broken  = false ;
+    connection->written = 0     ;
+    
+    // Frames for topics announced in an earlier batch may still be waiting, so the new peer hears every announcement first.
+    for( auto writer : this->writers )
+    {
+      name = announcement( *writer->topic, header ) ;
+      connection->output.insert( connection->output.end(), reinterpret_cast<const char*>( &header ), reinterpret_cast<const char*>( &header ) + sizeof( header ) ) ;
+      connection->output.insert( connection->output.end(), name, name + ( header.length & ~ANNOUNCE ) ) ;
+    }
+    
+    if( this->writeOut( *connection ) ) signalWake( this->wake[ 1 ] ) ;
+    
+    this->connections.push_back( connection ) ;
+  }
+  
+  const BridgeRoute* SocketBridgeData::route( BridgeConnection& connection, std::uint32_t topic )
+  {
+    auto cached = connection.routes.find( topic ) ;
+    
+    if( cached != connection.routes.end() ) return cached->second ;
+    
+    auto name = connection.names.find( topic ) ;
+    if( name == connection.names.end() ) return nullptr ;
+    
+    auto               found = this->routes.find( name->second )                     ;
+    const BridgeRoute* route = found != this->routes.end() ? found->second : nullptr ;
+    
+    connection.routes[ topic ] = route ;
+    return route ;
+  }
+  
+  unsigned SocketBridgeData::dispatch( BridgeConnection& connection )
+  {
+    std::vector<std::max_align_t> value    ;
+    const BridgeRoute*            previous = delivering ;
+    const BridgeRoute*            route    = nullptr    ;
+    FrameHeader                   header   ;
+    size_t                        offset   = 0          ;
+    std::uint32_t                 length   = 0          ;
+    unsigned                      count    = 0          ;
+    
+    while( connection.input.size() - offset >= sizeof( FrameHeader ) )
+    {
+      std::memcpy( &header, connection.input.data() + offset, sizeof( FrameHeader ) ) ;
+      length = header.length & ~ANNOUNCE ;
+      
+      if( length > MAX_LENGTH )
+      {
+        std::scoped_lock<std::mutex> lock( this->lock ) ;
+        std::cout << "Iris Socket Bridge: Dropping a peer that sent a corrupt frame." << std::endl ;
+        connection.broken = true ;
+        break ;
+      }
+      
+      if( connection.input.size() - offset - sizeof( FrameHeader ) < length ) break ;
+      
+      const char* payload = connection.input.data() + offset + sizeof( FrameHeader ) ;
+      offset += sizeof( FrameHeader ) + length ;
+      
+      if( header.length & ANNOUNCE )
+      {
+        connection.names [ header.topic ] = { std::string( payload, length ), header.type_id } ;
+        connection.routes.erase( header.topic ) ;
+        continue ;
+      }
+      
+      route = this->route( connection, header.topic ) ;
+      if( route == nullptr || route->type_id != header.type_id || route->size != length ) continue ;
+      
+      // Copied out, as the input buffer is not aligned for the data.
+      value.resize( length / sizeof( std::max_align_t ) + 1 ) ;
+      std::memcpy( static_cast<void*>( value.data() ), payload, length ) ;
+      
+      this->received++ ;
+      delivering = route ;
+      route->receiver( this->bus, route->topic, static_cast<const void*>( value.data() ), header.idx ) ;
+      delivering = previous ;
+      count++ ;
+    }
+    
+    connection.input.erase( connection.input.begin(), connection.input.begin() + static_cast<std::ptrdiff_t>( offset ) ) ;
+    
+    return count ;
+  }
+  
+  void BridgeWriter::writeBase( const void* values, unsigned count, unsigned first )
+  {
+    const BridgeTopic& topic  = *this->topic                       ;
+    SocketBridgeData&  bridge = *topic.bridge                      ;
+    const char*        bytes  = static_cast<const char*>( values ) ;
+    FrameHeader        header ;
+    bool               empty  ;
+    
+    // This is the data being recieved on this thread, re-emitted. Sending it back would echo it forever.
+    if( count == 0 || ( delivering && delivering->topic.value == topic.topic.value && delivering->type_id == topic.type_id ) ) return ;
+    
+    std::scoped_lock<std::mutex> lock( bridge.lock ) ;
+    
+    empty          = bridge.batch.empty() ;
+    header.topic   = topic.topic.value    ;
+    header.type_id = topic.type_id        ;
+    header.length  = topic.size           ;
+    
+    for( unsigned index = 0; index < count; index++ )
+    {
+      header.idx = first + index ;
+      bridge.append( header, bytes + static_cast<size_t>( index ) * topic.size ) ;
+    }
+    
+    bridge.batched += count ;
+    
+    if( bridge.window.load() == 0 || bridge.batch.size() >= bridge.batch_size.load() )
+    {
+      bridge.flushLocked() ;
+    }
+    else if( empty )
+    {
+      // Starts the window. The polling thread writes the batch once it passes.
+      bridge.first = SocketBridgeData::Clock::now() ;
+      signalWake( bridge.wake[ 1 ] ) ;
+    }
+  }
+  
+  SocketBridge::SocketBridge()
+  {
+    this->bridge_data = new SocketBridgeData() ;
+  }
+  
+  SocketBridge::~SocketBridge()
+  {
+    this->reset() ;
+    
+    if( data().wake[ 0 ] >= 0 ) closeSocket( data().wake[ 0 ] ) ;
+    if( data().wake[ 1 ] >= 0 ) closeSocket( data().wake[ 1 ] ) ;
+    
+    delete this->bridge_data ;
+  }
+  
+  bool SocketBridge::listen( const char* path )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    
+    if( data().listener >= 0 ) return false ;
+    
+    data().listener = listenSocket( path ) ;
+    data().path     = path                 ;
+    
+    if( data().listener < 0 ) std::cout << "Iris Socket Bridge: Unable to listen on '" << path << "'." << std::endl ;
+    
+    return data().listener >= 0 ;
+  }
+  
+  bool SocketBridge::connect( const char* path )
+  {
+    const int fd = connectSocket( path ) ;
+    
+    if( fd < 0 )
+    {
+      std::cout << "Iris Socket Bridge: Unable to connect to '" << path << "'." << std::endl ;
+      return false ;
+    }
+    
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    data().addConnection( fd ) ;
+    signalWake( data().wake[ 1 ] ) ;
+    
+    return true ;
+  }
+  
+  void SocketBridge::setWindow( unsigned microseconds )
+  {
+    data().window = microseconds ;
+  }
+  
+  void SocketBridge::setBatchSize( unsigned bytes )
+  {
+    data().batch_size = bytes ;
+  }
+  
+  void SocketBridge::setOutputLimit( unsigned bytes )
+  {
+    data().output_limit = bytes ;
+  }
+  
+  BridgeWriter* SocketBridge::publishBase( TopicId topic, unsigned type_id, unsigned size )
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    BridgeTopic*                 published = new BridgeTopic()  ;
+    BridgeWriter*                writer    = new BridgeWriter() ;
+    FrameHeader                  header    ;
+    const char*                  name      ;
+    
+    published->bridge  = &data()   ;
+    published->topic   = topic     ;
+    published->type_id = type_id   ;
+    published->size    = size      ;
+    writer->topic      = published ;
+    
+    data().writers.push_back( writer ) ;
+    
+    // Queued with the data, so peers always hear of the topic before it's data.
+    name = announcement( *published, header ) ;
+    data().append( header, name ) ;
+    data().flushLocked() ;
+    
+    return writer ;
+  }
+  
+  void SocketBridge::subscribeBase( TopicId topic, unsigned type_id, unsigned size, Receiver receiver )
+  {
+    std::scoped_lock<std::recursive_mutex> lock( data().poll_lock ) ;
+    BridgeRoute*&                          route = data().routes[ { iris::topicName( topic ), type_id } ] ;
+    
+    if( route == nullptr ) route = new BridgeRoute() ;
+    
+    route->topic    = topic    ;
+    route->type_id  = type_id  ;
+    route->size     = size     ;
+    route->receiver = receiver ;
+    
+    // Topics peers already announced may now have somewhere to go.
+    std::scoped_lock<std::mutex> connections( data().lock ) ;
+    for( auto connection : data().connections ) connection->routes.clear() ;
+  }
+  
+  void SocketBridge::flush()
+  {
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    data().flushLocked() ;
+  }
+  
+  unsigned SocketBridge::poll( unsigned milliseconds )
+  {
+    using Clock = SocketBridgeData::Clock ;
+    
+    std::scoped_lock<std::recursive_mutex> lock( data().poll_lock ) ;
+    std::vector<BridgeConnection*>         connections            ;
+    std::vector<int>                       fds                    ;
+    std::vector<bool>                      writes                 ;
+    std::vector<bool>                      ready                  ;
+    std::vector<bool>                      writable               ;
+    std::vector<char>                      bytes                  ;
+    long long                              timeout = static_cast<long long>( milliseconds ) * 1000 ;
+    unsigned                               count   = 0            ;
+    long                                   amount  = 0            ;
+    char                                   drain[ 64 ]            ;
+    int                                    fd                     ;
+    
+    // Subscribers polling from inside a poll would pull frames out from under it.
+    if( data().depth != 0 ) return 0 ;
+    
+    {
+      std::scoped_lock<std::mutex> write_lock( data().lock ) ;
+      
+      connections = data().connections ;
+      
+      fds   .push_back( data().wake[ 0 ] ) ;
+      fds   .push_back( data().listener  ) ;
+      writes.assign   ( 2, false         ) ;
+      
+      for( auto connection : connections )
+      {
+        fds   .push_back( connection->fd              ) ;
+        writes.push_back( !connection->output.empty() ) ;
+      }
+      
+      if( !data().batch.empty() && data().window.load() != 0 )
+      {
+        const long long waited = std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - data().first ).count() ;
+        const long long left   = static_cast<long long>( data().window.load() ) - waited ;
+        
+        if( left < timeout ) timeout = left > 0 ? left : 0 ;
+      }
+    }
+    
+    waitReady( fds, writes, ready, writable, timeout ) ;
+    
+    if( ready[ 0 ] ) while( readSome( data().wake[ 0 ], drain, sizeof( drain ) ) > 0 ) {} ;
+    
+    if( data().listener >= 0 && ready[ 1 ] && ( fd = acceptSocket( data().listener ) ) >= 0 )
+    {
+      std::scoped_lock<std::mutex> write_lock( data().lock ) ;
+      data().addConnection( fd ) ;
+    }
+    
+    data().depth++ ;
+    
+    for( size_t index = 0; index < connections.size(); index++ )
+    {
+      BridgeConnection& connection = *connections[ index ] ;
+      
+      if( !ready[ index + 2 ] ) continue ;
+      
+      bytes.resize( READ_SIZE ) ;
+      amount = readSome( connection.fd, bytes.data(), bytes.size() ) ;
+      
+      if( amount == 0 ) continue ;
+      
+      if( amount < 0 )
+      {
+        std::scoped_lock<std::mutex> write_lock( data().lock ) ;
+        connection.broken = true ;
+        continue ;
+      }
+      
+      data().received_bytes += static_cast<unsigned long long>( amount ) ;
+      connection.input.insert( connection.input.end(), bytes.data(), bytes.data() + amount ) ;
+      count += data().dispatch( connection ) ;
+    }
+    
+    data().depth-- ;
+    
+    std::scoped_lock<std::mutex> write_lock( data().lock ) ;
+    
+    // Connections are only removed below, so every one waited on is still here.
+    for( size_t index = 0; index < connections.size(); index++ )
+    {
+      if( writable[ index + 2 ] ) data().writeOut( *connections[ index ] ) ;
+    }
+    
+    if( !data().batch.empty() && std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - data().first ).count() >= data().window.load() )
+    {
+      data().flushLocked() ;
+    }
+    
+    for( auto iter = data().connections.begin(); iter != data().connections.end(); )
+    {
+      if( ( *iter )->broken )
+      {
+        closeSocket( ( *iter )->fd ) ;
+        delete *iter ;
+        iter = data().connections.erase( iter ) ;
+      }
+      else
+      {
+        ++iter ;
+      }
+    }
+    
+    return count ;
+  }
+  
+  void SocketBridge::start()
+  {
+    if( data().running.exchange( true ) ) return ;
+    
+    data().thread = std::thread( [this] ()
+    {
+      while( this->data().running.load() )
+      {
+        this->poll( 100 ) ;
+      }
+    } ) ;
+  }
+  
+  void SocketBridge::stop()
+  {
+    if( !data().running.exchange( false ) ) return ;
+    
+    signalWake( data().wake[ 1 ] ) ;
+    data().thread.join() ;
+  }
+  
+  unsigned SocketBridge::connections() const
+  {
+    SocketBridgeData&            bridge = *this->bridge_data ;
+    std::scoped_lock<std::mutex> lock( bridge.lock )         ;
+    unsigned                     count  = 0                  ;
+    
+    for( auto connection : bridge.connections )
+    {
+      if( !connection->broken ) count++ ;
+    }
+    
+    return count ;
+  }
+  
+  BridgeStats SocketBridge::stats() const
+  {
+    return { data().sent.load(), data().sent_bytes.load(), data().received.load(), data().received_bytes.load(), data().flushes.load(), data().dropped.load() } ;
+  }
+  
+  void SocketBridge::reset()
+  {
+    this->stop() ;
+    
+    std::scoped_lock<std::recursive_mutex> poll_lock( data().poll_lock ) ;
+    
+    data().bus.clearSubscriptions() ;
+    
+    std::scoped_lock<std::mutex> lock( data().lock ) ;
+    
+    data().flushLocked() ;
+    
+    for( auto connection : data().connections )
+    {
+      closeSocket( connection->fd ) ;
+      delete connection ;
+    }
+    
+    for( auto writer : data().writers )
+    {
+      delete writer->topic ;
+      delete writer        ;
+    }
+    
+    for( auto& route : data().routes ) delete route.second ;
+    
+    if( data().listener >= 0 )
+    {
+      closeSocket ( data().listener     ) ;
+      removeSocket( data().path.c_str() ) ;
+    }
+    
+    data().connections.clear() ;
+    data().writers    .clear() ;
+    data().routes     .clear() ;
+    data().listener = -1 ;
+  }
+  
+  SocketBridgeData& SocketBridge::data()
+  {
+    return *this->bridge_data ;
+  }
+  
+  const SocketBridgeData& SocketBridge::data() const
+  {
+    return *this->bridge_data ;
+  }
+  
+  Bus& SocketBridge::bus()
+  {
+    return data().bus ;
+  }
+}
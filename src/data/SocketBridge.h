@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Bus.h"
+#include <type_traits>
+
+namespace iris
+{
+  /** Counters of the traffic through a SocketBridge.
+   */
+  struct BridgeStats
+  {
+    unsigned long long sent           ; ///< The amount of data sent to peers.
+    unsigned long long sent_bytes     ; ///< The amount of bytes written to peers, framing included.
+    unsigned long long received       ; ///< The amount of data recieved from peers.
+    unsigned long long received_bytes ; ///< The amount of bytes read from peers, framing included.
+    unsigned long long flushes        ; ///< The amount of batches written. Divided into @sent, this is the batching achieved.
+    unsigned long long dropped        ; ///< The amount of data not sent to a peer, as it had more than the output limit waiting.
+  };
+  
+  /** Object that frames the data of one topic and type for a SocketBridge.
+   * @note Made and owned by a SocketBridge. Only exists so the bridge can enroll it on it's bus.
+   */
+  class BridgeWriter
+  {
+    public:
+      /** Method to frame a batch of data and queue it to be sent.
+       * @param values The data to send.
+       * @param count The amount of data.
+       * @param first The index of the first value.
+       */
+      template<class Value>
+      void write( const Value* values, unsigned count, unsigned first ) ;
+    
+    private:
+      friend class  SocketBridge     ;
+      friend struct SocketBridgeData ;
+      
+      struct BridgeTopic* topic ;
+      
+      /** Method to frame type-erased data and queue it to be sent.
+       * @param values The data to send.
+       * @param count The amount of data.
+       * @param first The index of the first value.
+       */
+      void writeBase( const void* values, unsigned count, unsigned first ) ;
+  };
+  
+  /** Class to carry topics over a stream socket, to stand in for a network link between hosts.
+   * Data is framed as ( topic id, type hash, length, index, payload ). Frames are coalesced into a batch that is written once it fills up,
+   * or once the batching window passes since the first frame in it, whichever is first.
+   * Topic ids only mean something inside a process, so the first use of a topic is announced to peers along with it's name.
+   *
+   *   E.g.  iris::SocketBridge bridge ;
+   *         bridge.listen( "/tmp/camera.sock" ) ;        // Or bridge.connect( "/tmp/camera.sock" ) on the other end.
+   *         bridge.publish  <float>   ( "camera::gain"     ) ;
+   *         bridge.subscribe<unsigned>( "camera::exposure" ) ;
+   *         bridge.start() ;
+   *
+   * @note Only trivially-copyable data can be sent, as it is copied byte for byte. Both ends must agree on the layout of the data.
+   */
+  class SocketBridge
+  {
+    public:
+      static constexpr unsigned DEFAULT_WINDOW = 200     ; ///< The default batching window in microseconds.
+      static constexpr unsigned DEFAULT_BATCH  = 1 << 16 ; ///< The default size a batch is written at in bytes.
+      static constexpr unsigned DEFAULT_OUTPUT = 1 << 22 ; ///< The default amount of bytes a peer may have waiting to be written.
+      
+      /** Default constructor.
+       */
+      SocketBridge() ;
+      
+      /** Deconstructor. Stops and closes every connection.
+       */
+      ~SocketBridge() ;
+      
+      /** Method to accept peers on a Unix domain socket.
+       * @param path The path of the socket. Any existing file there is replaced.
+       * @return Whether or not the socket could be opened.
+       */
+      bool listen( const char* path ) ;
+      
+      /** Method to connect to a peer listening on a Unix domain socket.
+       * @param path The path of the socket.
+       * @return Whether or not the connection was made.
+       */
+      bool connect( const char* path ) ;
+      
+      /** Method to set how long frames wait to be batched with others before they are written.
+       * @param microseconds The batching window, or 0 to write every emit as it happens.
+       */
+      void setWindow( unsigned microseconds ) ;
+      
+      /** Method to set the size a batch is written at, regardless of the window.
+       * @param bytes The size of a full batch.
+       */
+      void setBatchSize( unsigned bytes ) ;
+      
+      /** Method to set how many bytes a peer may have waiting before data to it is dropped.
+       * Sockets never block. What a peer doesn't take is kept for the polling thread to write, up to this limit.
+       * Past it, the peer misses data, which is counted in BridgeStats::dropped, but still hears of every topic.
+       * @param bytes The most bytes waiting per peer.
+       */
+      void setOutputLimit( unsigned bytes ) ;
+      
+      /** Method to send the data emitted locally over a topic to every peer.
+       * @param args The arguments that make up the name of the topic.
+       */
+      template<class Value, typename ... Keys>
+      void publish( Keys... args ) ;
+      
+      /** Method to emit the data peers send over a topic to local subscribers.
+       * @param args The arguments that make up the name of the topic.
+       */
+      template<class Value, typename ... Keys>
+      void subscribe( Keys... args ) ;
+      
+      /** Method to write the current batch to every peer now.
+       */
+      void flush() ;
+      
+      /** Method to accept new peers, emit all data recieved from peers, write the batch if it's window passed and write out what peers were not ready for, on the calling thread.
+       * @param milliseconds The most time to wait for something to happen.
+       * @return The amount of data emitted.
+       */
+      unsigned poll( unsigned milliseconds = 0 ) ;
+      
+      /** Method to start a thread that polls this object continuously.
+       */
+      void start() ;
+      
+      /** Method to stop the thread started by start.
+       */
+      void stop() ;
+      
+      /** Method to retrieve the amount of peers currently connected.
+       * @return The amount of connected peers.
+       */
+      unsigned connections() const ;
+      
+      /** Method to retrieve the traffic through this bridge so far.
+       * @return The traffic counters.
+       */
+      BridgeStats stats() const ;
+      
+      /** Method to stop, close every connection and drop every publication & subscription.
+       */
+      void reset() ;
+    
+    private:
+      using Receiver = void (*)( Bus& bus, TopicId topic, const void* value, unsigned idx ) ;
+      
+      /** Static method to restore the type of data read from a peer and emit it locally.
+       * @param bus The bus to emit over.
+       * @param topic The topic to emit over.
+       * @param value Pointer to the data.
+       * @param idx The index of the data.
+       */
+      template<class Value>
+      static void receive( Bus& bus, TopicId topic, const void* value, unsigned idx ) ;
+      
+      /** Method to make a writer for a topic & type and announce it to peers.
+       * @param topic The topic.
+       * @param type_id The hash of the type of data.
+       * @param size The size of the type of data.
+       * @return The writer to enroll.
+       */
+      BridgeWriter* publishBase( TopicId topic, unsigned type_id, unsigned size ) ;
+      
+      /** Method to start emitting the data peers send over a topic & type.
+       * @param topic The topic.
+       * @param type_id The hash of the type of data.
+       * @param size The size of the type of data.
+       * @param receiver The function to emit the data with.
+       */
+      void subscribeBase( TopicId topic, unsigned type_id, unsigned size, Receiver receiver ) ;
+      
+      struct SocketBridgeData* bridge_data ;
+      SocketBridgeData& data() ;
+      const SocketBridgeData& data() const ;
+      
+      /** Method to retrieve the bus this object emits and subscribes with.
+       * @return Reference to the bus.
+       */
+      Bus& bus() ;
+  };
+  
+  template<class Value>
+  void BridgeWriter::write( const Value* values, unsigned count, unsigned first )
+  {
+    this->writeBase( static_cast<const void*>( values ), count, first ) ;
+  }
+  
+  template<class Value>
+  void SocketBridge::receive( Bus& bus, TopicId topic, const void* value, unsigned idx )
+  {
+    bus.emitIndexed( *static_cast<const Value*>( value ), idx, topic ) ;
+  }
+  
+  template<class Value, typename ... Keys>
+  void SocketBridge::publish( Keys... args )
+  {
+    static_assert( std::is_trivially_copyable<Value>::value, "Only trivially-copyable data can be sent over a socket." ) ;
+    
+    const TopicId topic  = ::iris::intern( args... ) ;
+    BridgeWriter* writer = this->publishBase( topic, typeinfo<Value>().ctti_hash, sizeof( Value ) ) ;
+    
+    this->bus().enroll( writer, &BridgeWriter::write<Value>, iris::OPTIONAL, topic ) ;
+  }
+  
+  template<class Value, typename ... Keys>
+  void SocketBridge::subscribe( Keys... args )
+  {
+    static_assert( std::is_trivially_copyable<Value>::value, "Only trivially-copyable data can be sent over a socket." ) ;
+    
+    this->subscribeBase( ::iris::intern( args... ), typeinfo<Value>().ctti_hash, sizeof( Value ), &SocketBridge::receive<Value> ) ;
+  }
+}
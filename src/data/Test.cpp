@@ -16,14 +16,28 @@
  */
 
 #include "Bus.h"
+#include "Conversion.h"
+#include "Coroutine.h"
+#include "Executor.h"
+#include "Recorder.h"
+#include "Serializer.h"
+#include "SharedBuffer.h"
+#include "SharedMemory.h"
+#include "SocketBridge.h"
 #include <stdio.h>
 #include <iostream>
 #include <thread>
+#include <chrono>
 #include <assert.h>
+#include <atomic>
 #include <float.h>
 #include <Athena/Manager.h>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <iostream>
+#include <string>
+#include <vector>
 
 static const float          TEST_VALUE   = 0.052005f       ;
 static const float          TEST_VALUE_2 = 0.254565f       ;
@@ -176,6 +190,1132 @@ bool testEmitSpeed()
   return true ;
 }
 
+bool testInternedTopic()
+{
+  iris::Bus     bus                                          ;
+  iris::TopicId topic  = iris::intern( "interned", "::", 5u ) ;
+  iris::TopicId string = iris::intern( "interned::5"        ) ;
+  
+  if( topic.value != string.value                                    ) return false ;
+  if( std::string( iris::topicName( topic ) ) != "interned::5"       ) return false ;
+  if( iris::intern( "interned::6" ).value == topic.value             ) return false ;
+  
+  v = 0.0f ;
+  bus.enroll( &setter, iris::OPTIONAL, "interned::", 5u ) ;
+  bus.emit( TEST_VALUE, topic ) ;
+  
+  return equals( v, TEST_VALUE ) ;
+}
+
+bool testTopicHandle()
+{
+  iris::Bus               bus                                                 ;
+  iris::Bus::Topic<float> handle = bus.topic<float>( "handle", "::", "value" ) ;
+  
+  v = 0.0f ;
+  handle.emit( TEST_VALUE ) ; // No subscribers yet.
+  
+  {
+    iris::Bus subscriber ;
+    subscriber.enroll( &setter, iris::OPTIONAL, "handle::value" ) ;
+    handle.emit( TEST_VALUE_2 ) ;
+    if( !equals( v, TEST_VALUE_2 ) ) return false ;
+  }
+  
+  // Subscriber's bus is gone, so this must not reach it.
+  handle.emit( TEST_VALUE_3 ) ;
+  return equals( v, TEST_VALUE_2 ) && handle.id().value == iris::intern( "handle::value" ).value ;
+}
+
+static iris::Bus reentrant_bus   ;
+static unsigned  reentrant_depth = 0 ;
+
+void reentrantSetter( unsigned val )
+{
+  reentrant_depth = val ;
+  
+  // Emitting and enrolling from inside a callback must not deadlock on the bus.
+  if( val < 3 )
+  {
+    reentrant_bus.enroll( &reentrantSetter, iris::OPTIONAL, "reentrant" ) ;
+    reentrant_bus.emit( val + 1, "reentrant" ) ;
+  }
+}
+
+bool testReentrantEmit()
+{
+  reentrant_bus.enroll( &reentrantSetter, iris::OPTIONAL, "reentrant" ) ;
+  reentrant_bus.emit( 0u, "reentrant" ) ;
+  reentrant_bus.reset() ;
+  
+  return reentrant_depth == 3 ;
+}
+
+bool testAsyncDelivery()
+{
+  iris::Bus bus ;
+  
+  v = 0.0f ;
+  bus.enroll( &setter, iris::OPTIONAL | iris::ASYNC, "async" ) ;
+  
+  std::thread producer( [] { iris::Bus emitter ; emitter.emit( TEST_VALUE, "async" ) ; } ) ;
+  producer.join() ;
+  
+  // Nothing is delivered until the subscriber drains on it's own thread.
+  if( !equals( v, 0.0f ) ) return false ;
+  if( bus.drain() != 1   ) return false ;
+  
+  return equals( v, TEST_VALUE ) && bus.drain() == 0 ;
+}
+
+static unsigned queue_last  = 0 ;
+static unsigned queue_count = 0 ;
+
+void queueSetter( unsigned val )
+{
+  queue_last = val ;
+  queue_count++ ;
+}
+
+bool testQueuePolicies()
+{
+  iris::Bus bus ;
+  
+  iris::setQueue( iris::intern( "policy::newest"   ), 2, iris::Overflow::DropNewest ) ;
+  iris::setQueue( iris::intern( "policy::oldest"   ), 2, iris::Overflow::DropOldest ) ;
+  iris::setQueue( iris::intern( "policy::coalesce" ), 2, iris::Overflow::Coalesce   ) ;
+  
+  bus.enroll( &queueSetter, iris::OPTIONAL | iris::ASYNC, "policy::newest"   ) ;
+  bus.enroll( &queueSetter, iris::OPTIONAL | iris::ASYNC, "policy::oldest"   ) ;
+  bus.enroll( &queueSetter, iris::OPTIONAL | iris::ASYNC, "policy::coalesce" ) ;
+  
+  for( unsigned i = 1; i <= 3; i++ ) bus.emit( i, "policy::newest" ) ;
+  queue_count = 0 ; bus.drain() ;
+  if( queue_count != 2 || queue_last != 2 ) return false ;
+  
+  for( unsigned i = 1; i <= 3; i++ ) bus.emit( i, "policy::oldest" ) ;
+  queue_count = 0 ; bus.drain() ;
+  if( queue_count != 2 || queue_last != 3 ) return false ;
+  
+  for( unsigned i = 1; i <= 3; i++ ) bus.emit( i, "policy::coalesce" ) ;
+  queue_count = 0 ; bus.drain() ;
+  if( queue_count != 1 || queue_last != 3 ) return false ;
+  
+  // Blocked emitters sleep until the subscriber drains, and lose nothing.
+  iris::setQueue( iris::intern( "policy::block" ), 2, iris::Overflow::Block ) ;
+  bus.enroll( &queueSetter, iris::OPTIONAL | iris::ASYNC, "policy::block" ) ;
+  queue_count = 0 ;
+  
+  std::thread producer( [] () { iris::Bus emitter ; for( unsigned i = 1; i <= 16; i++ ) emitter.emit( i, "policy::block" ) ; } ) ;
+  
+  while( queue_count != 16 )
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+    bus.drain() ;
+  }
+  producer.join() ;
+  if( queue_last != 16 ) return false ;
+  
+  return iris::queueStats( iris::intern( "policy::newest"   ) ).dropped   == 1 &&
+         iris::queueStats( iris::intern( "policy::oldest"   ) ).dropped   == 1 &&
+         iris::queueStats( iris::intern( "policy::coalesce" ) ).coalesced == 2  ;
+}
+
+using Frame = iris::SharedBuffer<std::vector<unsigned>> ;
+
+static const std::vector<unsigned>* frame_seen = nullptr ;
+static unsigned                     frame_refs = 0       ;
+
+void frameSetter( const Frame& frame )
+{
+  frame_seen = frame.get()        ;
+  frame_refs = frame.references() ;
+}
+
+bool testSharedBuffer()
+{
+  iris::Bus bus ;
+  
+  bus.enroll( &frameSetter, iris::OPTIONAL, "shared::frame" ) ;
+  
+  {
+    Frame frame = Frame::acquire( "shared::frame" ) ;
+    frame->assign( 1024, 7u ) ;
+    
+    bus.emit( frame, "shared::frame" ) ;
+    
+    // Subscribers see the publisher's storage, not a copy of it.
+    if( frame_seen != frame.get() || frame_refs != 1 ) return false ;
+  }
+  
+  // The last handle is gone, so the next acquire reuses the same storage.
+  Frame next = Frame::acquire( "shared::frame" ) ;
+  return next.get() == frame_seen && next->size() == 1024 && next.references() == 1 ;
+}
+
+static constexpr char STATIC_TOPIC[] = "static::topic" ;
+
+bool testStaticTopic()
+{
+  using Topic = iris::StaticTopic<STATIC_TOPIC> ;
+  
+  iris::Bus bus ;
+  
+  // Both are known to the compiler, so this costs nothing at runtime.
+  static_assert( iris::typeinfo<float>().ctti_hash != iris::typeinfo<unsigned>().ctti_hash, "Type ids must differ." ) ;
+  static_assert( Topic::hash == iris::hash( STATIC_TOPIC, 0, iris::length( STATIC_TOPIC ) ), "Topic hashes must be known to the compiler." ) ;
+  static_assert( Topic::length == 13, "Topic lengths must be known to the compiler." ) ;
+  
+  if( iris::intern( Topic() ).value != iris::intern( "static::topic" ).value     ) return false ;
+  
+  v = 0.0f ;
+  bus.enroll( &setter, iris::OPTIONAL, Topic() ) ;
+  bus.emit( TEST_VALUE, "static::topic" ) ;
+  if( !equals( v, TEST_VALUE ) ) return false ;
+  
+  bus.emit( TEST_VALUE_2, Topic() ) ;
+  return equals( v, TEST_VALUE_2 ) && iris::intern( Topic(), "::sub" ).value == iris::intern( "static::topic::sub" ).value ;
+}
+
+static unsigned batch_calls = 0 ;
+static unsigned batch_count = 0 ;
+static unsigned batch_first = 0 ;
+static unsigned batch_sum   = 0 ;
+static unsigned element_sum = 0 ;
+static unsigned element_idx = 0 ;
+
+void batchSetter( const unsigned* values, unsigned count, unsigned first )
+{
+  batch_calls++ ;
+  batch_count = count ;
+  batch_first = first ;
+  
+  for( unsigned i = 0; i < count; i++ ) batch_sum += values[ i ] ;
+}
+
+void elementSetter( unsigned idx, unsigned value )
+{
+  element_sum += value ;
+  element_idx  = idx   ;
+}
+
+bool testBatchEmit()
+{
+  iris::Bus batch_bus   ;
+  iris::Bus element_bus ;
+  unsigned  values[ 100 ] ;
+  
+  for( unsigned i = 0; i < 100; i++ ) values[ i ] = i + 1 ;
+  
+  batch_bus  .enroll( &batchSetter  , iris::OPTIONAL, "batch::values" ) ;
+  element_bus.enroll( &elementSetter, iris::OPTIONAL, "batch::values" ) ;
+  
+  // Batch subscribers get the whole array in one call, indexed ones get every element in order.
+  batch_bus.emitBatch( values, 100, 10, "batch::values" ) ;
+  if( batch_calls != 1 || batch_count != 100 || batch_first != 10 || batch_sum != 5050 ) return false ;
+  if( element_sum != 5050 || element_idx != 109                                         ) return false ;
+  
+  // Single values reach batch subscribers as a batch of one.
+  batch_bus.topic<unsigned>( "batch::values" ).emitIndexed( 7u, 3 ) ;
+  return batch_calls == 2 && batch_count == 1 && batch_first == 3 && batch_sum == 5057 && element_idx == 3 ;
+}
+
+struct RetainedReader
+{
+  iris::Bus bus      ;
+  unsigned  last = 0 ;
+  
+  void set( unsigned val ) { this->last = val ; }
+};
+
+struct Labelled
+{
+  unsigned value ;
+  
+  explicit Labelled( unsigned val ) : value( val ) {}
+  Labelled( const Labelled& label ) = default ;
+  Labelled& operator=( const Labelled& label ) = delete ;
+};
+
+static unsigned label_last = 0 ;
+
+void labelSetter( const Labelled& label )
+{
+  label_last = label.value ;
+}
+
+void uniqueSetter( const std::unique_ptr<unsigned>& value )
+{
+  label_last = *value ;
+}
+
+struct Reentrant
+{
+  bool armed = false ;
+  
+  ~Reentrant()
+  {
+    // Enrolling and dropping a subscription retires data of it's own.
+    if( this->armed )
+    {
+      iris::Bus bus ;
+      bus.enroll( &setter, iris::OPTIONAL, "retained::inner" ) ;
+    }
+  }
+};
+
+bool testRetainedTopic()
+{
+  const iris::TopicId topic    = iris::intern( "retained::value" ) ;
+  unsigned            values[] = { 1, 2, 3, 4 }                    ;
+  
+  iris::setRetained( topic, true ) ;
+  
+  {
+    iris::Bus bus ;
+    
+    // Nobody is subscribed yet, so only the topic sees this.
+    v = 0.0f ;
+    bus.emit( TEST_VALUE_3, topic ) ;
+    bus.emitBatch( values, 4, 0, topic ) ;
+  }
+  
+  iris::Bus late_bus ;
+  
+  element_sum = 0 ;
+  late_bus.enroll( &setter       , iris::OPTIONAL, topic ) ;
+  late_bus.enroll( &elementSetter, iris::OPTIONAL, topic ) ;
+  if( !equals( v, TEST_VALUE_3 ) || element_sum != 10 || element_idx != 3 ) return false ;
+  
+  // Retention is counted, so the topic keeps it's data until everyone that retained it lets go.
+  iris::setRetained( topic, true  ) ;
+  iris::setRetained( topic, false ) ;
+  
+  iris::Bus kept_bus ;
+  
+  v = 0.0f ;
+  kept_bus.enroll( &setter, iris::OPTIONAL, topic ) ;
+  if( !equals( v, TEST_VALUE_3 ) ) return false ;
+  
+  // Turning retention off drops what was kept.
+  iris::setRetained( topic, false ) ;
+  
+  iris::Bus later_bus ;
+  
+  v = 0.0f ;
+  later_bus.enroll( &setter, iris::OPTIONAL, topic ) ;
+  if( !equals( v, 0.0f ) ) return false ;
+  
+  // Subscriptions enrolled while the topic is emitted to end up with the latest data, never older retained data.
+  const iris::TopicId ordered = iris::intern( "retained::ordered" ) ;
+  RetainedReader      readers[ 32 ] ;
+  
+  iris::setRetained( ordered, true ) ;
+  
+  std::thread producer( [ordered] () { iris::Bus emitter ; for( unsigned i = 1; i <= 2000; i++ ) emitter.emit( i, ordered ) ; } ) ;
+  
+  for( auto& reader : readers ) reader.bus.enroll( &reader, &RetainedReader::set, iris::OPTIONAL, ordered ) ;
+  producer.join() ;
+  iris::setRetained( ordered, false ) ;
+  
+  for( const auto& reader : readers )
+  {
+    if( reader.last != 2000 ) return false ;
+  }
+  
+  // Types without a default constructor or assignment are retained by copy construction.
+  const iris::TopicId labelled = iris::intern( "retained::labelled" ) ;
+  const Labelled      label( 7 )                                    ;
+  
+  iris::setRetained( labelled, true ) ;
+  
+  {
+    iris::Bus bus ;
+    bus.emit( label, labelled ) ;
+  }
+  
+  iris::Bus label_bus ;
+  
+  label_bus.enroll( &labelSetter, iris::OPTIONAL, labelled ) ;
+  iris::setRetained( labelled, false ) ;
+  if( label_last != 7 ) return false ;
+  
+  // Move-only data can not be retained, but is still emitted.
+  const iris::TopicId unique = iris::intern( "retained::unique" ) ;
+  
+  iris::setRetained( unique, true ) ;
+  label_bus.enroll( &uniqueSetter, iris::OPTIONAL, unique ) ;
+  label_bus.emit( std::make_unique<unsigned>( 9u ), unique ) ;
+  iris::setRetained( unique, false ) ;
+  if( label_last != 9 ) return false ;
+  
+  // Releasing retired data can retire more on the same thread without deadlocking.
+  const iris::TopicId reentrant = iris::intern( "retained::reentrant" ) ;
+  Reentrant           armed                                          ;
+  
+  armed.armed = true ;
+  iris::setRetained( reentrant, true ) ;
+  label_bus.emit( armed, reentrant ) ;
+  label_bus.emit( Reentrant(), reentrant ) ;
+  iris::setRetained( reentrant, false ) ;
+  
+  for( unsigned i = 0; i < 4; i++ ) label_bus.emit( 0u, reentrant ) ;
+  
+  return true ;
+}
+
+bool testSubscribedTypes()
+{
+  const iris::TopicId topic = iris::intern( "bound::parameter" ) ;
+  unsigned            types[ 4 ] ;
+  iris::Bus           bus        ;
+  iris::Bus           universal  ;
+  
+  if( iris::subscribedTypes( topic, types, 4 ) != 0 ) return false ;
+  
+  // Subscriptions without data take any type, so they want none in particular.
+  universal.enroll( &blankSetter, iris::OPTIONAL, topic ) ;
+  if( iris::subscribedTypes( topic, types, 4 ) != 0 ) return false ;
+  
+  bus.enroll( &setter, iris::OPTIONAL, topic ) ;
+  
+  // Only the float subscription is listed, so a publisher knows to convert to nothing else.
+  return iris::subscribedTypes( topic, types, 4 ) == 1 && types[ 0 ] == iris::typeinfo<float>().ctti_hash ;
+}
+
+bool testPullTopic()
+{
+  iris::Bus bus ;
+  
+  for( auto& value : index ) value = 0 ;
+  
+  bus.enroll ( &setter       , iris::OPTIONAL, "pull::value"   ) ;
+  bus.publish( &getter       , "pull::value"                   ) ;
+  bus.enroll ( &indexedSetter, iris::OPTIONAL, "pull::indexed" ) ;
+  bus.publish( &indexedGetter, "pull::indexed"                 ) ;
+  
+  // Only the publisher of the pulled topic runs.
+  v = 0.0f ;
+  bus.pull( 2, "pull::indexed" ) ;
+  if( index[ 2 ] != TEST_ARR[ 2 ] || !equals( v, 0.0f ) ) return false ;
+  
+  bus.pull( 0, iris::intern( "pull::value" ) ) ;
+  return equals( v, TEST_VALUE_2 ) && index[ 0 ] == 0 ;
+}
+
+static unsigned wildcard_count = 0 ;
+
+void wildcardSetter( unsigned val )
+{
+  wildcard_count += val ;
+}
+
+bool testWildcardTopic()
+{
+  iris::Bus publisher ;
+  
+  // Made before the subscription, so it is matched when it enrolls.
+  iris::intern( "wild_0::before" ) ;
+  
+  {
+    iris::Bus bus ;
+    
+    bus.enroll( &wildcardSetter, iris::OPTIONAL, "wild_0::*"         ) ;
+    bus.enroll( &wildcardSetter, iris::OPTIONAL, "wild_graph_*_stop" ) ;
+    
+    publisher.emit( 1u, "wild_0::before" ) ;
+    publisher.emit( 2u, "wild_0::after"  ) ;
+    publisher.emit( 4u, "wild_1::after"  ) ;
+    if( wildcard_count != 3 ) return false ;
+    
+    publisher.emit( 8u , "wild_graph_3_stop"  ) ;
+    publisher.emit( 16u, "wild_graph_3_start" ) ;
+    if( wildcard_count != 11 ) return false ;
+  }
+  
+  // The subscriptions left with their bus.
+  publisher.emit( 32u, "wild_0::after" ) ;
+  return wildcard_count == 11 ;
+}
+
+bool testBusStats()
+{
+  iris::Bus     bus                                   ;
+  iris::TopicId topic = iris::intern( "metrics::value" ) ;
+  
+  bus.enroll( &wildcardSetter, iris::OPTIONAL, topic ) ;
+  bus.emit( 0u, topic ) ;
+  bus.emit( 0u, topic ) ;
+  
+  const iris::BusStats stats = iris::Bus::stats() ;
+  
+  // Built without IRIS_BUS_METRICS, so nothing is recorded.
+  if( stats.topicCount() == 0 ) return stats.subscriberCount() == 0 && stats.output() != nullptr ;
+  
+  for( unsigned index = 0; index < stats.topicCount(); index++ )
+  {
+    if( stats.topic( index ).topic.value == topic.value && ( stats.topic( index ).emits != 2 || stats.topic( index ).deliveries != 2 ) ) return false ;
+  }
+  
+  for( unsigned index = 0; index < stats.subscriberCount(); index++ )
+  {
+    if( stats.subscriber( index ).topic.value == topic.value ) return stats.subscriber( index ).calls == 2 ;
+  }
+  
+  return false ;
+}
+
+static std::atomic<unsigned> shared_count( 0 ) ;
+
+void sharedSetter( unsigned val )
+{
+  shared_count += val ;
+}
+
+bool testSharedTransport()
+{
+  iris::SharedTransport sender   ;
+  iris::SharedTransport receiver ;
+  iris::Bus             local    ;
+  
+  iris::SharedTransport::unlink( "iris_bus_test" ) ;
+  if( !sender.initialize( "iris_bus_test", 1u << 20, 8 ) || !receiver.initialize( "iris_bus_test" ) ) return false ;
+  iris::SharedTransport::unlink( "iris_bus_test" ) ;
+  
+  local   .enroll   ( &sharedSetter, iris::OPTIONAL, "shared::value" ) ;
+  sender  .publish  <unsigned>( "shared::value" ) ;
+  receiver.subscribe<unsigned>( "shared::value" ) ;
+  
+  // Both ends are in this process, so the local subscriber sees the emit itself and then the receiver's copy. The copy is not sent back out.
+  local.emit( 2u, "shared::value" ) ;
+  if( shared_count != 2 || receiver.poll() != 1 || shared_count != 4 || receiver.poll() != 0 ) return false ;
+  
+  // Overflowing the ring loses the oldest data.
+  for( unsigned count = 0; count < 10; count++ ) local.emit( 0u, "shared::value" ) ;
+  if( receiver.poll() != 8 || receiver.dropped() != 2 ) return false ;
+  
+  receiver.start() ;
+  local.emit( 3u, "shared::value" ) ;
+  
+  for( unsigned tries = 0; tries < 1000 && shared_count != 10; tries++ ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+  
+  receiver.stop() ;
+  if( shared_count != 10 ) return false ;
+  
+  // Resetting while another thread emits leaves it's writers alive until that emit is done with them.
+  std::atomic<bool> emitting( true ) ;
+  
+  sender.publish<unsigned>( "shared::reset" ) ;
+  
+  std::thread emitter( [&emitting] () { iris::Bus bus ; while( emitting.load() ) bus.emit( 1u, "shared::reset" ) ; } ) ;
+  
+  std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) ) ;
+  sender.reset() ;
+  std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) ) ;
+  
+  emitting = false ;
+  emitter.join() ;
+  
+  return true ;
+}
+
+static std::atomic<unsigned> bridge_count( 0 ) ;
+
+void bridgeSetter( unsigned val )
+{
+  bridge_count += val ;
+}
+
+bool testSocketBridge()
+{
+  static const unsigned COUNT = 20000 ;
+  
+  iris::SocketBridge server ;
+  iris::SocketBridge client ;
+  iris::Bus          local  ;
+  
+  if( !server.listen( "/tmp/iris_bus_test.sock" ) || !client.connect( "/tmp/iris_bus_test.sock" ) ) return false ;
+  
+  local .enroll   ( &bridgeSetter, iris::OPTIONAL, "bridge::value" ) ;
+  client.publish  <unsigned>( "bridge::value" ) ;
+  server.subscribe<unsigned>( "bridge::value" ) ;
+  client.setWindow( 500 ) ;
+  server.start() ;
+  client.start() ;
+  
+  // The local subscriber sees every emit itself, then again once the server recieves it. The server's copy is not sent back.
+  for( unsigned count = 0; count < COUNT; count++ ) local.emit( 1u, "bridge::value" ) ;
+  for( unsigned tries = 0; tries < 5000 && bridge_count != 2 * COUNT; tries++ ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+  
+  client.stop() ;
+  server.stop() ;
+  
+  const iris::BridgeStats sent     = client.stats() ;
+  const iris::BridgeStats received = server.stats() ;
+  
+  return bridge_count == 2 * COUNT && sent.sent == COUNT && received.received == COUNT && sent.flushes < COUNT && sent.dropped == 0 ;
+}
+
+bool testSocketBridgeOverflow()
+{
+  static const unsigned COUNT = 100000 ;
+  
+  iris::SocketBridge server ;
+  iris::SocketBridge client ;
+  iris::Bus          local  ;
+  
+  // The server is never polled, so it never reads and the socket fills up.
+  if( !server.listen( "/tmp/iris_bus_overflow.sock" ) || !client.connect( "/tmp/iris_bus_overflow.sock" ) ) return false ;
+  
+  client.publish<unsigned>( "bridge::overflow" ) ;
+  client.setWindow     ( 0       ) ;
+  client.setOutputLimit( 1 << 16 ) ;
+  
+  // Emitting carries on past the limit instead of waiting on the peer.
+  for( unsigned count = 0; count < COUNT; count++ ) local.emit( count, "bridge::overflow" ) ;
+  
+  const iris::BridgeStats stats = client.stats() ;
+  
+  return stats.dropped != 0 && stats.sent + stats.dropped == COUNT ;
+}
+
+static std::atomic<unsigned> replay_count( 0 ) ;
+static unsigned              replay_index[ 4 ] ;
+static float                 replay_value = 0.0f ;
+
+void replaySetter( unsigned idx, unsigned val )
+{
+  replay_index[ idx % 4 ] = val ;
+  replay_count++ ;
+}
+
+void replayFloatSetter( float val )
+{
+  replay_value = val ;
+}
+
+bool testRecorder()
+{
+  static const unsigned COUNT = 1000 ;
+  
+  iris::Recorder recorder       ;
+  iris::Replayer replayer       ;
+  iris::Bus      local          ;
+  unsigned       batch[ COUNT ] ;
+  
+  for( unsigned index = 0; index < COUNT; index++ ) batch[ index ] = index ;
+  
+  // Small segments, so the log rolls over a few times.
+  if( !recorder.initialize( "/tmp/iris_bus_test.log", 16u << 10 ) ) return false ;
+  
+  recorder.record<unsigned>( "record::indexed" ) ;
+  recorder.record<float>   ( "record::value"   ) ;
+  
+  for( unsigned count = 0; count < COUNT; count++ ) local.emitIndexed( count, count, "record::indexed" ) ;
+  local.emit( TEST_VALUE_3, "record::value" ) ;
+  
+  // Larger than a segment, so it is split across a few.
+  local.emitBatch( batch, COUNT, 0, "record::indexed" ) ;
+  
+  recorder.stop() ;
+  local.emit( TEST_VALUE_2, "record::value" ) ; // Not recorded.
+  if( recorder.count() != 2 * COUNT + 1 ) return false ;
+  
+  local.enroll( &replaySetter     , iris::OPTIONAL, "record::indexed" ) ;
+  local.enroll( &replayFloatSetter, iris::OPTIONAL, "record::value"   ) ;
+  
+  if( !replayer.initialize( "/tmp/iris_bus_test.log" ) ) return false ;
+  
+  replayer.setSpeed( 0.0 ) ;
+  if( replayer.replay() != 2 * COUNT + 1 ) return false ;
+  
+  return replay_count == 2 * COUNT && replay_index[ 1 ] == COUNT - 3 && replay_index[ 3 ] == COUNT - 1 && equals( replay_value, TEST_VALUE_3 ) ;
+}
+
+struct Waypoints
+{
+  std::string        name   ;
+  std::vector<float> points ;
+};
+
+template<>
+struct iris::Serializer<Waypoints>
+{
+  static constexpr bool trivial = false ;
+  
+  static unsigned size( const Waypoints& value )
+  {
+    return Serializer<std::string>::size( value.name ) + Serializer<std::vector<float>>::size( value.points ) ;
+  }
+  
+  static unsigned write( const Waypoints& value, unsigned char* out )
+  {
+    const unsigned used = Serializer<std::string>::write( value.name, out ) ;
+    return used + Serializer<std::vector<float>>::write( value.points, out + used ) ;
+  }
+  
+  static unsigned read( Waypoints& value, const unsigned char* in, unsigned length )
+  {
+    const unsigned used = Serializer<std::string>::read( value.name, in, length ) ;
+    const unsigned rest = used != 0 ? Serializer<std::vector<float>>::read( value.points, in + used, length - used ) : 0 ;
+    
+    return rest != 0 ? used + rest : 0 ;
+  }
+};
+
+static Waypoints serialized_waypoints ;
+
+void waypointSetter( const Waypoints& val )
+{
+  serialized_waypoints = val ;
+}
+
+bool testSerializer()
+{
+  const std::vector<std::string> names     = { "a", "", "camera" } ;
+  const Waypoints                waypoints = { "route", { 1.0f, 2.0f, 3.0f } } ;
+  unsigned char                  bytes[ 128 ] ;
+  std::vector<std::string>       names_out ;
+  float                          value_out = 0.0f ;
+  iris::Bus                      bus ;
+  
+  // Trivial types are a single copy of their bytes.
+  if( iris::Serializer<float>::write( TEST_VALUE_2, bytes ) != sizeof( float ) || iris::Serializer<float>::read( value_out, bytes, sizeof( float ) ) != sizeof( float ) || !equals( value_out, TEST_VALUE_2 ) ) return false ;
+  
+  // Nested strings & vectors are length prefixed, and a short read fails instead of running off the end.
+  const unsigned size = iris::Serializer<std::vector<std::string>>::size( names ) ;
+  if( size != 4 + 5 + 4 + 10 || iris::Serializer<std::vector<std::string>>::write( names, bytes ) != size ) return false ;
+  if( iris::Serializer<std::vector<std::string>>::read( names_out, bytes, size - 1 ) != 0 ) return false ;
+  if( iris::Serializer<std::vector<std::string>>::read( names_out, bytes, size ) != size || names_out != names ) return false ;
+  
+  // User types are found by their hash once registered, and can be emitted by code that never sees the type.
+  if( iris::findSerializer( iris::typeinfo<Waypoints>().ctti_hash ) != nullptr ) return false ;
+  iris::registerSerializer<Waypoints>() ;
+  
+  const iris::SerializerEntry* entry = iris::findSerializer( iris::typeinfo<Waypoints>().ctti_hash ) ;
+  const iris::SerializerEntry* text  = iris::findSerializer( iris::typeinfo<std::string>().ctti_hash ) ;
+  if( entry == nullptr || text == nullptr || entry->trivial || !iris::findSerializer( iris::typeinfo<float>().ctti_hash )->trivial ) return false ;
+  
+  const unsigned written = entry->write( static_cast<const void*>( &waypoints ), bytes ) ;
+  if( written != entry->size( static_cast<const void*>( &waypoints ) ) ) return false ;
+  
+  bus.enroll( &waypointSetter, iris::OPTIONAL, "serializer::waypoints" ) ;
+  return entry->emit( bus, iris::intern( "serializer::waypoints" ), bytes, written, 0 ) == written && serialized_waypoints.name == "route" && serialized_waypoints.points == waypoints.points ;
+}
+
+static std::atomic<unsigned> executed( 0 ) ;
+
+void executeTask( void* argument )
+{
+  executed += *static_cast<unsigned*>( argument ) ;
+}
+
+bool testExecutor()
+{
+  iris::Executor executor ;
+  unsigned       amount = 2 ;
+  
+  executor.post( &executeTask, &amount ) ;
+  executor.post( &executeTask, &amount ) ;
+  if( executor.pending() != 2 || executor.run() != 2 || executed != 4 ) return false ;
+  
+  executor.start( 2 ) ;
+  for( unsigned count = 0; count < 100; count++ ) executor.post( &executeTask, &amount ) ;
+  for( unsigned tries = 0; tries < 1000 && executed != 204; tries++ ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+  executor.stop() ;
+  
+  return executed == 204 ;
+}
+
+#ifdef IRIS_COROUTINES
+static std::atomic<unsigned> awaited_sum  ( 0 ) ;
+static std::atomic<bool>     awaited_done ( false ) ;
+
+iris::Task sumPipeline( iris::Bus& bus, iris::Executor& executor, unsigned count )
+{
+  auto values = bus.stream<unsigned>( "coroutine::values" ) ;
+  
+  co_await executor.schedule() ;
+  
+  for( unsigned index = 0; index < count; index++ )
+  {
+    awaited_sum += co_await values.next() ;
+    if( values.index() != index ) co_return ;
+  }
+  
+  // Awaiting by topic reuses the stream, so nothing emitted in between is missed.
+  awaited_sum  += co_await bus.next<unsigned>( "coroutine::values" ) ;
+  awaited_done  = true ;
+}
+
+bool testCoroutine()
+{
+  static const unsigned COUNT = 1000 ;
+  
+  iris::Executor executor ;
+  iris::Bus      local    ;
+  iris::Bus      bus      ;
+  
+  executor.start( 1 ) ;
+  bus.setExecutor( &executor ) ;
+  iris::setQueue( iris::intern( "coroutine::values" ), 64, iris::Overflow::Block ) ;
+  
+  sumPipeline( bus, executor, COUNT ) ;
+  
+  for( unsigned count = 0; count < COUNT; count++ ) local.emitIndexed( 1u, count, "coroutine::values" ) ;
+  local.emit( 5u, "coroutine::values" ) ;
+  
+  for( unsigned tries = 0; tries < 2000 && !awaited_done; tries++ ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+  
+  executor.stop() ;
+  if( !awaited_done || awaited_sum != COUNT + 5 ) return false ;
+  
+  // The handle keeps the stream's queue alive once a callback replaces it.
+  auto replaced = bus.stream<unsigned>( "coroutine::replaced" ) ;
+  
+  bus.enroll( &wildcardSetter, iris::OPTIONAL, "coroutine::replaced" ) ;
+  local.emit( 1u, "coroutine::replaced" ) ;
+  
+  return replaced.index() == 0 ;
+}
+#endif
+
+struct Query
+{
+  unsigned id    ;
+  float    input ;
+};
+
+float squareServer( const Query& query )
+{
+  return query.input * query.input ;
+}
+
+class InferenceServer
+{
+  public:
+    unsigned served = 0 ;
+    
+    float run( const Query& query )
+    {
+      this->served++ ;
+      return query.input + static_cast<float>( query.id ) ;
+    }
+};
+
+bool testRequestReply()
+{
+  iris::Bus       client ;
+  iris::Bus       server ;
+  InferenceServer inference ;
+  
+  // A synchronous server answers before the request returns.
+  server.serve( &squareServer, iris::OPTIONAL, "rpc::square" ) ;
+  auto square = client.request<float>( Query{ 0, 3.0f }, "rpc::square" ) ;
+  if( !square.ready() || !square.answered() || !equals( square.get(), 9.0f ) ) return false ;
+  
+  // Nobody serves this topic, so the request finishes unanswered instead of hanging.
+  auto lost = client.request<float>( Query{ 0, 3.0f }, "rpc::nobody" ) ;
+  if( !lost.ready() || lost.answered() || !equals( lost.get(), 0.0f ) ) return false ;
+  
+  // An ASYNC server queues requests, so several are outstanding until it drains.
+  server.serve( &inference, &InferenceServer::run, iris::OPTIONAL | iris::ASYNC, "rpc::inference" ) ;
+  
+  iris::Bus::Reply<float> replies[ 3 ] ;
+  for( unsigned index = 0; index < 3; index++ ) replies[ index ] = client.request<float>( Query{ index, 0.5f }, "rpc::inference" ) ;
+  
+  if( replies[ 0 ].ready() || replies[ 2 ].wait( 1 ) ) return false ;
+  
+  std::thread worker( [&server] () { server.drain() ; } ) ;
+  
+  for( unsigned index = 0; index < 3; index++ )
+  {
+    if( !equals( replies[ index ].get(), 0.5f + index ) ) { worker.join() ; return false ; }
+  }
+  
+  worker.join() ;
+  if( inference.served != 3 ) return false ;
+  
+  // A request shed by a full queue, or dropped along with it's mailbox, finishes unanswered instead of hanging.
+  iris::Bus shedder ;
+  
+  iris::setQueue( iris::intern( "rpc::shed" ), 2, iris::Overflow::DropNewest ) ;
+  shedder.serve( &inference, &InferenceServer::run, iris::OPTIONAL | iris::ASYNC, "rpc::shed" ) ;
+  
+  iris::Bus::Reply<float> queued[ 2 ] ;
+  for( unsigned index = 0; index < 2; index++ ) queued[ index ] = client.request<float>( Query{ index, 1.0f }, "rpc::shed" ) ;
+  
+  auto shed = client.request<float>( Query{ 2, 1.0f }, "rpc::shed" ) ;
+  if( queued[ 0 ].ready() || !shed.ready() || shed.answered() ) return false ;
+  
+  shedder.reset() ;
+  
+  for( unsigned index = 0; index < 2; index++ )
+  {
+    if( !queued[ index ].wait( 1000 ) || queued[ index ].answered() ) return false ;
+  }
+  
+  return inference.served == 3 ;
+}
+
+static unsigned limit_last  = 0 ;
+static unsigned limit_count = 0 ;
+
+void limitSetter( unsigned val )
+{
+  limit_last = val ;
+  limit_count++ ;
+}
+
+bool testRateLimits()
+{
+  iris::Bus bus ;
+  
+  bus.limit( iris::Limit::Throttle, 100, "limit::throttle" ) ;
+  bus.limit( iris::Limit::Latest  , 100, "limit::latest"   ) ;
+  bus.limit( iris::Limit::Debounce, 100, "limit::debounce" ) ;
+  bus.limit( iris::Limit::Throttle, 100, "limit::async"    ) ;
+  
+  bus.enroll( &limitSetter, iris::OPTIONAL              , "limit::throttle" ) ;
+  bus.enroll( &limitSetter, iris::OPTIONAL              , "limit::latest"   ) ;
+  bus.enroll( &limitSetter, iris::OPTIONAL              , "limit::debounce" ) ;
+  bus.enroll( &limitSetter, iris::OPTIONAL | iris::ASYNC, "limit::async"    ) ;
+  
+  // Throttling lets the first data of a period through, and drops the rest.
+  limit_count = 0 ;
+  for( unsigned i = 1; i <= 100; i++ ) bus.emit( i, "limit::throttle" ) ;
+  if( limit_count != 1 || limit_last != 1 ) return false ;
+  
+  // Keeping the latest also lets the first data through, but holds the rest until the period ends.
+  limit_count = 0 ;
+  for( unsigned i = 1; i <= 100; i++ ) bus.emit( i, "limit::latest" ) ;
+  if( limit_count != 1 || limit_last != 1 || bus.drain() != 0 ) return false ;
+  
+  // Debouncing holds everything until the topic goes quiet.
+  limit_count = 0 ;
+  for( unsigned i = 1; i <= 100; i++ ) bus.emit( i, "limit::debounce" ) ;
+  if( limit_count != 0 ) return false ;
+  
+  // Data that is let through an ASYNC subscription is still queued for draining.
+  for( unsigned i = 1; i <= 100; i++ ) bus.emit( i, "limit::async" ) ;
+  if( limit_count != 0 || bus.drain() != 1 || limit_last != 1 ) return false ;
+  
+  // Held data is not flushed on it's own, however long the topics stay quiet.
+  limit_count = 0 ;
+  std::this_thread::sleep_for( std::chrono::milliseconds( 150 ) ) ;
+  if( limit_count != 0 ) return false ;
+  
+  if( bus.drain() != 2 || limit_count != 2 || limit_last != 100 || bus.drain() != 0 ) return false ;
+  
+  limit_count = 0 ;
+  bus.emit( 101u, "limit::throttle" ) ;
+  return limit_count == 1 && limit_last == 101 ;
+}
+
+static std::atomic<unsigned> required_count( 0 ) ;
+
+void requiredSetter( unsigned val )
+{
+  required_count += val ;
+}
+
+bool testRequiredWait()
+{
+  iris::Bus bus ;
+  
+  // Nothing is required yet, so there is nothing to wait on.
+  if( !bus.wait( 0 ) ) return false ;
+  
+  bus.enroll( &requiredSetter, iris::REQUIRED, "wait::first"    ) ;
+  bus.enroll( &setter        , iris::REQUIRED, "wait::second"   ) ;
+  bus.enroll( &queueSetter   , iris::OPTIONAL, "wait::optional" ) ;
+  
+  bus.emit( 1u, "wait::first"    ) ;
+  bus.emit( 1u, "wait::first"    ) ;
+  bus.emit( 1u, "wait::optional" ) ;
+  if( bus.wait( 1 ) ) return false ;
+  
+  // Data that arrived before a timed out wait still counts toward the next one.
+  bus.emit( TEST_VALUE, "wait::second" ) ;
+  if( !bus.wait( 0 ) || bus.wait( 1 ) ) return false ;
+  
+  std::thread producer( [] ()
+  {
+    iris::Bus emitter ;
+    
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) ) ;
+    emitter.emit( 2u, "wait::first" ) ;
+    emitter.emit( TEST_VALUE_2, "wait::second" ) ;
+  } ) ;
+  
+  bus.wait() ;
+  producer.join() ;
+  if( required_count != 4 || !equals( v, TEST_VALUE_2 ) ) return false ;
+  
+  // Enrolled again as optional, so only the other subscription is waited on.
+  bus.enroll( &requiredSetter, iris::OPTIONAL, "wait::first" ) ;
+  bus.emit( TEST_VALUE, "wait::second" ) ;
+  if( !bus.wait( 0 ) ) return false ;
+  
+  // A wildcard is satisfied by any topic it matches.
+  bus.enroll( &wildcardSetter, iris::REQUIRED, "wait::wild_*" ) ;
+  bus.emit( TEST_VALUE, "wait::second" ) ;
+  if( bus.wait( 1 ) ) return false ;
+  
+  bus.emit( 1u, "wait::wild_0" ) ;
+  if( !bus.wait( 0 ) ) return false ;
+  
+  // Replaced by an optional one, so it is no longer waited on.
+  bus.enroll( &wildcardSetter, iris::OPTIONAL, "wait::wild_*" ) ;
+  bus.emit( TEST_VALUE, "wait::second" ) ;
+  
+  return bus.wait( 0 ) ;
+}
+
+static const float* moved_data   = nullptr ;
+static const float* borrowed_data = nullptr ;
+
+void ownedSetter( std::vector<float>&& val )
+{
+  std::vector<float> owned( std::move( val ) ) ;
+  moved_data = owned.data() ;
+}
+
+void borrowedSetter( const std::vector<float>& val )
+{
+  borrowed_data = val.data() ;
+}
+
+bool testMoveEmit()
+{
+  iris::Bus          bus                      ;
+  iris::Bus          reader                   ;
+  std::vector<float> buffer( 64, TEST_VALUE ) ;
+  const float*       original = buffer.data() ;
+  
+  // The only subscriber owns it's data, so the buffer is handed over instead of copied.
+  bus.enroll( &ownedSetter, iris::OPTIONAL, "move::single" ) ;
+  bus.emit( std::move( buffer ), "move::single" ) ;
+  if( moved_data != original ) return false ;
+  
+  // Earlier subscribers read the data in place, and only the last one takes it.
+  buffer.assign( 64, TEST_VALUE ) ;
+  original = buffer.data() ;
+  reader.enroll( &borrowedSetter, iris::OPTIONAL, "move::shared" ) ;
+  bus   .enroll( &ownedSetter   , iris::OPTIONAL, "move::shared" ) ;
+  bus.emit( std::move( buffer ), "move::shared" ) ;
+  if( borrowed_data != original || moved_data != original ) return false ;
+  
+  // Data emitted by reference stays with the caller, so owning subscribers get a copy.
+  buffer.assign( 64, TEST_VALUE ) ;
+  bus.emit( buffer, "move::single" ) ;
+  if( moved_data == buffer.data() || buffer.size() != 64 ) return false ;
+  
+  // Mailboxes move the data in and back out again.
+  buffer.assign( 64, TEST_VALUE ) ;
+  original = buffer.data() ;
+  bus.enroll( &ownedSetter, iris::OPTIONAL | iris::ASYNC, "move::async" ) ;
+  bus.emit( std::move( buffer ), "move::async" ) ;
+  
+  return bus.drain() == 1 && moved_data == original ;
+}
+
+static double      converted_number = 0.0 ;
+static std::string converted_string       ;
+
+void numberSetter( double val )
+{
+  converted_number = val ;
+}
+
+void stringSetter( const std::string& val )
+{
+  converted_string = val ;
+}
+
+bool testConversion()
+{
+  iris::Bus bus ;
+  
+  // Subscriptions enrolled before the conversions are registered only recieve their own type.
+  bus.enroll( &numberSetter, iris::OPTIONAL, "convert::before" ) ;
+  iris::registerConversions<int, float, double, std::string>() ;
+  iris::registerConversion<const char*, double>() ;
+  bus.emit( 0.5f, "convert::before" ) ;
+  if( converted_number != 0.0 ) return false ;
+  
+  bus.enroll( &numberSetter, iris::OPTIONAL, "convert::number" ) ;
+  bus.emit( 0.5f, "convert::number" ) ;
+  if( converted_number != 0.5 ) return false ;
+  bus.emit( 3, "convert::number" ) ;
+  if( converted_number != 3.0 ) return false ;
+  bus.emit( std::string( "2.25" ), "convert::number" ) ;
+  if( converted_number != 2.25 ) return false ;
+  bus.emit( static_cast<const char*>( "0.75" ), "convert::number" ) ;
+  if( converted_number != 0.75 ) return false ;
+  bus.emit( 1.5, "convert::number" ) ;
+  if( converted_number != 1.5 ) return false ;
+  
+  bus.enroll( &stringSetter, iris::OPTIONAL, "convert::string" ) ;
+  bus.emit( 7, "convert::string" ) ;
+  if( converted_string != "7" ) return false ;
+  
+  // Conversions go with their subscription.
+  {
+    iris::Bus scoped ;
+    scoped.enroll( &numberSetter, iris::OPTIONAL, "convert::scoped" ) ;
+  }
+  bus.emit( 4, "convert::scoped" ) ;
+  if( converted_number != 1.5 ) return false ;
+  
+  // Mailboxes queue the converted data.
+  bus.enroll( &numberSetter, iris::OPTIONAL | iris::ASYNC, "convert::async" ) ;
+  bus.emit( 2, "convert::async" ) ;
+  if( bus.drain() != 1 || converted_number != 2.0 ) return false ;
+  
+  // Floating point numbers that do not fit the destination are clamped instead of cast.
+  if( iris::Converter<float, int>::convert( 1e20f ) != std::numeric_limits<int>::max() ) return false ;
+  if( iris::Converter<double, unsigned>::convert( -1.0 ) != 0u ) return false ;
+  if( iris::Converter<float, int>::convert( std::numeric_limits<float>::quiet_NaN() ) != 0 ) return false ;
+  if( iris::Converter<double, float>::convert( 1e300 ) != std::numeric_limits<float>::max() ) return false ;
+  
+  return iris::parseNumber<float>( "-1e300" ) == std::numeric_limits<float>::lowest() ;
+}
+
+#ifdef IRIS_COROUTINES
+static std::atomic<bool> reply_done( false ) ;
+
+iris::Task requestPipeline( iris::Bus& bus )
+{
+  const float first  = co_await bus.request<float>( Query{ 0, 2.0f }, "coroutine::square" ) ;
+  const float second = co_await bus.request<float>( Query{ 0, first }, "coroutine::square" ) ;
+  
+  reply_done = equals( second, 16.0f ) ;
+}
+
+bool testCoroutineReply()
+{
+  iris::Executor executor ;
+  iris::Bus      client   ;
+  iris::Bus      server   ;
+  
+  executor.start( 1 ) ;
+  client.setExecutor( &executor ) ;
+  server.serve( &squareServer, iris::OPTIONAL | iris::ASYNC, "coroutine::square" ) ;
+  
+  requestPipeline( client ) ;
+  
+  for( unsigned tries = 0; tries < 2000 && !reply_done; tries++ )
+  {
+    server.drain() ;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ) ;
+  }
+  
+  executor.stop() ;
+  return reply_done ;
+}
+#endif
+
 bool testFunctionSetter()
 {
   iris::Bus bus ;
@@ -202,12 +1342,40 @@ int main()
   }
   
   manager.initialize( "Iris Data Bus Tests" ) ;
-  manager.add( "Function Test"       , &testFunctionSetter                  ) ;
-  manager.add( "Void Signal Test"    , &testVoidSetter                      ) ;
-  manager.add( "Method Test"         , &obj, &TestObject::checkMethodSetter ) ;
-  manager.add( "Manual Test"         , &obj, &TestObject::checkManualSetter ) ;
-  manager.add( "Indexed Test"        , &testIndexedSetter                   ) ;
-  manager.add( "1000 Emit Speed Test", &testEmitSpeed                       ) ;
+  manager.add( "Function Test"        , &testFunctionSetter                  ) ;
+  manager.add( "Void Signal Test"     , &testVoidSetter                      ) ;
+  manager.add( "Method Test"          , &obj, &TestObject::checkMethodSetter ) ;
+  manager.add( "Manual Test"          , &obj, &TestObject::checkManualSetter ) ;
+  manager.add( "Indexed Test"         , &testIndexedSetter                   ) ;
+  manager.add( "Interned Topic Test"  , &testInternedTopic                   ) ;
+  manager.add( "Topic Handle Test"    , &testTopicHandle                     ) ;
+  manager.add( "Re-entrant Emit Test" , &testReentrantEmit                   ) ;
+  manager.add( "Async Delivery Test"  , &testAsyncDelivery                   ) ;
+  manager.add( "Queue Policy Test"    , &testQueuePolicies                   ) ;
+  manager.add( "Shared Buffer Test"   , &testSharedBuffer                    ) ;
+  manager.add( "Static Topic Test"    , &testStaticTopic                     ) ;
+  manager.add( "Batch Emit Test"      , &testBatchEmit                       ) ;
+  manager.add( "Retained Topic Test"  , &testRetainedTopic                   ) ;
+  manager.add( "Subscribed Types Test", &testSubscribedTypes                 ) ;
+  manager.add( "Pull Topic Test"      , &testPullTopic                       ) ;
+  manager.add( "Wildcard Topic Test"  , &testWildcardTopic                   ) ;
+  manager.add( "Bus Stats Test"       , &testBusStats                        ) ;
+  manager.add( "Shared Memory Test"   , &testSharedTransport                 ) ;
+  manager.add( "Socket Bridge Test"   , &testSocketBridge                    ) ;
+  manager.add( "Bridge Overflow Test" , &testSocketBridgeOverflow            ) ;
+  manager.add( "Recorder Test"        , &testRecorder                        ) ;
+  manager.add( "Serializer Test"      , &testSerializer                      ) ;
+  manager.add( "Executor Test"        , &testExecutor                        ) ;
+  manager.add( "Request Reply Test"   , &testRequestReply                    ) ;
+  manager.add( "Rate Limit Test"      , &testRateLimits                      ) ;
+  manager.add( "Required Wait Test"   , &testRequiredWait                    ) ;
+  manager.add( "Move Emit Test"       , &testMoveEmit                        ) ;
+  manager.add( "Conversion Test"      , &testConversion                      ) ;
+#ifdef IRIS_COROUTINES
+  manager.add( "Coroutine Test"       , &testCoroutine                       ) ;
+  manager.add( "Coroutine Reply Test" , &testCoroutineReply                  ) ;
+#endif
+  manager.add( "1000 Emit Speed Test" , &testEmitSpeed                       ) ;
   
   return manager.test( athena::Output::Verbose ) ;
 }
@@ -23,8 +23,12 @@
 #include <profiling/Timer.h>
 #include <log/Log.h>
 #include <data/Bus.h>
+#include <data/Conversion.h>
+#include <data/SharedMemory.h>
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
 #include <thread>
 #include <iostream>
 #include <queue>
@@ -41,6 +45,8 @@ namespace iris
     using PriorityQueue   = std::vector<Module*>            ;
     using StringVec       = std::vector<std::string>        ;
     using InputOutputPair = std::pair<StringVec, StringVec> ;
+    using TopicVec        = std::vector<iris::TopicId>      ;
+    using Token           = iris::config::json::Token       ;
 
     PriorityQueue   queue             ;
     iris::Timer     timer             ;
@@ -52,6 +58,8 @@ namespace iris
     unsigned        bus_id            ;
     std::string     graph_name        ;
     std::string     graph_config_path ;
+    TopicVec        parameters        ; ///< The retained topics of every module parameter. Their data points into @config.
+    SharedTransport transport         ; ///< The transport carrying this graph's shared topics to other processes.
     unsigned        id                ;
     bool            should_run        ;
     bool            paused            ;
@@ -76,6 +84,38 @@ namespace iris
      * @param name The name of the module.
      */
     void configureModule( iris::config::json::Token& token, std::string& name ) ;
+    
+    /** Method to set the queue settings of the topics a module's ASYNC subscriptions use.
+     * E.g. "queues" : { "camera::frames" : { "depth" : 4, "policy" : "drop_oldest" } }
+     * @param token The JSON token of the module's "queues" object.
+     */
+    void configureQueues( const iris::config::json::Token& token ) ;
+    
+    /** Method to share topics of this graph with other processes through shared memory.
+     * E.g. "shared_memory" : { "segment" : "camera", "depth" : 256, "publish" : { "camera::gain" : "float" }, "subscribe" : { "camera::exposure" : "unsigned" } }
+     * @note The segment defaults to the name of the graph. Only trivially-copyable types can be shared.
+     * @param token The JSON token of the graph's "shared_memory" object.
+     */
+    void configureTransport( const iris::config::json::Token& token ) ;
+    
+    /** Method to share a list of topics of this graph.
+     * @param token The JSON token of the object mapping each topic to the name of it's type.
+     * @param publish Whether the topics are sent to other processes, or recieved from them.
+     */
+    void shareTopics( const iris::config::json::Token& token, bool publish ) ;
+    
+    /** Method to share a single topic of this graph.
+     * @param topic The name of the topic.
+     * @param publish Whether the topic is sent to other processes, or recieved from them.
+     * @return Whether or not the topic could be shared.
+     */
+    template<class Type>
+    bool shareTopic( const char* topic, bool publish ) ;
+    
+    /** Method to stop retaining the parameters of every module.
+     * @note Kept strings and tokens point into the configuration, so this must be called before it is re-parsed or released.
+     */
+    void releaseParameters() ;
 
     /** Helper method when solving the graph. Used for finding the inputs and outputs of a module.
      * @param token The JSON token to process.
@@ -151,6 +191,8 @@ namespace iris
     }
     
     this->clear() ;
+    this->releaseParameters() ;
+    this->transport.reset() ;
     
     this->graph_config_path = graph_config_path ;
     this->config.initialize( config_path ) ;
@@ -166,6 +208,11 @@ namespace iris
   {
     this->enable_timings = false ;
     this->paused         = false ;
+    
+    // Parameters are only sent as text, so modules subscribed with a number or boolean are handed it converted.
+    iris::registerConversion<const char*, unsigned>() ;
+    iris::registerConversion<const char*, float   >() ;
+    iris::registerConversion<const char*, bool    >() ;
   }
 
   void GraphData::movePrexisting()
@@ -354,44 +401,126 @@ namespace iris
   {
     this->bus.setChannel( this->id ) ;
     
-    std::string key ;
+    std::string              key     ;
+    iris::TopicId            topic   ;
+    std::vector<const char*> strings ;
     
     for( auto param = token.begin(); param != token.end(); ++param )
     {
       key = param.key() ;
-      if( key != "type" && key != "version" )
+      if( key != "type" && key != "version" && key != "queues" )
       {
-        if( param.isArray() )
-        {
-          for( unsigned index = 0; index < param.size(); index++ )
-          {
-            this->bus.emitIndexed( param.number ( index ), index, name.c_str(), "::", key.c_str() ) ;
-            this->bus.emitIndexed( param.decimal( index ), index, name.c_str(), "::", key.c_str() ) ;
-            this->bus.emitIndexed( param.string ( index ), index, name.c_str(), "::", key.c_str() ) ;
-            this->bus.emitIndexed( param.boolean( index ), index, name.c_str(), "::", key.c_str() ) ;
-          }
-        }
-        else
+        topic = iris::intern( name.c_str(), "::", key.c_str() ) ;
+        
+        // Modules that subscribe after this still recieve the parameter, without it being emitted again.
+        iris::setRetained( topic, true ) ;
+        this->parameters.push_back( topic ) ;
+        
+        // Sent once as text. Subscriptions to numbers & booleans convert it as they recieve it, whenever they subscribe.
+        strings.resize( param.isArray() ? param.size() : 1 ) ;
+        
+        for( unsigned index = 0; index < strings.size(); index++ )
         {
-          this->bus.emit( param.number (), name.c_str(), "::", key.c_str() ) ;
-          this->bus.emit( param.decimal(), name.c_str(), "::", key.c_str() ) ;
-          this->bus.emit( param.string (), name.c_str(), "::", key.c_str() ) ;
-          this->bus.emit( param.boolean(), name.c_str(), "::", key.c_str() ) ;
+          strings[ index ] = param.string( index ) ;
         }
         
-        this->bus.emit( param, name.c_str(), "::", key.c_str() ) ;
+        if( param.isArray() ) this->bus.emitBatch( strings.data(), static_cast<unsigned>( strings.size() ), 0, topic ) ;
+        else                  this->bus.emit( strings[ 0 ], topic ) ;
+        
+        this->bus.emit( param, topic ) ;
+      }
+    }
+  }
+  
+  void GraphData::configureQueues( const iris::config::json::Token& token )
+  {
+    std::string    policy_name ;
+    unsigned       depth       ;
+    iris::Overflow policy      ;
+    
+    for( auto queue = token.begin(); queue != token.end(); ++queue )
+    {
+      depth       = queue[ "depth"  ] ? queue[ "depth" ].number()  : 64            ;
+      policy_name = queue[ "policy" ] ? queue[ "policy" ].string() : "drop_newest" ;
+      
+      if     ( policy_name == "block"       ) policy = iris::Overflow::Block      ;
+      else if( policy_name == "drop_oldest" ) policy = iris::Overflow::DropOldest ;
+      else if( policy_name == "coalesce"    ) policy = iris::Overflow::Coalesce   ;
+      else if( policy_name == "drop_newest" ) policy = iris::Overflow::DropNewest ;
+      else
+      {
+        iris::log::Log::output( iris::log::Log::Level::Warning, "Unknown queue policy '", policy_name.c_str(), "' for topic ", queue.key(), ". Dropping newest." ) ;
+        policy = iris::Overflow::DropNewest ;
       }
+      
+      iris::setQueue( iris::intern( queue.key() ), depth, policy ) ;
+    }
+  }
+  
+  void GraphData::configureTransport( const iris::config::json::Token& token )
+  {
+    const std::string segment = token[ "segment" ] ? token[ "segment" ].string() : this->graph_name.c_str()      ;
+    const unsigned    depth   = token[ "depth"   ] ? token[ "depth"   ].number() : SharedTransport::DEFAULT_DEPTH ;
+    
+    if( !this->transport.initialize( segment.c_str(), SharedTransport::DEFAULT_SIZE, depth ) )
+    {
+      iris::log::Log::output( iris::log::Log::Level::Warning, "Graph ", this->graph_name.c_str(), " unable to open shared memory segment '", segment.c_str(), "'." ) ;
+      return ;
+    }
+    
+    if( token[ "publish"   ] ) this->shareTopics( token[ "publish"   ], true  ) ;
+    if( token[ "subscribe" ] ) this->shareTopics( token[ "subscribe" ], false ) ;
+    
+    this->transport.start() ;
+  }
+  
+  void GraphData::shareTopics( const iris::config::json::Token& token, bool publish )
+  {
+    std::string type   ;
+    bool        shared ;
+    
+    for( auto topic = token.begin(); topic != token.end(); ++topic )
+    {
+      type = topic.string() ;
+      
+      if     ( type == "bool"     ) shared = this->shareTopic<bool    >( topic.key(), publish ) ;
+      else if( type == "int"      ) shared = this->shareTopic<int     >( topic.key(), publish ) ;
+      else if( type == "unsigned" ) shared = this->shareTopic<unsigned>( topic.key(), publish ) ;
+      else if( type == "float"    ) shared = this->shareTopic<float   >( topic.key(), publish ) ;
+      else if( type == "double"   ) shared = this->shareTopic<double  >( topic.key(), publish ) ;
+      else                          shared = false ;
+      
+      if( !shared ) iris::log::Log::output( iris::log::Log::Level::Warning, "Graph ", this->graph_name.c_str(), " unable to share topic ", topic.key(), " of type '", type.c_str(), "'." ) ;
     }
   }
   
+  template<class Type>
+  bool GraphData::shareTopic( const char* topic, bool publish )
+  {
+    return publish ? this->transport.publish<Type>( topic ) : this->transport.subscribe<Type>( topic ) ;
+  }
+  
+  void GraphData::releaseParameters()
+  {
+    // Retention is counted per topic, so graphs sharing a parameter keep it until the last of them lets go.
+    for( auto topic : this->parameters )
+    {
+      iris::setRetained( topic, false ) ;
+    }
+    
+    this->parameters.clear() ;
+  }
+  
   void GraphData::reload()
   {
     iris::log::Log::output( "Graph ", this->graph_name.c_str(), " configuration changed. Reloading..." ) ;
-    this->stop()           ;
-    this->config.reset()   ;
+    this->stop()              ;
+    this->releaseParameters() ;
+    this->transport.reset()   ;
+    this->config.reset()      ;
     this->config.initialize( this->graph_config_path.c_str() ) ;
-    this->movePrexisting() ;
-    this->clear()          ;
+    this->movePrexisting()    ;
+    this->clear()             ;
 
     this->load () ;
     this->solve() ;
@@ -419,6 +548,13 @@ namespace iris
       for( auto mod = graph.begin(); mod != graph.end(); ++mod )
       {
         name = mod.key() ;
+        
+        if( name == "shared_memory" )
+        {
+          this->configureTransport( mod ) ;
+          continue ;
+        }
+        
         version = 0  ;
         type    = "" ;
         
@@ -428,6 +564,7 @@ namespace iris
           
           if( param == "type"    ) type    = params.string() ;
           if( param == "version" ) version = params.number() ; 
+          if( param == "queues"  ) this->configureQueues( params ) ;
         }
         
         if( this->graph.find( name ) == this->graph.end() && this->pre_graph.find( name ) == this->pre_graph.end() )
@@ -473,6 +610,7 @@ namespace iris
 
   Graph::~Graph()
   { 
+    this->graph_data->releaseParameters() ;
     delete this->graph_data ;
   }
 
@@ -57,15 +57,16 @@ namespace iris
   {
     typedef bool Flag ;
 
-    std::string       name        ; ///< The name of this module.
-    std::string       type        ; ///< The type of module this object is.
-    unsigned          version     ; ///< The version of module.
-    Flag              running     ; ///< Whether or not this module is running.
-    Flag              should_run  ; ///< Whether or not this module should be running.
-    iris::Bus         bus         ; ///< The bus to communicate data over.
-    unsigned          id          ; ///< The id associated with this module.
-    std::mutex        mutex       ; ///< The mutex to use for locking.
-    std::atomic<int>  is_signaled ; ///< Whether or not this module is signaled.
+    std::string             name        ; ///< The name of this module.
+    std::string             type        ; ///< The type of module this object is.
+    unsigned                version     ; ///< The version of module.
+    Flag                    running     ; ///< Whether or not this module is running.
+    Flag                    should_run  ; ///< Whether or not this module should be running.
+    iris::Bus               bus         ; ///< The bus to communicate data over.
+    unsigned                id          ; ///< The id associated with this module.
+    std::mutex              mutex       ; ///< The mutex to use for locking.
+    std::atomic<int>        is_signaled ; ///< Whether or not this module is signaled.
+    std::vector<iris::Bus*> attached    ; ///< The buses whose ASYNC subscriptions are delivered on this module's thread.
 
     std::condition_variable cv ;
 
@@ -114,7 +115,8 @@ namespace iris
         data().running = false ;
         return ; 
       }
-
+      
+      for( auto bus : data().attached ) bus->drain() ;
       this->execute() ;
     }
   }
@@ -129,6 +131,11 @@ namespace iris
     data().cv.notify_one() ;
   }
   
+  void Module::attach( iris::Bus& bus )
+  {
+    data().attached.push_back( &bus ) ;
+  }
+  
   bool Module::stop()
   {
     data().should_run = false ;
@@ -27,6 +27,10 @@
 
 namespace iris
 {
+  /** Forward declared object from data/Bus.h.
+   */
+  class Bus ;
+  
   /** Class for describing a Module for use in the Iris Framework.
    */
   class Module
@@ -75,6 +79,12 @@ namespace iris
       /** Method to kick this module to start a single execution.
        */
       void kick() ;
+      
+      /** Method to have this module deliver the ASYNC subscriptions of a bus on it's own thread, right before each execution.
+       * @note The bus must outlive this module's operation.
+       * @param bus The bus to drain.
+       */
+      void attach( iris::Bus& bus ) ;
 
       /** Method to stop operation of this module.
        * @return Whether the module is stopped or not.